@@ -0,0 +1,11 @@
+# Number arithmetic in a tight loop.
+
+let ops = 1000000
+
+def run
+    let sum = 0
+    for let i = 0 to ops do
+        sum = sum + i * 2 - i % 7
+    end
+    return sum
+end
@@ -0,0 +1,16 @@
+# Growing an array one element at a time, then iterating over it.
+
+let ops = 200000
+
+def run
+    let arr = []
+    for let i = 0 to ops do
+        arr.push(i)
+    end
+
+    let sum = 0
+    for let n in arr do
+        sum += n
+    end
+    return sum
+end
@@ -0,0 +1,24 @@
+# Loops with branches, the lengths of the collatz sequences of 1 to 3000.
+
+def collatz : n
+    let c = 1
+    while n != 1 do
+        if n % 2 == 0 then
+            n = n / 2
+        else
+            n = 3 * n + 1
+        end
+        c += 1
+    end
+    return c
+end
+
+let ops = 3000
+
+def run
+    let total = 0
+    for let i = 1 to ops + 1 do
+        total += collatz(i)
+    end
+    return total
+end
@@ -0,0 +1,26 @@
+# Several processes sending to one, which drains its mailbox in batches.
+
+import process
+
+let producers = 8
+let ops = 2000
+
+def produce : parent, n
+    for let i = 0 to n do
+        process.send(parent, i)
+    end
+end
+
+def run
+    let pids = []
+    for let p = 0 to producers do
+        pids.push(process.create(produce, process.id(), ops))
+    end
+    let received = 0
+    while received < producers * ops do
+        received = received + process.receive_many(64).size()
+    end
+    for let pid in pids do
+        process.join(pid)
+    end
+end
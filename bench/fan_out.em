@@ -0,0 +1,26 @@
+# One process sending the same array of objects to a pool of processes.
+
+import process
+
+let workers = 16
+let ops = 200
+
+def consume : n
+    for let i = 0 to n do
+        process.receive()
+    end
+end
+
+def run
+    let message = []
+    for let i = 0 to 50 do
+        message.push({ id: i, name: 'item' })
+    end
+    let pids = process.spawn_pool(workers, consume, ops)
+    for let i = 0 to ops do
+        process.send_many(pids, message)
+    end
+    for let pid in pids do
+        process.join(pid)
+    end
+end
@@ -0,0 +1,14 @@
+# Recursive calls, each run makes 21891 calls.
+
+def fib : n
+    if n < 2 then
+        return n
+    end
+    return fib(n - 1) + fib(n - 2)
+end
+
+let ops = 21891
+
+def run
+    return fib(20)
+end
@@ -0,0 +1,18 @@
+# Short lived allocations with a few survivors, which get promoted and
+# then dropped while the benchmark runs.
+
+let ops = 200000
+
+def run
+    let survivors = []
+    for let i = 0 to ops do
+        let obj = { id: i, pair: [i, i + 1], name: 'obj' }
+        if i % 100 == 0 then
+            survivors.push(obj)
+        end
+        if i % 50000 == 0 then
+            survivors = []
+        end
+    end
+    return survivors
+end
@@ -0,0 +1,15 @@
+# Decoding a small document with the json library.
+
+import json
+
+let document = '{"name": "emerald", "tags": ["vm", "bytecode", "gc"], "stable": false, "license": null, "owner": {"name": "emeraldlang", "verified": true}}'
+
+let ops = 500
+
+def run
+    let obj = None
+    for let i = 0 to ops do
+        obj = json.deserialize(document)
+    end
+    return obj
+end
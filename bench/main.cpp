@@ -0,0 +1,306 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "fmt/format.h"
+
+#include "emerald/code_cache.h"
+#include "emerald/compiler.h"
+#include "emerald/interpreter.h"
+#include "emerald/jit.h"
+#include "emerald/module.h"
+#include "emerald/modules/init.h"
+#include "emerald/object.h"
+#include "emerald/optimizer.h"
+#include "emerald/parser.h"
+#include "emerald/process.h"
+#include "emerald/reporter.h"
+#include "emerald/source.h"
+
+#ifndef EMERALD_BENCH_DIR
+#define EMERALD_BENCH_DIR "bench"
+#endif
+
+// Runs the benchmark corpus and prints one JSON object per benchmark.
+// A benchmark is a module defining `ops`, the number of operations a
+// call to `run` performs, and `run` itself. Each benchmark runs in its
+// own process so heap statistics are not shared between them, and the
+// allocation and collection counts reported are per run.
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct BenchmarkResult {
+    std::string name;
+    std::string error;
+
+    double ops = 0;
+    Milliseconds compile_time{ 0 };
+    std::vector<Milliseconds> times;
+
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+    size_t young_collections = 0;
+    size_t full_collections = 0;
+    Milliseconds gc_pause{ 0 };
+    Milliseconds max_gc_pause{ 0 };
+
+    Milliseconds mean_time() const {
+        Milliseconds total{ 0 };
+        for (Milliseconds time : times) total += time;
+        return times.empty() ? total : total / times.size();
+    }
+
+    double ops_per_sec() const {
+        Milliseconds mean = mean_time();
+        return mean.count() > 0 ? ops / (mean.count() / 1000) : 0;
+    }
+};
+
+std::string escape_json(const std::string& str) {
+    std::string escaped;
+    for (char c : str) {
+        switch (c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += fmt::format("\\u{0:04x}", static_cast<int>(c));
+            } else {
+                escaped += c;
+            }
+        }
+    }
+
+    return escaped;
+}
+
+std::string to_json(const BenchmarkResult& result) {
+    if (!result.error.empty()) {
+        return fmt::format(
+            "{{\"name\":\"{0}\",\"error\":\"{1}\"}}",
+            escape_json(result.name),
+            escape_json(result.error));
+    }
+
+    auto [min_time, max_time] = std::minmax_element(result.times.begin(), result.times.end());
+    size_t iterations = result.times.size();
+    return fmt::format(
+        "{{\"name\":\"{0}\",\"ops\":{1:.0f},\"iterations\":{2},\"compile_ms\":{3:.3f},"
+        "\"mean_ms\":{4:.3f},\"min_ms\":{5:.3f},\"max_ms\":{6:.3f},\"ops_per_sec\":{7:.1f},"
+        "\"allocations\":{8},\"allocated_bytes\":{9},\"young_collections\":{10},"
+        "\"full_collections\":{11},\"gc_pause_ms\":{12:.3f},\"max_gc_pause_ms\":{13:.3f}}}",
+        escape_json(result.name),
+        result.ops,
+        iterations,
+        result.compile_time.count(),
+        result.mean_time().count(),
+        min_time->count(),
+        max_time->count(),
+        result.ops_per_sec(),
+        result.allocations / iterations,
+        result.allocated_bytes / iterations,
+        result.young_collections / iterations,
+        result.full_collections / iterations,
+        result.gc_pause.count() / iterations,
+        result.max_gc_pause.count());
+}
+
+std::shared_ptr<emerald::Code> compile(const std::filesystem::path& path, bool optimize, bool stack_only, BenchmarkResult& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<emerald::Reporter> reporter = std::make_shared<emerald::Reporter>();
+    std::vector<std::shared_ptr<emerald::Statement>> statements = emerald::Parser::parse(
+        emerald::Source::from_file(path),
+        reporter);
+    std::shared_ptr<emerald::Code> code;
+    if (!reporter->has_errors()) {
+        code = emerald::Compiler::compile(statements, reporter, stack_only);
+    }
+
+    if (reporter->has_errors()) {
+        result.error = reporter->get_reports().front().get_report();
+        return nullptr;
+    }
+
+    if (optimize) {
+        emerald::Optimizer::optimize(*code);
+    }
+
+    result.compile_time = std::chrono::steady_clock::now() - start;
+    return code;
+}
+
+void run_benchmark(const std::string& name, size_t warmup, size_t iterations, BenchmarkResult& result) {
+    emerald::Process* process = emerald::ProcessManager::create();
+    emerald::ProcessManager::execute(process->get_id(), [&](emerald::Process*) {
+        try {
+            emerald::Interpreter::execute_module(name, process);
+
+            emerald::Module* module = process->get_module_registry().get_module(name);
+            emerald::Value ops = module->get_property("ops");
+            emerald::Value run = module->get_property("run");
+            if (!ops.is_number() || !run.is_object()) {
+                result.error = "benchmarks must define ops and run";
+                return;
+            }
+
+            result.ops = ops.get_number();
+
+            for (size_t i = 0; i < warmup; i++) {
+                emerald::Interpreter::call_obj<emerald::Value>(run, module, {}, process);
+            }
+
+            emerald::HeapStats before = process->get_heap().get_stats();
+            for (size_t i = 0; i < iterations; i++) {
+                auto start = std::chrono::steady_clock::now();
+                emerald::Interpreter::call_obj<emerald::Value>(run, module, {}, process);
+                result.times.push_back(std::chrono::steady_clock::now() - start);
+            }
+            emerald::HeapStats after = process->get_heap().get_stats();
+
+            using Kind = emerald::CollectionStats::Kind;
+            result.allocations = after.get_num_allocations() - before.get_num_allocations();
+            result.allocated_bytes = after.get_allocated_bytes() - before.get_allocated_bytes();
+            result.young_collections = after.get_num_collections(Kind::YOUNG) - before.get_num_collections(Kind::YOUNG);
+            result.full_collections = after.get_num_collections(Kind::FULL) - before.get_num_collections(Kind::FULL);
+            result.gc_pause = after.get_total_pause() - before.get_total_pause();
+
+            // Only the most recent collections are kept, which is enough
+            // unless a run collects more often than that.
+            const std::deque<emerald::CollectionStats>& collections = after.get_recent_collections();
+            size_t num_collections = std::min(result.young_collections + result.full_collections, collections.size());
+            for (auto it = collections.end() - num_collections; it != collections.end(); ++it) {
+                result.max_gc_pause = std::max<Milliseconds>(result.max_gc_pause, it->pause);
+            }
+        } catch (emerald::Object* exc) {
+            result.error = exc->as_str();
+        }
+    });
+    emerald::ProcessManager::join(process->get_id());
+}
+
+// Baselines are earlier output of the harness, only the name and
+// ops_per_sec of each line are read.
+std::map<std::string, double> read_baseline(const std::filesystem::path& path) {
+    static const std::regex line_regex("\"name\":\"([^\"]+)\".*\"ops_per_sec\":([0-9.eE+-]+)");
+
+    std::map<std::string, double> baseline;
+    std::ifstream ifs(path);
+    std::string line;
+    std::smatch match;
+    while (std::getline(ifs, line)) {
+        if (std::regex_search(line, match, line_regex)) {
+            baseline[match[1]] = std::stod(match[2]);
+        }
+    }
+
+    return baseline;
+}
+
+int main(int argc, char** argv) {
+    CLI::App app("runs the emerald benchmark corpus and prints one JSON object per benchmark.");
+
+    std::vector<std::string> names;
+    app.add_option("benchmarks", names, "specifies the benchmarks to run, defaults to all of them");
+
+    std::filesystem::path dir = EMERALD_BENCH_DIR;
+    app.add_option("-d,--dir", dir, "specifies the directory of the benchmark corpus");
+
+    size_t warmup = 1;
+    app.add_option("-w,--warmup", warmup, "specifies the number of runs before measuring");
+
+    size_t iterations = 5;
+    app.add_option("-i,--iterations", iterations, "specifies the number of measured runs")->check(CLI::PositiveNumber);
+
+    bool optimize = false;
+    app.add_flag("-O,--optimize", optimize, "indicates whether the bytecode should be optimized");
+
+    bool stack_only = false;
+    app.add_flag("--stack-only", stack_only, "indicates whether register instructions should be left out");
+
+    bool jit = false;
+    app.add_flag("--jit", jit, "indicates whether hot code should be compiled to machine code");
+
+    std::filesystem::path baseline_path;
+    app.add_option("-b,--baseline", baseline_path, "specifies earlier output to compare ops_per_sec against");
+
+    double threshold = 0.1;
+    app.add_option("-t,--threshold", threshold, "specifies the fraction ops_per_sec may drop before it is a regression");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (names.empty()) {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".em") {
+                names.push_back(entry.path().stem().string());
+            }
+        }
+        std::sort(names.begin(), names.end());
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baseline_path.empty()) {
+        baseline = read_baseline(baseline_path);
+    }
+
+    emerald::modules::add_module_inits_to_registry();
+    emerald::Jit::set_enabled(jit);
+
+    int status = 0;
+    for (const std::string& name : names) {
+        BenchmarkResult result;
+        result.name = name;
+
+        std::filesystem::path path = dir / (name + ".em");
+        if (!std::filesystem::is_regular_file(path)) {
+            result.error = "no such benchmark";
+        } else if (std::shared_ptr<emerald::Code> code = compile(path, optimize, stack_only, result)) {
+            emerald::CodeCache::add_code(name, code);
+            run_benchmark(name, warmup, iterations, result);
+        }
+
+        std::cout << to_json(result) << std::endl;
+
+        if (!result.error.empty()) {
+            status = 1;
+        } else if (baseline.find(name) != baseline.end()) {
+            double expected = baseline.at(name);
+            if (result.ops_per_sec() < expected * (1 - threshold)) {
+                std::cerr << fmt::format(
+                    "regression: {0} ran at {1:.1f} ops/sec, down from {2:.1f}",
+                    name,
+                    result.ops_per_sec(),
+                    expected) << std::endl;
+                status = 1;
+            }
+        }
+    }
+
+    return status;
+}
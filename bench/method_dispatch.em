@@ -0,0 +1,30 @@
+# Method calls on objects sharing a prototype, through a call site that
+# sees two receivers.
+
+object Counter
+    def __init__
+        self.count = 0
+    end
+
+    def increment : n
+        self.count = self.count + n
+        return self
+    end
+end
+
+object DoubleCounter clones Counter
+    def increment : n
+        self.count = self.count + n * 2
+        return self
+    end
+end
+
+let ops = 200000
+
+def run
+    let counters = [clone Counter(), clone DoubleCounter()]
+    for let i = 0 to ops do
+        counters.at(i % 2).increment(i)
+    end
+    return counters.front().count + counters.back().count
+end
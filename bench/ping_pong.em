@@ -0,0 +1,20 @@
+# Round trips of a message between two processes.
+
+import process
+
+let ops = 2000
+
+def echo : parent, n
+    for let i = 0 to n do
+        process.send(parent, process.receive())
+    end
+end
+
+def run
+    let pid = process.create(echo, process.id(), ops)
+    for let i = 0 to ops do
+        process.send(pid, i)
+        process.receive()
+    end
+    process.join(pid)
+end
@@ -0,0 +1,13 @@
+# Property loads and stores on objects with the same shape.
+
+let ops = 500000
+
+def run
+    let a = { x: 1, y: 2, z: 3 }
+    let b = { x: 4, y: 5, z: 6 }
+    for let i = 0 to ops do
+        a.x = b.y + a.z
+        b.z = a.x - b.x
+    end
+    return a.x + b.z
+end
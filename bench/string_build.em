@@ -0,0 +1,15 @@
+# Building strings by formatting and concatenation.
+
+let ops = 100000
+
+def run
+    let length = 0
+    for let i = 0 to ops / 100 do
+        let str = ''
+        for let j = 0 to 100 do
+            str += '{0},'.format(j)
+        end
+        length += str.len()
+    end
+    return length
+end
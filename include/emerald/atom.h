@@ -0,0 +1,149 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_ATOM_H
+#define _EMERALD_ATOM_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace emerald {
+
+    // A property key, global name or magic method. Atoms interned when
+    // code is loaded, and the magic methods, share their storage with
+    // every other interned atom of the same text, so two of them are
+    // compared by pointer. Any other atom, such as a computed key, is made
+    // on its own and freed once nothing refers to it, and is compared to
+    // others by its text. An atom's hash is that of its text, so interned
+    // and computed atoms find each other in the same table.
+    class Atom {
+    public:
+        Atom()
+            : _bits(0) {}
+
+        Atom(const char* str);
+        Atom(const std::string& str);
+
+        Atom(const Atom& other)
+            : _bits(other._bits) {
+            retain();
+        }
+
+        Atom(Atom&& other) noexcept
+            : _bits(other._bits) {
+            other._bits = 0;
+        }
+
+        ~Atom() {
+            release();
+        }
+
+        Atom& operator=(const Atom& other) {
+            if (_bits != other._bits) {
+                other.retain();
+                release();
+                _bits = other._bits;
+            }
+
+            return *this;
+        }
+
+        Atom& operator=(Atom&& other) noexcept {
+            if (this != &other) {
+                release();
+                _bits = other._bits;
+                other._bits = 0;
+            }
+
+            return *this;
+        }
+
+        // Returns the shared atom for the text, which lives as long as
+        // the program. Only meant for names known when code is loaded.
+        static Atom intern(const std::string& str);
+
+        const std::string& get_str() const {
+            return get_entry()->str;
+        }
+
+        size_t get_hash() const {
+            return _bits ? get_entry()->hash : 0;
+        }
+
+        explicit operator bool() const {
+            return _bits != 0;
+        }
+
+        bool operator==(const Atom& other) const {
+            return _bits == other._bits || (((_bits | other._bits) & COMPUTED) && equals(other));
+        }
+
+        bool operator!=(const Atom& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        struct Entry {
+            std::string str;
+            size_t hash;
+
+            // Only counted for computed atoms.
+            std::atomic<size_t> refs;
+        };
+
+        // Set on computed atoms, whose entry is counted and freed when the
+        // last of them goes.
+        static const uintptr_t COMPUTED = 1;
+
+        uintptr_t _bits;
+
+        Entry* get_entry() const {
+            return reinterpret_cast<Entry*>(_bits & ~COMPUTED);
+        }
+
+        void retain() const {
+            if (_bits & COMPUTED) {
+                get_entry()->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void release() {
+            if (_bits & COMPUTED) {
+                release_computed();
+            }
+        }
+
+        void release_computed();
+        bool equals(const Atom& other) const;
+    };
+
+} // namespace emerald
+
+namespace std {
+
+    template <>
+    struct hash<emerald::Atom> {
+        size_t operator()(const emerald::Atom& atom) const {
+            return atom.get_hash();
+        }
+    };
+
+} // namespace std
+
+#endif // _EMERALD_ATOM_H
@@ -18,6 +18,7 @@
 #ifndef _EMERALD_CODE_H
 #define _EMERALD_CODE_H
 
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
@@ -25,14 +26,18 @@
 #include <unordered_map>
 #include <vector>
 
+#include "emerald/atom.h"
 #include "emerald/opcode.h"
 
 namespace emerald {
 
+    class JitCode;
+
     class Code {
     public:
         Code();
         Code(const std::filesystem::path& path);
+        ~Code();
 
         class Instruction {
         public:
@@ -57,11 +62,45 @@ namespace emerald {
             std::vector<uint64_t> _args;
         };
 
+        // The form instructions are executed in: the opcode and its
+        // operands in one fixed width record, so the whole body of the code
+        // is a single contiguous array indexed by instruction pointer.
+        struct PackedInstruction {
+            static const size_t MAX_ARGS = 3;
+
+            OpCode::Value op;
+            uint32_t args[MAX_ARGS];
+        };
+
+        // Operands of the register instructions. An operand names a slot
+        // of the frame's locals, a number constant or the top of the data
+        // stack, which sources are popped from and results pushed to.
+        class Operand {
+        public:
+            static const uint32_t DATA_STACK = UINT32_MAX;
+
+            static uint32_t slot(size_t id) { return id; }
+            static uint32_t constant(size_t id) { return CONSTANT | id; }
+
+            static bool is_data_stack(uint32_t operand) { return operand == DATA_STACK; }
+            static bool is_constant(uint32_t operand) { return operand != DATA_STACK && (operand & CONSTANT); }
+            static size_t get_id(uint32_t operand) { return operand & ~CONSTANT; }
+
+            static std::string to_string(uint32_t operand);
+
+        private:
+            static const uint32_t CONSTANT = 1u << 31;
+        };
+
         const std::string& get_label() const;
         size_t get_id() const;
 
         size_t get_num_instructions() const;
 
+        // Only available once the code is loaded. The instructions are
+        // followed by a null and ret, so running off the end returns None.
+        const PackedInstruction* get_packed_instructions() const;
+
         void write_nop();
 
         size_t create_label();
@@ -124,6 +163,9 @@ namespace emerald {
         void write_def_data_prop(bool push_self_back = false);
         void write_get_prop(bool push_self_back = false);
         void write_set_prop(bool push_self_back = false);
+        void write_get_prop_str(const std::string& key, bool push_self_back = false);
+        void write_set_prop_str(const std::string& key, bool push_self_back = false);
+        void write_call_method(const std::string& name, size_t num_args);
         void write_self();
 
         void write_enter_try(size_t label);
@@ -146,6 +188,11 @@ namespace emerald {
 
         size_t write_import(const std::string& name);
 
+        void write_mov(uint32_t dst, uint32_t src);
+        void write_register_op(OpCode::Value op, uint32_t dst, uint32_t lhs, uint32_t rhs);
+        size_t add_num_constant(double val);
+        size_t add_str_constant(const std::string& val);
+
         std::shared_ptr<const Code> get_func(const std::string& label) const;
         std::shared_ptr<Code> get_func(const std::string& label);
         std::shared_ptr<const Code> get_func(size_t id) const;
@@ -155,14 +202,17 @@ namespace emerald {
 
         double get_num_constant(size_t id) const;
         const std::string& get_str_constant(size_t id) const;
+        Atom get_str_atom(size_t id) const;
 
         bool is_local_name(const std::string& name);
         const std::string& get_local_name(size_t id) const;
+        Atom get_local_atom(size_t id) const;
         const std::vector<std::string>& get_local_names() const;
         size_t get_num_locals() const;
 
         bool is_global_name(const std::string& name);
         const std::string& get_global_name(size_t id) const;
+        Atom get_global_atom(size_t id) const;
         std::shared_ptr<const std::vector<std::string>> get_global_names() const;
         size_t get_num_globals() const;
 
@@ -187,6 +237,10 @@ namespace emerald {
         void serialize(Archive& archive, const unsigned int);
 
     private:
+        friend class CodeCache;
+        friend class Jit;
+        friend class Optimizer;
+
         struct LabelEntry {
             size_t pos = 0;
             bool is_bound = false;
@@ -214,6 +268,19 @@ namespace emerald {
         std::vector<std::string> _locals;
         std::shared_ptr<std::vector<std::string>> _globals;
 
+        // Built when code is loaded.
+        std::vector<PackedInstruction> _packed_instructions;
+        std::vector<Atom> _str_atoms;
+        std::vector<Atom> _local_atoms;
+        std::vector<Atom> _global_atoms;
+
+        // How often the code has been entered or looped, and its native
+        // code once the JIT compiled it. Shared by every process running
+        // the code.
+        mutable std::atomic<uint32_t> _hotness{ 0 };
+        mutable std::atomic<JitCode*> _jit_code{ nullptr };
+        mutable std::atomic<bool> _jit_failed{ false };
+
         Code(
             size_t id,
             std::shared_ptr<std::vector<std::string>> globals);
@@ -224,6 +291,8 @@ namespace emerald {
 
         void write(const Instruction& instr);
 
+        void link();
+
         std::string to_string(size_t depth) const;
 
         size_t get_label_offset(size_t label);
@@ -30,10 +30,15 @@ namespace emerald {
         static std::shared_ptr<Code> get_code(const std::string& module_name);
         static std::shared_ptr<Code> get_or_load_code(const std::string& module_name);
 
+        // Adds code compiled in memory under the module name, loading the
+        // modules it imports from disk.
+        static void add_code(const std::string& module_name, std::shared_ptr<Code> code);
+
     private:
         static std::unordered_map<std::string, std::shared_ptr<Code>> _code;
 
         static void load_code(const std::string& module_name);
+        static void load_imports(const Code& code);
         static std::filesystem::path locate_code(const std::string& module_name);
     };
 
@@ -30,9 +30,12 @@ namespace emerald {
 
     class Compiler : public ASTVisitor {
     public:
+        // Unless stack_only is set, expressions over locals and number
+        // constants in functions are compiled to register instructions.
         static std::shared_ptr<Code> compile(
             const std::vector<std::shared_ptr<Statement>>& statements,
-            std::shared_ptr<Reporter> reporter);
+            std::shared_ptr<Reporter> reporter,
+            bool stack_only = false);
 
     private:
         struct LoopLabels {
@@ -46,12 +49,24 @@ namespace emerald {
             size_t end;
         };
 
-        Compiler(std::shared_ptr<Reporter> reporter);
+        // Where a register instruction finds the value of an expression.
+        enum class OperandKind {
+            LOCAL,
+            CONSTANT,
+            // Computed by register instructions into a temporary slot.
+            TEMP,
+            // Computed by stack instructions onto the data stack.
+            DATA_STACK
+        };
+
+        Compiler(std::shared_ptr<Reporter> reporter, bool stack_only);
 
         std::shared_ptr<Reporter> _reporter;
         std::shared_ptr<Code> _code;
         std::stack<std::shared_ptr<Code>> _code_stack;
         std::stack<LoopLabels> _loop_stack;
+        bool _stack_only;
+        size_t _num_temps;
 
 #define X(NodeType) void Visit##NodeType(const std::shared_ptr<NodeType>& node) override;
         ALL_NODES
@@ -97,6 +112,18 @@ namespace emerald {
         void write_st(const std::string& identifier);
 
         void write_comp_assign(const std::shared_ptr<Token>& op);
+
+        bool uses_registers();
+        bool has_register_form(const std::shared_ptr<BinaryOp>& binary_op);
+        OperandKind get_operand_kind(const std::shared_ptr<Expression>& expression);
+        uint32_t write_operand(const std::shared_ptr<Expression>& expression);
+        void write_register_sources(const std::shared_ptr<BinaryOp>& binary_op, uint32_t& lhs, uint32_t& rhs);
+        bool write_register_st(const std::string& identifier, const std::shared_ptr<Expression>& val);
+        uint32_t create_temp();
+
+        static bool is_temp_name(const std::string& name);
+        static bool may_write_locals(const std::shared_ptr<Expression>& expression);
+        static OpCode::Value get_register_op(const std::shared_ptr<Token>& op);
     };
 
 } // namespace emerald
@@ -0,0 +1,71 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_FIBER_H
+#define _EMERALD_FIBER_H
+
+#include <cstddef>
+#include <functional>
+
+#include <ucontext.h>
+
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    // A function running on its own stack, which can suspend itself and be
+    // resumed later, possibly by a different thread. The stack is reserved
+    // up front and only committed as it's used, so a fiber costs little
+    // more than the memory it touches.
+    class Fiber {
+    public:
+        static const size_t DEFAULT_STACK_SIZE = 8 * 1024 * 1024;
+
+        Fiber(std::function<void()> entry, size_t stack_size = DEFAULT_STACK_SIZE);
+        ~Fiber();
+
+        NO_COPY(Fiber);
+
+        // Runs the fiber on the calling thread until it yields or its
+        // entry returns.
+        void resume();
+
+        // Suspends the fiber, returning to the thread that resumed it.
+        // Must be called from inside the fiber.
+        void yield();
+
+        bool is_finished() const;
+
+        // The fiber running on the calling thread, if any.
+        static Fiber* get_current();
+
+    private:
+        std::function<void()> _entry;
+        void* _stack;
+        size_t _stack_size;
+        bool _finished;
+
+        ucontext_t _context;
+        ucontext_t _caller;
+
+        static void run(unsigned int hi, unsigned int lo);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_FIBER_H
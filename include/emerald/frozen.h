@@ -0,0 +1,95 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_FROZEN_H
+#define _EMERALD_FROZEN_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "emerald/atom.h"
+#include "emerald/no_copy.h"
+#include "emerald/value.h"
+
+namespace emerald {
+
+    class Frozen;
+    class Object;
+    class Process;
+
+    using FrozenRef = std::shared_ptr<const Frozen>;
+
+    // An immutable copy of a string, array or plain object that lives
+    // outside every process's heap and is shared by reference counting.
+    // A value is copied into the frozen region once, when it's frozen.
+    // After that a process is given it by allocating a wrapper in its heap
+    // which refers to the frozen copy, so sending a frozen string or array
+    // costs the same whatever its size. Wrappers can't be modified, and
+    // the elements and properties they hand out are frozen as well.
+    class Frozen {
+    public:
+        enum class Kind {
+            STRING,
+            ARRAY,
+            OBJECT
+        };
+
+        // An element or property value, either an immediate or a frozen
+        // string, array or object.
+        struct Element {
+            Value immediate;
+            FrozenRef frozen;
+        };
+
+        NO_COPY(Frozen);
+
+        // Returns a frozen copy of the value in the process. Immediates
+        // and values that are already frozen are returned as they are.
+        // Functions, class instances and anything else that may refer back
+        // to its process's mutable state can't be frozen.
+        static Value freeze(Value value, Process* process);
+
+        // Returns a new wrapper around the frozen value in the process.
+        static Object* thaw(const FrozenRef& frozen, Process* process);
+        static Value thaw(const Element& element, Process* process);
+
+        Kind get_kind() const;
+
+        const std::string& get_string() const;
+        const std::vector<Element>& get_elements() const;
+        const std::vector<std::pair<Atom, Element>>& get_properties() const;
+
+    private:
+        class Freezer;
+        class ThawRoots;
+
+        Kind _kind;
+        std::string _string;
+        std::vector<Element> _elements;
+        std::vector<std::pair<Atom, Element>> _properties;
+
+        Frozen(Kind kind);
+
+        static Object* thaw(const FrozenRef& frozen, Process* process, ThawRoots& roots);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_FROZEN_H
@@ -18,21 +18,36 @@
 #ifndef _EMERALD_HEAP_H
 #define _EMERALD_HEAP_H
 
+#include <chrono>
+#include <future>
 #include <mutex>
+#include <new>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "emerald/heap_allocator.h"
 #include "emerald/heap_managed.h"
 #include "emerald/heap_root_source.h"
+#include "emerald/heap_stats.h"
 
 namespace emerald {
 
+    // A generational, non-moving heap. New objects are appended to the
+    // nursery, which is collected on its own once it reaches the threshold,
+    // tracing from the roots and the remembered set of old objects that were
+    // written young references. Survivors are promoted to the old
+    // generation. Once it doubles in size the old generation is marked
+    // incrementally, in slices run after each young collection that are each
+    // bounded by the pause budget, and then swept on the Sweeper's thread
+    // while the process keeps running. Objects are carved out of the
+    // heap's own size class pools, so processes on different threads never
+    // contend on malloc.
     class Heap {
     public:
         Heap();
         ~Heap();
 
-        const std::unordered_set<HeapManaged*>& get_managed_set() const;
         size_t get_managed_count() const;
         void add_managed(HeapManaged* managed);
 
@@ -42,32 +57,114 @@ namespace emerald {
         void add_root_source(HeapRootSource* root_source);
         void remove_root_source(HeapRootSource* root_source);
 
+        // Called by the write barrier when an old object is given a
+        // reference to a young one.
+        void remember(HeapManaged* managed);
+
+        // Called by the write barrier when a marked old object is given a
+        // reference to an unmarked old one while the old generation is
+        // being marked incrementally.
+        void shade(HeapManaged* managed);
+
         void collect();
 
         size_t threshold() const;
         void set_threshold(size_t threshold);
 
+        // A pause budget of zero collects the old generation in one go.
+        std::chrono::microseconds pause_budget() const;
+        void set_pause_budget(std::chrono::microseconds pause_budget);
+
+        bool is_marking() const;
+
+        HeapStats get_stats() const;
+
+        void start_profiling(size_t sample_interval, HeapStats::SiteLocator locator);
+        void stop_profiling();
+
     private:
-        std::unordered_set<HeapManaged*> _managed_set;
+        enum class Phase {
+            IDLE,
+            MARKING,
+            SWEEPING
+        };
+
+        // The number of objects traced between budget checks.
+        static const size_t SLICE_STRIDE = 64;
+
+        struct SweepJob {
+            std::vector<HeapManaged*> objects;
+            std::vector<HeapManaged*> survivors;
+            HeapAllocator::FreedCells freed;
+            std::vector<size_t> freed_counts;
+        };
+
+        std::vector<HeapManaged*> _nursery;
+        std::vector<HeapManaged*> _old;
+        std::vector<HeapManaged*> _remembered_set;
+
+        Phase _phase;
+        MarkStack _old_mark_stack;
+        SweepJob _sweep_job;
+        std::future<void> _sweep_done;
+
         std::unordered_set<HeapRootSource*> _root_source_set;
 
+        HeapAllocator _allocator;
+        HeapStats _stats;
+
         mutable std::mutex _mutex;
 
         size_t _threshold;
+        size_t _old_threshold;
+        std::chrono::microseconds _pause_budget;
 
+        void collect_young_nolock();
         void collect_nolock();
+
+        bool mark_old_slice(std::chrono::steady_clock::time_point deadline);
+        void start_old_sweep();
+        bool finish_old_sweep(bool wait);
+        void abort_old_collection();
+
+        static void sweep(SweepJob& job);
+
+        void mark_roots(MarkStack& stack);
+        void sweep_nursery();
+        void clear_remembered_set();
+
+        void deallocate(HeapManaged* managed);
     };
 
     template <class T, class... Args>
     T* Heap::allocate(Args&&... args) {
         std::lock_guard<std::mutex> lock(_mutex);
-        if (_managed_set.size() >= _threshold) {
-            collect_nolock();
-            _threshold *= 2;
+        if (_nursery.size() >= _threshold) {
+            collect_young_nolock();
         }
 
-        T* managed = new T(std::forward<Args>(args)...);
-        _managed_set.insert(managed);
+        constexpr uint8_t size_class = HeapAllocator::get_size_class(sizeof(T));
+        static_assert(alignof(T) <= HeapAllocator::GRANULARITY, "over aligned heap managed type");
+
+        T* managed;
+        if constexpr (size_class == HeapAllocator::LARGE_SIZE_CLASS) {
+            managed = new T(std::forward<Args>(args)...);
+        } else {
+            void* cell = _allocator.allocate(size_class);
+            try {
+                managed = new (cell) T(std::forward<Args>(args)...);
+            } catch (...) {
+                _allocator.deallocate(cell, size_class);
+                throw;
+            }
+            managed->set_size_class(size_class);
+        }
+
+        uint16_t type_id = HeapTypes::get_id<T>();
+        managed->set_type_id(type_id);
+        _stats.record_allocation(type_id, sizeof(T));
+
+        _nursery.push_back(managed);
         return managed;
     }
 
@@ -0,0 +1,90 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_HEAP_ALLOCATOR_H
+#define _EMERALD_HEAP_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    // A segregated fits allocator for heap managed objects. Each size class
+    // carves fixed size cells out of chunks and keeps freed cells on an
+    // intrusive free list, so allocation and sweeping don't go through
+    // malloc. Every Heap owns one, it isn't thread safe on its own.
+    class HeapAllocator {
+        struct FreeCell {
+            FreeCell* next;
+        };
+
+    public:
+        static const size_t GRANULARITY = 16;
+        static const size_t NUM_SIZE_CLASSES = 32;
+        static const size_t MAX_CELL_SIZE = GRANULARITY * NUM_SIZE_CLASSES;
+        static const size_t CHUNK_SIZE = 16 * 1024;
+
+        // Objects bigger than MAX_CELL_SIZE are allocated with new.
+        static const uint8_t LARGE_SIZE_CLASS = 0xff;
+
+        // Cells freed away from the allocator, e.g. on the sweeper thread,
+        // which are handed back to it all at once.
+        class FreedCells {
+        public:
+            FreedCells();
+
+            void add(void* ptr, uint8_t size_class);
+
+        private:
+            friend class HeapAllocator;
+
+            std::array<FreeCell*, NUM_SIZE_CLASSES> _heads;
+            std::array<FreeCell*, NUM_SIZE_CLASSES> _tails;
+        };
+
+        static constexpr uint8_t get_size_class(size_t size) {
+            return size > MAX_CELL_SIZE
+                ? LARGE_SIZE_CLASS
+                : static_cast<uint8_t>((size + GRANULARITY - 1) / GRANULARITY - 1);
+        }
+
+        HeapAllocator();
+        ~HeapAllocator();
+
+        NO_COPY(HeapAllocator);
+
+        void* allocate(uint8_t size_class);
+        void deallocate(void* ptr, uint8_t size_class);
+        void reclaim(FreedCells& cells);
+
+        size_t get_num_chunks() const;
+
+    private:
+        std::array<FreeCell*, NUM_SIZE_CLASSES> _free_lists;
+        std::vector<void*> _chunks;
+
+        void refill(uint8_t size_class);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_HEAP_ALLOCATOR_H
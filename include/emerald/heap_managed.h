@@ -18,9 +18,14 @@
 #ifndef _EMERALD_HEAP_MANAGED_H
 #define _EMERALD_HEAP_MANAGED_H
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace emerald {
 
     class Heap;
+    class MarkStack;
 
     class HeapManaged {
     public:
@@ -29,14 +34,67 @@ namespace emerald {
 
         bool is_marked() const;
 
-        void mark();
+        void mark(MarkStack& stack);
         void unmark();
 
+        // Objects start out in the young generation and are promoted
+        // once they survive a collection.
+        bool is_old() const;
+        void promote();
+
+        // Whether this old object is in the heap's remembered set, i.e.
+        // it may reference young objects.
+        bool is_remembered() const;
+        void set_remembered(bool remembered);
+
+        // The HeapAllocator size class the object was allocated from.
+        uint8_t get_size_class() const;
+        void set_size_class(uint8_t size_class);
+
+        // The HeapTypes id of the object's type.
+        uint16_t get_type_id() const;
+        void set_type_id(uint16_t type_id);
+
     protected:
-        virtual void reach();
+        virtual void reach(MarkStack& stack);
 
     private:
+        friend class MarkStack;
+
         bool _marked;
+        bool _old;
+        bool _remembered;
+        uint8_t _size_class;
+        uint16_t _type_id;
+    };
+
+    // Objects are traced from an explicit stack rather than by recursing
+    // through reach, so long chains of references can't overflow the
+    // native stack. A stack can be limited to one generation, objects of
+    // the other generation are assumed to be live and aren't traced.
+    class MarkStack {
+    public:
+        enum class Generation {
+            YOUNG,
+            OLD,
+            ALL
+        };
+
+        MarkStack(Generation generation);
+
+        void push(HeapManaged* managed);
+        void trace(HeapManaged* managed);
+        void drain();
+
+        // Traces at most limit objects, returns whether the stack is empty.
+        bool drain(size_t limit);
+
+        bool empty() const;
+        void clear();
+
+    private:
+        std::vector<HeapManaged*> _stack;
+        Generation _generation;
     };
 
 } // namespace emerald
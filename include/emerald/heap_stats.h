@@ -0,0 +1,162 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_HEAP_STATS_H
+#define _EMERALD_HEAP_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <vector>
+
+namespace emerald {
+
+    class Process;
+
+    // Every type allocated on a heap is given a small id the first time it
+    // is allocated, which heaps use to keep statistics per type.
+    class HeapTypes {
+    public:
+        template <class T>
+        static uint16_t get_id();
+
+        static std::string get_name(uint16_t id);
+
+    private:
+        static std::mutex _mutex;
+        static std::vector<std::string> _names;
+
+        static uint16_t add(const std::type_info& info);
+    };
+
+    template <class T>
+    uint16_t HeapTypes::get_id() {
+        static const uint16_t id = add(typeid(T));
+        return id;
+    }
+
+    struct CollectionStats {
+        enum class Kind {
+            YOUNG,
+            FULL
+        };
+
+        Kind kind;
+        std::chrono::microseconds pause;
+        size_t objects;
+        size_t survivors;
+    };
+
+    // Where a sampled allocation happened, the label of the code object
+    // that was running and the instruction it was on.
+    struct AllocationSite {
+        std::string label;
+        size_t instruction;
+
+        bool operator<(const AllocationSite& other) const;
+    };
+
+    struct AllocationSample {
+        AllocationSite site;
+        uint16_t type_id;
+        size_t count;
+    };
+
+    // Statistics kept by a Heap, every method must be called with the
+    // heap's lock held.
+    class HeapStats {
+    public:
+        static const size_t MAX_RECENT_COLLECTIONS = 64;
+
+        using SiteLocator = std::function<AllocationSite()>;
+
+        HeapStats();
+
+        void record_allocation(uint16_t type_id, size_t size);
+        void record_free(uint16_t type_id, size_t count = 1);
+        void record_collection(const CollectionStats& collection);
+        void record_old_sweep(size_t objects, size_t survivors);
+
+        size_t get_num_types() const;
+        size_t get_live_count(uint16_t type_id) const;
+        size_t get_live_bytes(uint16_t type_id) const;
+        size_t get_live_count() const;
+        size_t get_live_bytes() const;
+
+        size_t get_num_allocations() const;
+        size_t get_allocated_bytes() const;
+
+        // Bytes allocated per second since the heap was created.
+        double get_allocation_rate() const;
+
+        size_t get_num_collections(CollectionStats::Kind kind) const;
+        size_t get_num_old_collections() const;
+        std::chrono::microseconds get_total_pause() const;
+        std::chrono::microseconds get_max_pause() const;
+        const std::deque<CollectionStats>& get_recent_collections() const;
+
+        double get_young_survivor_ratio() const;
+        double get_old_survivor_ratio() const;
+
+        // Samples one in every sample_interval allocations on average, made
+        // by the process that started profiling. Other processes only clone
+        // messages into the heap.
+        void start_profiling(size_t sample_interval, SiteLocator locator);
+        void stop_profiling();
+        bool is_profiling() const;
+        std::vector<AllocationSample> get_profile() const;
+
+    private:
+        std::chrono::steady_clock::time_point _created;
+
+        std::vector<size_t> _live_counts;
+        std::vector<size_t> _type_sizes;
+        size_t _num_allocations;
+        size_t _allocated_bytes;
+
+        size_t _num_young_collections;
+        size_t _num_full_collections;
+        size_t _num_old_collections;
+        std::chrono::microseconds _total_pause;
+        std::chrono::microseconds _max_pause;
+        std::deque<CollectionStats> _recent_collections;
+
+        double _young_survivor_ratio;
+        double _old_survivor_ratio;
+
+        size_t _sample_interval;
+        size_t _until_sample;
+        std::minstd_rand _sample_random;
+        SiteLocator _locator;
+        const Process* _profiling_process;
+        std::map<std::tuple<AllocationSite, uint16_t>, size_t> _samples;
+
+        void reset_sample_countdown();
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_HEAP_STATS_H
@@ -0,0 +1,70 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_INLINE_CACHE_H
+#define _EMERALD_INLINE_CACHE_H
+
+#include "emerald/atom.h"
+#include "emerald/shape.h"
+#include "emerald/value.h"
+
+namespace emerald {
+
+    class Object;
+
+    // Per instruction cache of property lookups and stores, keyed on the
+    // shape of the object being accessed. A cache holds up to MAX_ENTRIES
+    // shapes for a single key, after which it stops learning new ones.
+    class InlineCache {
+    public:
+        static const size_t MAX_ENTRIES = 4;
+
+        InlineCache();
+
+        // Returns the contents of the cached slot, which is the accessor's
+        // PropertyDescriptor when accessor is set.
+        Value lookup(const Object* obj, Atom key, size_t epoch, bool& accessor) const;
+        void add_lookup(const Object* obj, Atom key, Object* holder, const Shape::Property& property, size_t epoch);
+
+        // Only data properties are cached for own stores.
+        bool lookup_own(const Object* obj, Atom key, size_t& slot) const;
+        void add_own(const Object* obj, Atom key, const Shape::Property& property);
+
+        Shape* lookup_transition(const Object* obj, Atom key, size_t epoch) const;
+        void add_transition(Shape* shape, Object* parent, Atom key, Shape* transition, size_t epoch);
+
+    private:
+        struct Entry {
+            Shape* shape;
+            Shape* transition;
+            Object* parent;
+            Object* holder;
+            size_t slot;
+            bool accessor;
+            size_t epoch;
+        };
+
+        Atom _key;
+        Entry _entries[MAX_ENTRIES];
+        size_t _num_entries;
+
+        bool can_add(Shape* shape, Atom key);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_INLINE_CACHE_H
@@ -19,61 +19,92 @@
 #define _EMERALD_INTERPRETER_H
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "fmt/format.h"
 
+#include "emerald/inline_cache.h"
 #include "emerald/magic_methods.h"
 #include "emerald/object.h"
+#include "emerald/opcode.h"
 #include "emerald/process.h"
 
 namespace emerald {
 
     class Code;
     class Module;
+    struct JitHelpers;
 
     class Interpreter {
     public:
-        static Object* execute(Process* process);
+        static Value execute(Process* process);
         template <class T>
-        static T* execute_method(Object* receiver, const std::string& name, const std::vector<Object*>& args, Process* process);
-        static Object* execute_module(const std::string& module_name, Process* process);
+        static T execute_method(Value receiver, Atom name, const std::vector<Value>& args, Process* process);
+        static Value execute_module(const std::string& module_name, Process* process);
         static Module* import_module(const std::string& name, Process* process);
         template <class T>
-        static T* create_obj(Object* parent, const std::vector<Object*>& args, Process* process);
+        static T* create_obj(Value parent, const std::vector<Value>& args, Process* process);
         template <class T>
-        static T* call_obj(Object* obj, Object* receiver, const std::vector<Object*>& args, Process* process);
+        static T call_obj(Value obj, Value receiver, const std::vector<Value>& args, Process* process);
+
+        static Value get_property(Value obj, Atom name, Process* process);
+        static bool has_property(Value obj, Atom name, Process* process);
 
     private:
+        friend struct JitHelpers;
+
         template <class T>
-        static T* call_method(Object* receiver, const std::string& name, size_t num_args, Process* process);
+        static T call_method(Value receiver, Atom name, size_t num_args, Process* process);
         template <class T>
-        static T* call_method0(Object* receiver, const std::string& name, Process* process) { return call_method<T>(receiver, name, 0, process); }
+        static T call_method0(Value receiver, Atom name, Process* process) { return call_method<T>(receiver, name, 0, process); }
         template <class T>
-        static T* call_method1(Object* receiver, const std::string& name, Process* process) { return call_method<T>(receiver, name, 1, process); }
+        static T call_method1(Value receiver, Atom name, Process* process) { return call_method<T>(receiver, name, 1, process); }
         template <class T>
-        static T* call_method2(Object* receiver, const std::string& name, Process* process) { return call_method<T>(receiver, name, 2, process); }
+        static T call_method2(Value receiver, Atom name, Process* process) { return call_method<T>(receiver, name, 2, process); }
+        template <class T>
+        static T call_method(Value receiver, Atom name, const std::vector<Value>& args, Process* process);
+
         template <class T>
-        static T* call_method(Object* receiver, const std::string& name, const std::vector<Object*>& args, Process* process);
+        static T convert_result(Value res, Process* process);
+        static Value call_obj_from_stack(Value obj, Value receiver, size_t num_args, Process* process);
 
         static Module* get_module(const std::string& name, bool& created, Process* process);
 
-        static Object* new_obj(bool explicit_parent, size_t num_props, Process* process);
+        static Value new_obj(bool explicit_parent, size_t num_props, Process* process);
+
+        static Object* get_property_holder(Value obj, Process* process);
+
+        static Value get_property(Value obj, Atom name, InlineCache& cache, Process* process);
+        static void set_property(Object* obj, Atom name, Value val, InlineCache& cache, Process* process);
+
+        static Value execute_frame(Stack::Frame& frame, Process* process);
+
+        static void execute_binary_op(OpCode::Value op, Stack::Frame& frame, Process* process);
+        static void execute_register_op(const Code::PackedInstruction* instr, Stack::Frame& frame, const Code* code, Process* process);
+        static Value load_operand(uint32_t operand, Stack::Frame& frame, const Code* code);
+        static void store_operand(uint32_t operand, Value val, Stack::Frame& frame);
+        static bool try_builtin_binary_op(OpCode::Value op, Value lhs, Value rhs, Value& res, Process* process);
+        static bool try_number_binary_op(OpCode::Value op, double lhs, double rhs, Value& res);
+        static bool try_string_binary_op(OpCode::Value op, const String* lhs, const String* rhs, Value& res, Process* process);
+        static bool is_builtin_string(String* str, Process* process);
+        static Atom get_binary_op_name(OpCode::Value op);
+        static OpCode::Value get_stack_op(OpCode::Value op);
     };
 
     template <class T>
-    T* Interpreter::execute_method(Object* receiver, const std::string& name, const std::vector<Object*>& args, Process* process) {
+    T Interpreter::execute_method(Value receiver, Atom name, const std::vector<Value>& args, Process* process) {
         return call_method<T>(receiver, name, args, process);
     }
 
     template <class T>
-    T* Interpreter::create_obj(Object* parent, const std::vector<Object*>& args, Process* process) {
-        T* obj = Interpreter::execute_method<T>(
+    T* Interpreter::create_obj(Value parent, const std::vector<Value>& args, Process* process) {
+        T* obj = Interpreter::execute_method<T*>(
                 parent,
                 magic_methods::clone,
                 {},
                 process);
-        Interpreter::execute_method<Null>(
+        Interpreter::execute_method<Value>(
             obj,
             magic_methods::init,
             args,
@@ -83,29 +114,55 @@ namespace emerald {
     }
 
     template <>
-    Object* Interpreter::call_obj<Object>(Object* obj, Object* receiver, const std::vector<Object*>& args, Process* process);
+    Value Interpreter::call_obj<Value>(Value obj, Value receiver, const std::vector<Value>& args, Process* process);
+
+    template <class T>
+    T Interpreter::call_obj(Value obj, Value receiver, const std::vector<Value>& args, Process* process) {
+        return convert_result<T>(call_obj<Value>(obj, receiver, args, process), process);
+    }
 
+    // Results are converted to T, where T is Value, bool, double or a
+    // pointer to an Object subclass. Heap allocated Booleans and Numbers are
+    // accepted wherever an immediate is expected.
     template <class T>
-    T* Interpreter::call_obj(Object* obj, Object* receiver, const std::vector<Object*>& args, Process* process) {
-        if (T* res = dynamic_cast<T*>(call_obj<Object>(obj, receiver, args, process))) {
+    T Interpreter::convert_result(Value res, Process* process) {
+        if constexpr (std::is_same_v<T, Value>) {
             return res;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (res.is_boolean()) {
+                return res.get_boolean();
+            } else if (Boolean* boolean = res.get_object_as<Boolean>()) {
+                return boolean->get_native_value();
+            }
+        } else if constexpr (std::is_same_v<T, double>) {
+            if (res.is_number()) {
+                return res.get_number();
+            } else if (Number* num = res.get_object_as<Number>()) {
+                return num->get_native_value();
+            }
+        } else if (T ptr = res.get_object_as<std::remove_pointer_t<T>>()) {
+            return ptr;
         }
 
         throw process->get_heap().allocate<Exception>(process, "");
     }
 
     template <class T>
-    T* Interpreter::call_method(Object* receiver, const std::string& name, size_t num_args, Process* process) {
-        std::vector<Object*> args = process->get_stack().peek().pop_n_ds(num_args);
-        return call_method<T>(receiver, name, args, process);
+    T Interpreter::call_method(Value receiver, Atom name, size_t num_args, Process* process) {
+        if (Value method = get_property(receiver, name, process)) {
+            return convert_result<T>(call_obj_from_stack(method, receiver, num_args, process), process);
+        } else {
+            process->get_stack().peek().drop_n_ds(num_args);
+            throw process->get_heap().allocate<Exception>(process, fmt::format("no such method: {0}", name.get_str()));
+        }
     }
 
     template <class T>
-    T* Interpreter::call_method(Object* receiver, const std::string& name, const std::vector<Object*>& args, Process* process) {
-        if (Object* method = receiver->get_property(name)) {
+    T Interpreter::call_method(Value receiver, Atom name, const std::vector<Value>& args, Process* process) {
+        if (Value method = get_property(receiver, name, process)) {
             return call_obj<T>(method, receiver, args, process);
         } else {
-            throw process->get_heap().allocate<Exception>(process, fmt::format("no such method: {0}", name));
+            throw process->get_heap().allocate<Exception>(process, fmt::format("no such method: {0}", name.get_str()));
         }
     }
 
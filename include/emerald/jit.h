@@ -0,0 +1,141 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_JIT_H
+#define _EMERALD_JIT_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "emerald/code.h"
+#include "emerald/no_copy.h"
+#include "emerald/stack.h"
+#include "emerald/value.h"
+
+// Native code is only emitted for x86-64 with the System V calling
+// convention, everywhere else code always runs in the interpreter.
+#if defined(__x86_64__) && defined(__linux__)
+#define EMERALD_JIT
+#endif
+
+namespace emerald {
+
+    class Process;
+
+    // The native code of a Code object. Local loads and stores, number
+    // arithmetic and comparisons, and branches on booleans are compiled to
+    // inline machine code working on the frame's slots and data stack,
+    // which calls the interpreter's helper for the instruction when an
+    // operand has another type or the builtin operators were replaced.
+    // Everything else, property access, calls, magic methods and
+    // allocation, is always a call to a helper. Every instruction is also
+    // an entry point, so a frame can move into the native code at a loop's
+    // back edge or at a catch.
+    class JitCode {
+    public:
+        // What the native code keeps at hand while it runs a frame, filled
+        // in by Jit::execute and read by the code at fixed offsets.
+        struct Context {
+            Stack::Frame* frame;
+            Process* process;
+            const Code* code;
+            std::vector<Value>* values;
+
+            // Where the frame's local slots start in values, in bytes.
+            size_t locals_offset;
+
+            const std::atomic<bool>* sample_requested;
+            uint32_t* reductions;
+            const bool* builtin_number_ops;
+            const bool* builtin_boolean_ops;
+        };
+
+        // Takes the context and the entry point, returns how the code was
+        // left.
+        using Function = uint32_t (*)(const Context* context, const uint8_t* entry);
+
+        JitCode(uint8_t* memory, size_t size, std::vector<uint32_t> entries);
+        ~JitCode();
+
+        NO_COPY(JitCode);
+
+        Function get_function() const;
+        const uint8_t* get_entry(size_t ip) const;
+        size_t get_size() const;
+
+    private:
+        uint8_t* _memory;
+        size_t _size;
+        std::vector<uint32_t> _entries;
+    };
+
+    struct JitHelpers;
+
+    // Counts how often each Code object is entered and loops, compiling
+    // it once that reaches the threshold. Code containing an instruction
+    // the JIT does not support stays in the interpreter.
+    class Jit {
+    public:
+        static const uint32_t DEFAULT_THRESHOLD = 1000;
+
+        static bool is_enabled();
+        static void set_enabled(bool enabled);
+
+        static uint32_t get_threshold();
+        static void set_threshold(uint32_t threshold);
+
+        static size_t get_num_compiled();
+
+        // Called by the interpreter when it enters code and when it takes
+        // a backward jump, returns the native code once there is some.
+        static const JitCode* count(const Code& code);
+
+        // Runs the frame from its instruction pointer until it returns.
+        static Value execute(const JitCode& jit_code, Stack::Frame& frame, Process* process);
+
+    private:
+        static std::atomic<bool> _enabled;
+        static std::atomic<uint32_t> _threshold;
+        static std::atomic<size_t> _num_compiled;
+        static std::mutex _mutex;
+
+        static const JitCode* compile(const Code& code);
+    };
+
+    inline const JitCode* Jit::count(const Code& code) {
+        if (const JitCode* jit_code = code._jit_code.load(std::memory_order_acquire)) {
+            return jit_code;
+        }
+
+        // Processes running the same code race on the counter, which only
+        // needs to be roughly right.
+        uint32_t hotness = code._hotness.load(std::memory_order_relaxed) + 1;
+        code._hotness.store(hotness, std::memory_order_relaxed);
+        if (hotness < _threshold.load(std::memory_order_relaxed) ||
+            code._jit_failed.load(std::memory_order_relaxed) ||
+            !_enabled.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return compile(code);
+    }
+
+} // namespace emerald
+
+#endif // _EMERALD_JIT_H
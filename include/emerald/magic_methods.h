@@ -18,7 +18,7 @@
 #ifndef _EMERALD_MAGIC_METHODS_H
 #define _EMERALD_MAGIC_METHODS_H
 
-#include <string>
+#include "emerald/atom.h"
 
 namespace emerald {
 namespace magic_methods {
@@ -65,7 +65,7 @@ namespace magic_methods {
     X(clone)                    \
     X(init)
 
-#define X(name) const std::string name = "__" #name "__";
+#define X(name) inline const Atom name = Atom::intern("__" #name "__");
 _MAGIC_METHODS
 #undef X
 
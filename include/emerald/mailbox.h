@@ -18,27 +18,86 @@
 #ifndef _EMERALD_MAILBOX_H
 #define _EMERALD_MAILBOX_H
 
-#include <condition_variable>
+#include <atomic>
 #include <deque>
-#include <mutex>
 
-#include "emerald/heap_root_source.h"
+#include "emerald/no_copy.h"
+#include "emerald/parcel.h"
+#include "emerald/scheduler.h"
+#include "emerald/value.h"
 
 namespace emerald {
 
-    class Object;
+    class Process;
 
-    class Mailbox : public HeapRootSource {
+    // A multi-producer single-consumer queue of messages. Senders link
+    // their message in with a single atomic exchange and never block each
+    // other. The owning process moves whatever has been linked so far into
+    // a buffer of its own, from which it pops. No message refers to an
+    // object in either heap, so the mailbox is not a root of the owner's
+    // heap, and messages a sender has pushed but not yet linked need no
+    // keeping alive.
+    class Mailbox {
     public:
-        void push_msg(Object* message);
-        Object* pop_msg();
+        Mailbox(Process* process);
+        ~Mailbox();
 
-        std::vector<HeapManaged*> get_roots() override;
+        NO_COPY(Mailbox);
+
+        // Messages are pushed from the sender's thread in a form that
+        // belongs to neither heap, an immediate or a parcel, which is only
+        // unpacked into the owner's heap when it's popped.
+        void push_msg(Value message);
+        void push_msg(const ParcelRef& message);
+
+        // Parks the owning process until a message arrives.
+        Value pop_msg();
+
+        // As above, but gives up at the deadline and returns the empty
+        // value.
+        Value pop_msg(Scheduler::Clock::time_point deadline);
+
+        // Returns the empty value if there are no messages.
+        Value try_pop_msg();
+
+        size_t size() const;
+        size_t get_max_size() const;
+        size_t get_num_received() const;
 
     private:
-        std::deque<Object*> _mailbox;
-        std::mutex _mutex;
-        std::condition_variable _cv;
+        // The value is only ever an immediate.
+        struct Message {
+            Value value;
+            ParcelRef parcel;
+        };
+
+        struct Node {
+            Message message;
+            std::atomic<Node*> next;
+        };
+
+        Process* _process;
+
+        // Pushed to by senders. The tail is the last node taken, whose
+        // successor is the next message.
+        std::atomic<Node*> _head;
+        Node* _tail;
+
+        // Only touched by the owning process.
+        std::deque<Message> _received;
+
+        std::atomic<bool> _waiting;
+        std::atomic<size_t> _size;
+        std::atomic<size_t> _max_size;
+        std::atomic<size_t> _num_received;
+
+        // Tells senders to wake the owner, unless a message has arrived
+        // already, in which case there is no need to park.
+        bool prepare_to_park();
+
+        void push(const Message& message);
+
+        void take_linked();
     };
 
 } // namespace emerald
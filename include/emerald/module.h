@@ -29,6 +29,8 @@ namespace emerald {
 
     class Module : public Object {
     public:
+        static const Type TYPE = oModule;
+
         Module(Process* process, const std::string& name, std::shared_ptr<Code> code = nullptr);
         Module(Process* process, Object* parent, const std::string& name, std::shared_ptr<Code> code = nullptr);
 
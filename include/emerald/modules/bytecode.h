@@ -36,16 +36,19 @@ namespace modules {
 
     class BytecodeIterator : public Object {
     public:
+        static const Type TYPE = oBytecodeIterator;
+
         BytecodeIterator(Process* process);
         BytecodeIterator(Process* process, Object* parent);
 
         void init(Function* function);
 
         Object* cur() const;
-        Boolean* done() const;
+        bool done() const;
         Object* next();
 
         BytecodeIterator* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         std::shared_ptr<const Code> _code;
@@ -59,83 +59,100 @@ namespace modules {
 
     class Queue : public Object {
     public:
+        static const Type TYPE = oQueue;
+
         Queue(Process* process);
         Queue(Process* process, Object* parent);
 
         std::string as_str() const override;
 
-        Object* peek();
-        Object* dequeue();
-        void enqueue(Object* obj);
+        Value peek();
+        Value dequeue();
+        void enqueue(Value obj);
 
-        Boolean* empty() const;
-        Number* size() const;
+        bool empty() const;
+        size_t size() const;
 
-        Boolean* eq(Queue* other) const;
-        Boolean* neq(Queue* other) const;
+        bool eq(Queue* other) const;
+        bool neq(Queue* other) const;
 
         Queue* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
-        std::deque<Object*> _value;
+        std::deque<Value> _value;
 
         bool _eq(Queue* other) const;
+
+        void reach(MarkStack& stack) override;
     };
 
     class Set : public Object {
     public:
+        static const Type TYPE = oSet;
+
         Set(Process* process);
         Set(Process* process, Object* parent);
 
         std::string as_str() const override;
 
-        void add(Object* obj);
-        Boolean* contains(Object* obj) const;
-        void remove(Object* obj);
+        void add(Value obj);
+        bool contains(Value obj) const;
+        void remove(Value obj);
 
-        Boolean* empty() const;
-        Number* size() const;
+        bool empty() const;
+        size_t size() const;
 
-        Boolean* eq(Set* other) const;
-        Boolean* neq(Set* other) const;
+        bool eq(Set* other) const;
+        bool neq(Set* other) const;
 
         Set* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         struct hash {
-            size_t operator()(Object* val) const;
+            Process* process;
+            size_t operator()(Value val) const;
         };
 
         struct key_eq {
-            bool operator()(Object* lhs, Object* rhs) const;
+            Process* process;
+            bool operator()(Value lhs, Value rhs) const;
         };
 
-        std::unordered_set<Object*, hash, key_eq> _value;
+        std::unordered_set<Value, hash, key_eq> _value;
+
+        void reach(MarkStack& stack) override;
     };
 
     class Stack : public Object {
     public:
+        static const Type TYPE = oStack;
+
         Stack(Process* process);
         Stack(Process* process, Object* parent);
 
         std::string as_str() const override;
 
-        Object* peek() const;
-        Object* pop();
-        void push(Object* obj);
+        Value peek() const;
+        Value pop();
+        void push(Value obj);
 
-        Boolean* empty() const;
-        Number* size() const;
+        bool empty() const;
+        size_t size() const;
 
-        Boolean* eq(Stack* other) const;
-        Boolean* neq(Stack* other) const;
+        bool eq(Stack* other) const;
+        bool neq(Stack* other) const;
 
         Stack* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
-        std::deque<Object*> _value;
+        std::deque<Value> _value;
 
         bool _eq(Stack* other) const;
+
+        void reach(MarkStack& stack) override;
     };
 
 #define X(name) NATIVE_FUNCTION(name);
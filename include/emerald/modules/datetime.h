@@ -68,6 +68,8 @@ namespace modules {
 
     class Date : public Object {
     public:
+        static const Type TYPE = oDate;
+
         Date(Process* process);
         Date(Process* process, Object* parent);
 
@@ -78,19 +80,20 @@ namespace modules {
 
         std::string as_str() const override;
 
-        void init(Number* year, Number* month, Number* day);
+        void init(double year, double month, double day);
 
-        Number* year() const;
-        Number* month() const;
-        Number* day() const;
+        double year() const;
+        double month() const;
+        double day() const;
 
         String* day_of_week() const;
-        Number* day_of_year() const;
+        double day_of_year() const;
 
-        void add(Number* days);
-        void sub(Number* days);
+        void add(double days);
+        void sub(double days);
 
         Date* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         boost::gregorian::date _date;
@@ -98,6 +101,8 @@ namespace modules {
 
     class TimeDuration : public Object {
     public:
+        static const Type TYPE = oTimeDuration;
+
         TimeDuration(Process* process);
         TimeDuration(Process* process, Object* parent);
 
@@ -109,18 +114,18 @@ namespace modules {
         std::string as_str() const override;
 
         void init(
-            Number* hours,
-            Number* minutes,
-            Number* seconds,
-            Number* milliseconds);
+            double hours,
+            double minutes,
+            double seconds,
+            double milliseconds);
 
-        Number* hours() const;
-        Number* minutes() const;
-        Number* seconds() const;
-        Number* milliseconds() const;
+        double hours() const;
+        double minutes() const;
+        double seconds() const;
+        double milliseconds() const;
 
-        Number* total_seconds() const;
-        Number* total_milliseconds() const;
+        double total_seconds() const;
+        double total_milliseconds() const;
 
         void add(TimeDuration* other);
         void sub(TimeDuration* other);
@@ -128,6 +133,7 @@ namespace modules {
         const boost::posix_time::time_duration& get_native_value();
 
         TimeDuration* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         boost::posix_time::time_duration _duration;
@@ -135,6 +141,8 @@ namespace modules {
 
     class Time : public Object {
     public:
+        static const Type TYPE = oTime;
+
         Time(Process* process);
         Time(Process* process, Object* parent);
 
@@ -152,12 +160,13 @@ namespace modules {
         Date* date() const;
         TimeDuration* time_of_day() const;
 
-        void add(Number* days);
+        void add(double days);
         void add(TimeDuration* time);
-        void sub(Number* days);
+        void sub(double days);
         void sub(TimeDuration* time);
 
         Time* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         Date* _date;
@@ -25,7 +25,16 @@
     X(gc_collect)                   \
     X(gc_total_allocated_objects)   \
     X(gc_threshold)                 \
-    X(gc_set_threshold)
+    X(gc_set_threshold)             \
+    X(gc_pause_budget)              \
+    X(gc_set_pause_budget)          \
+    X(gc_stats)                     \
+    X(gc_type_stats)                \
+    X(gc_collections)               \
+    X(gc_start_profiling)           \
+    X(gc_stop_profiling)            \
+    X(gc_profile)                   \
+    X(gc_dump_profile)
 
 namespace emerald {
 namespace modules {
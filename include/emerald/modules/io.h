@@ -44,20 +44,23 @@ namespace modules {
 
     class FileStream final : public Object {
     public:
+        static const Type TYPE = oFileStream;
+
         FileStream(Process* process);
         FileStream(Process* process, Object* parent);
 
         std::string as_str() const override;
 
         void open(String* filename, String* access);
-        Boolean* is_open() const;
+        bool is_open() const;
 
         String* read();
-        String* read(Number* n);
+        String* read(double n);
         String* readline();
         void write(String* s);
 
         FileStream* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         std::fstream _stream;
@@ -65,16 +68,19 @@ namespace modules {
 
     class StringStream final : public Object {
     public:
+        static const Type TYPE = oStringStream;
+
         StringStream(Process* process);
         StringStream(Process* process, Object* parent);
 
         std::string as_str() const override;
 
-        String* read(Number* n);
+        String* read(double n);
         String* readline();
         void write(String* s);
 
         StringStream* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         std::stringstream _stream;
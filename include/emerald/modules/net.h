@@ -62,6 +62,8 @@ namespace modules {
 
     class IPAddress final : public Object {
     public:
+        static const Type TYPE = oIPAddress;
+
         IPAddress(Process* process);
         IPAddress(Process* process, Object* parent);
 
@@ -76,14 +78,15 @@ namespace modules {
 
         void init(String* address);
 
-        Boolean* is_loopback() const;
-        Boolean* is_multicast() const;
-        Boolean* is_unspecified() const;
+        bool is_loopback() const;
+        bool is_multicast() const;
+        bool is_unspecified() const;
 
-        Boolean* is_ipv4() const;
-        Boolean* is_ipv6() const;
+        bool is_ipv4() const;
+        bool is_ipv6() const;
 
         IPAddress* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         boost::asio::ip::address _address;
@@ -91,6 +94,8 @@ namespace modules {
 
     class IPEndpoint final : public Object {
     public:
+        static const Type TYPE = oIPEndpoint;
+
         IPEndpoint(Process* process);
         IPEndpoint(Process* process, Object* parent);
 
@@ -104,16 +109,16 @@ namespace modules {
 
         const boost::asio::ip::tcp::endpoint& get_native_endpoint() const;
 
-        void init(IPAddress* address, Number* port);
+        void init(IPAddress* address, double port);
 
         IPAddress* get_address() const;
-        Number* get_port() const;
+        double get_port() const;
 
         IPEndpoint* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         IPAddress* _address;
-        Number* _port;
 
         boost::asio::ip::tcp::endpoint _endpoint;
     };
@@ -122,15 +127,18 @@ namespace modules {
 
     class TcpClient final : public Object {
     public:
+        static const Type TYPE = oTcpClient;
+
         TcpClient(Process* process);
         TcpClient(Process* process, Object* parent);
 
-        Boolean* connect(IPEndpoint* endpoint);
+        bool connect(IPEndpoint* endpoint);
 
-        String* read(Number* bytes);
+        String* read(double bytes);
         void write(String* buffer);
 
         TcpClient* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         friend class TcpListener;
@@ -141,6 +149,8 @@ namespace modules {
 
     class TcpListener final : public Object {
     public:
+        static const Type TYPE = oTcpListener;
+
         TcpListener(Process* process);
         TcpListener(Process* process, Object* parent);
 
@@ -149,13 +159,14 @@ namespace modules {
         void start();
         void stop();
 
-        Boolean* is_listening() const;
+        bool is_listening() const;
 
         void accept(TcpClient* client);
 
         IPEndpoint* get_endpoint() const;
 
         TcpListener* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         bool _listening;
@@ -22,13 +22,17 @@
 #include "emerald/object.h"
 
 #define PROCESS_NATIVES \
-    X(process_create)   \
-    X(process_id)       \
-    X(process_join)     \
-    X(process_receive)  \
-    X(process_send)     \
-    X(process_sleep)    \
-    X(process_state)
+    X(process_create)          \
+    X(process_dump_profile)    \
+    X(process_id)              \
+    X(process_join)            \
+    X(process_profile)         \
+    X(process_receive)         \
+    X(process_send)            \
+    X(process_sleep)           \
+    X(process_start_profiling) \
+    X(process_state)           \
+    X(process_stop_profiling)
 
 namespace emerald {
 namespace modules {
@@ -18,6 +18,7 @@
 #ifndef _EMERALD_NATIVE_OBJECTS_H
 #define _EMERALD_NATIVE_OBJECTS_H
 
+#include "emerald/atom.h"
 #include "emerald/heap_root_source.h"
 
 namespace emerald {
@@ -64,9 +65,17 @@ namespace emerald {
         const Null* get_null() const;
         Null* get_null();
 
+        bool has_builtin_number_ops() const;
+        bool has_builtin_string_ops() const;
+        bool has_builtin_boolean_ops() const;
+
+        void property_changed(Object* obj, Atom key);
+
         std::vector<HeapManaged*> get_roots() override;
 
     private:
+        friend class Jit;
+
         Object* _object;
 
         Array* _array;
@@ -81,6 +90,10 @@ namespace emerald {
 
         Null* _null;
 
+        bool _builtin_number_ops;
+        bool _builtin_string_ops;
+        bool _builtin_boolean_ops;
+
         void initialize_object(Process* process);
         void initialize_array(Process* process);
         void initialize_exception(Process* process);
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "emerald/heap_root_source.h"
+#include "emerald/value.h"
 
 namespace emerald {
 
@@ -39,22 +40,18 @@ namespace emerald {
             NativeStack& get_stack();
             const NativeStack& get_stack() const;
 
-            Object* get_receiver();
-            const Object* get_receiver() const;
+            Value get_receiver() const;
 
-            const std::vector<Object*>& get_args() const;
             size_t num_args() const;
 
-            Object* get_arg(size_t arg_i);
-            const Object* get_arg(size_t arg_i) const;
+            Value get_arg(size_t arg_i) const;
 
             const Module* get_globals() const;
             Module* get_globals();
 
-            const Object* get_global(const std::string& name) const;
-            Object* get_global(const std::string& name);
+            Value get_global(Atom name) const;
 
-            void set_global(const std::string& name, Object* val);
+            void set_global(Atom name, Value val);
 
             const std::vector<Object*>& get_locals() const;
 
@@ -62,15 +59,30 @@ namespace emerald {
 
         private:
             NativeStack& _stack;
-            Object* _receiver;
-            std::vector<Object*> _args;
+            Value _receiver;
+
+            // The args are a window over the caller's values rather than a
+            // copy. Args taken from a data stack are in reverse, the first
+            // arg is on top.
+            const std::vector<Value>* _args;
+            size_t _args_begin;
+            size_t _num_args;
+            bool _args_reversed;
+
             Module* _globals;
             std::vector<Object*> _locals;
 
             friend class NativeStack;
 
             NativeFrame(NativeStack& stack);
-            NativeFrame(NativeStack& stack, Object* receiver, const std::vector<Object*>& args, Module* globals);
+            NativeFrame(
+                NativeStack& stack,
+                Value receiver,
+                const std::vector<Value>& args,
+                size_t args_begin,
+                size_t num_args,
+                bool args_reversed,
+                Module* globals);
         };
 
         class ScopedNativeFrame {
@@ -89,7 +101,11 @@ namespace emerald {
 
         void pop_frame();
         NativeFrame& push_frame();
-        NativeFrame& push_frame(Object* receiver, const std::vector<Object*>& args, Module* globals);
+        NativeFrame& push_frame(Value receiver, const std::vector<Value>& args, Module* globals);
+
+        // The args are the top num_args values of a data stack, which must
+        // stay there until the frame is popped.
+        NativeFrame& push_frame(Value receiver, const std::vector<Value>& values, size_t num_args, Module* globals);
 
         std::vector<HeapManaged*> get_roots() override;
 
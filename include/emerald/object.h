@@ -18,18 +18,24 @@
 #ifndef _EMERALD_OBJECT_H
 #define _EMERALD_OBJECT_H
 
-#include <functional>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "emerald/atom.h"
 #include "emerald/code.h"
+#include "emerald/frozen.h"
 #include "emerald/heap.h"
 #include "emerald/heap_managed.h"
 #include "emerald/native_stack.h"
+#include "emerald/parcel.h"
 #include "emerald/process.h"
+#include "emerald/shape.h"
+#include "emerald/value.h"
 
-#define NATIVE_FUNCTION(name) Object* name(Process* process, NativeStack::NativeFrame* frame)
+#define NATIVE_FUNCTION(name) Value name(Process* process, NativeStack::NativeFrame* frame)
 
 // Inheritance Hierarchy
 // - Object
@@ -42,6 +48,41 @@
 //      - Number
 //      - String
 
+// Every concrete object class, including those defined by native modules,
+// has a type tag so casts don't need RTTI.
+#define CORE_OBJECT_TYPES   \
+    X(Object)               \
+    X(Array)                \
+    X(ArrayIterator)        \
+    X(Boolean)              \
+    X(Exception)            \
+    X(Function)             \
+    X(Module)               \
+    X(NativeFunction)       \
+    X(Null)                 \
+    X(Number)               \
+    X(PropertyDescriptor)   \
+    X(String)
+
+#define MODULE_OBJECT_TYPES \
+    X(BytecodeIterator)     \
+    X(Queue)                \
+    X(Set)                  \
+    X(Stack)                \
+    X(Date)                 \
+    X(TimeDuration)         \
+    X(Time)                 \
+    X(FileStream)           \
+    X(StringStream)         \
+    X(IPAddress)            \
+    X(IPEndpoint)           \
+    X(TcpClient)            \
+    X(TcpListener)
+
+#define ALL_OBJECT_TYPES    \
+    CORE_OBJECT_TYPES       \
+    MODULE_OBJECT_TYPES
+
 namespace emerald {
 
     class Boolean;
@@ -54,90 +95,172 @@ namespace emerald {
 
     class Object : public HeapManaged {
     public:
-        Object(Process* process);
-        Object(Process* process, Object* parent);
+#define X(ObjectType) o##ObjectType,
+        enum Type {
+            ALL_OBJECT_TYPES
+        };
+#undef X
+
+        static const Type TYPE = oObject;
+
+        Object(Process* process, Type type = TYPE);
+        Object(Process* process, Object* parent, Type type = TYPE);
         virtual ~Object();
 
+        Type get_type() const { return _type; }
+
         virtual bool as_bool() const;
         virtual std::string as_str() const;
 
         Process* get_process() const;
         Object* get_parent() const;
 
-        const std::unordered_map<std::string, PropertyDescriptor*>& get_properties() const;
+        Shape* get_shape() const;
+
+        size_t num_properties() const;
+        std::vector<Atom> get_property_keys() const;
+
+        Value get_slot(size_t slot) const;
+        void set_slot(size_t slot, Value value);
+
+        Object* find_property_holder(Atom key, Shape::Property& property) const;
+
+        Value get_property(Atom key) const;
+        Value get_own_property(Atom key) const;
+
+        bool has_property(Atom key) const;
+        bool has_own_property(Atom key) const;
+
+        bool is_watched() const;
+        void set_watched(bool watched);
 
-        Object* get_property(const std::string& key) const;
-        Object* get_own_property(const std::string& key) const;
+        bool is_prototype() const;
 
-        PropertyDescriptor* get_property_descriptor(const std::string& key) const;
-        PropertyDescriptor* get_own_property_descriptor(const std::string& key) const;
+        // Frozen objects are wrappers around a value in the frozen region,
+        // and throw on any attempt to modify them.
+        bool is_frozen() const;
+        const FrozenRef& get_frozen() const;
 
-        bool has_property(const std::string& key) const;
-        bool has_own_property(const std::string& key) const;
+        void define_property(Atom key, Value value);
+        void define_property(Atom key, PropertyDescriptor* descriptor);
+        void set_property(Atom key, Value value);
 
-        void define_property(const std::string& key, PropertyDescriptor* descriptor);
-        void set_property(const std::string& key, Object* value);
+        // Adds a new data property using a transition of the current shape
+        // that was found earlier, the caller guarantees no setter intercepts it.
+        void add_property(Shape* transition, Value value);
 
         virtual Object* clone(Process* process, CloneCache& cache);
 
+        // Packs an object of a native type to be sent to another process,
+        // adding the values it refers to, which are packed along with it.
+        // Returns null if objects of the type can't be sent.
+        virtual std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const;
+
     protected:
         template <class T, class... Args>
         T* clone_impl(Process* process, CloneCache& cache, Args&&... args);
 
-        virtual void reach() override;
+        virtual void reach(MarkStack& stack) override;
+
+        Value get_property_value(const Object* holder, const Shape::Property& property) const;
+
+        void ensure_mutable() const;
 
-        Object* get_property_value(PropertyDescriptor* descriptor) const;
+        // Frozen objects are shared with the other process rather than
+        // copied into it.
+        Object* clone_frozen(Process* process, CloneCache& cache);
+
+        // Must be called whenever a reference is stored into an object
+        // that may already be in the old generation.
+        void write_barrier(Value val);
+        void write_barrier(HeapManaged* managed);
 
     private:
+        friend class Frozen;
+
         Process* _process;
         Object* _parent;
+        Type _type;
 
-        std::unordered_map<std::string, PropertyDescriptor*> _properties;
+        Shape* _shape;
+        std::unique_ptr<Shape> _dictionary_shape;
+        // Data properties are stored in their slot directly, accessor
+        // slots hold the PropertyDescriptor with the getter and setter.
+        std::vector<Value> _slots;
+
+        // Watched objects report property changes to NativeObjects, which
+        // uses this to guard the interpreter's builtin operator fast paths.
+        bool _watched;
+        bool _prototype;
+
+        FrozenRef _frozen;
+
+        void make_prototype();
+        void add_slot(Atom key, Value value, bool accessor);
+        void replace_slot(Atom key, const Shape::Property& property, Value value, bool accessor);
     };
 
+    // Tags name concrete classes, so a cast only succeeds on an object of
+    // exactly that class. Casting to Object always succeeds.
+    template <class T>
+    T* object_cast(Object* obj) {
+        if constexpr (std::is_same_v<T, Object>) {
+            return obj;
+        } else {
+            return obj && obj->get_type() == T::TYPE ? static_cast<T*>(obj) : nullptr;
+        }
+    }
+
     class ArrayIterator;
 
     class Array final : public Object {
     public:
-        Array(Process* process, const std::vector<Object*>& value = {});
-        Array(Process* process, Object* parent, const std::vector<Object*>& value = {});
+        static const Type TYPE = oArray;
+
+        Array(Process* process, const std::vector<Value>& value = {});
+        Array(Process* process, Object* parent, const std::vector<Value>& value = {});
 
         bool as_bool() const override;
         std::string as_str() const override;
 
-        void init(Object* iterator);
+        void init(Value iterator);
 
-        Object* at(Number* n) const;
-        Object* front() const;
-        Object* back() const;
+        Value at(size_t i) const;
+        Value front() const;
+        Value back() const;
 
-        Boolean* empty() const;
-        Number* size();
+        bool empty() const;
+        size_t size() const;
 
         void clear();
 
-        void push(Object* obj);
-        Object* pop();
+        void push(Value val);
+        Value pop();
 
         String* join(String* seperator) const;
 
-        Boolean* eq(Array* other) const;
-        Boolean* neq(Array* other) const;
+        bool eq(Array* other) const;
+        bool neq(Array* other) const;
 
         Array* clone(Process* process, CloneCache& cache) override;
 
     private:
         friend class ArrayIterator;
 
-        std::vector<Object*> _value;
+        // A frozen array wraps its elements in the process on first use.
+        std::vector<Value> _value;
+
+        const std::vector<Value>& get_values() const;
 
         bool _eq(Array* other) const;
 
-        void reach() override;
+        void reach(MarkStack& stack) override;
     };
 
     class ArrayIterator final : public Object {
     public:
+        static const Type TYPE = oArrayIterator;
+
         ArrayIterator(Process* process);
         ArrayIterator(Process* process, Object* parent);
 
@@ -145,34 +268,34 @@ namespace emerald {
 
         void init(Array* arr);
 
-        Object* cur() const;
-        Boolean* done() const;
-        Object* next();
+        Value cur() const;
+        bool done() const;
+        Value next();
 
         ArrayIterator* clone(Process* process, CloneCache& cache) override;
+        std::unique_ptr<Parcel::Native> pack(std::vector<Value>& values) const override;
 
     private:
         Array* _arr;
         size_t _i;
 
-        void reach() override;
+        void reach(MarkStack& stack) override;
     };
 
     class Boolean final : public Object {
     public:
+        static const Type TYPE = oBoolean;
+
         Boolean(Process* process, bool value = false);
         Boolean(Process* process, Object* parent, bool value = false);
 
         bool as_bool() const override;
         std::string as_str() const override;
 
-        void init(Boolean* val);
+        void init(bool val);
 
         bool get_native_value() const;
 
-        Boolean* eq(Boolean* other) const;
-        Boolean* neq(Boolean* other) const;
-
         Boolean* clone(Process* process, CloneCache& cache) override;
 
     private:
@@ -181,6 +304,8 @@ namespace emerald {
 
     class Exception : public Object {
     public:
+        static const Type TYPE = oException;
+
         Exception(Process* process, const std::string& message = "");
         Exception(Process* process, Object* parent, const std::string& message = "");
 
@@ -198,6 +323,8 @@ namespace emerald {
 
     class Function final : public Object {
     public:
+        static const Type TYPE = oFunction;
+
         Function(Process* process, std::shared_ptr<const Code> code, Module* globals);
         Function(Process* process, Object* parent, std::shared_ptr<const Code> code, Module* globals);
 
@@ -212,12 +339,14 @@ namespace emerald {
         std::shared_ptr<const Code> _code;
         Module* _globals;
 
-        void reach() override;
+        void reach(MarkStack& stack) override;
     };
 
     class NativeFunction final : public Object {
     public:
-        using Callable = std::function<Object*(Process*, NativeStack::NativeFrame*)>;
+        static const Type TYPE = oNativeFunction;
+
+        using Callable = Value (*)(Process*, NativeStack::NativeFrame*);
 
         NativeFunction(Process* process, Callable callable, Module* globals = nullptr);
         NativeFunction(Process* process, Object* parent, Callable callable, Module* globals = nullptr);
@@ -227,8 +356,12 @@ namespace emerald {
         const Callable& get_callable() const;
         Module* get_globals() const;
 
-        Object* invoke(Object* receiver, const std::vector<Object*>& args, Module* globals);
-        Object* operator()(Object* receiver, const std::vector<Object*>& args, Module* globals);
+        Value invoke(Value receiver, const std::vector<Value>& args, Module* globals);
+        Value operator()(Value receiver, const std::vector<Value>& args, Module* globals);
+
+        // The args are the top num_args values of the process's stack, in
+        // reverse. They are read in place and left on the stack.
+        Value invoke_from_stack(Value receiver, size_t num_args, Module* globals);
 
         NativeFunction* clone(Process* process, CloneCache& cache) override;
 
@@ -239,6 +372,8 @@ namespace emerald {
 
     class Null final : public Object {
     public:
+        static const Type TYPE = oNull;
+
         Null(Process* process);
         Null(Process* process, Object* parent);
 
@@ -250,19 +385,20 @@ namespace emerald {
 
     class Number final : public Object {
     public:
+        static const Type TYPE = oNumber;
+
         Number(Process* process, double value = 0);
         Number(Process* process, Object* parent, double value = 0);
 
         bool as_bool() const override;
         std::string as_str() const override;
 
-        void init(Number* val);
+        void init(double val);
 
         double get_native_value() const;
         void set_native_value(double val);
 
-        void increment();
-        void decrement();
+        static std::string format(double val);
 
         Number* clone(Process* process, CloneCache& cache) override;
 
@@ -270,20 +406,14 @@ namespace emerald {
         double _value;
     };
 
+    // Materialized only for accessor properties, data properties live
+    // directly in their object's slots.
     class PropertyDescriptor final : public Object {
     public:
-        enum Type {
-            ACCESSOR,
-            DATA
-        };
+        static const Type TYPE = oPropertyDescriptor;
 
-        PropertyDescriptor(Process* process, Object* value);
         PropertyDescriptor(Process* process, Object* getter, Object* setter);
-
-        Type get_type() const;
-
-        Object* get_value() const;
-        void set_value(Object* value);
+        PropertyDescriptor(Process* process, Object* parent);
 
         Object* get_getter() const;
         Object* get_setter() const;
@@ -291,36 +421,38 @@ namespace emerald {
         PropertyDescriptor* clone(Process* process, CloneCache& cache) override;
 
     private:
-        Type _type;
-        struct Accessor {
-            Object* getter;
-            Object* setter;
-        };
-        union {
-            Accessor _accessor;
-            Object* _value;
-        };
+        Object* _getter;
+        Object* _setter;
 
-        void reach() override;
+        void reach(MarkStack& stack) override;
     };
 
     class String final : public Object {
     public:
+        static const Type TYPE = oString;
+
         String(Process* process, const std::string& value = "");
         String(Process* process, Object* parent, const std::string& value = "");
+        String(Process* process, Object* parent, Atom value);
 
         bool as_bool() const override;
         std::string as_str() const override;
 
         void init(String* val);
+        void append(const std::string& str);
 
-        std::string& get_native_value();
         const std::string& get_native_value() const;
 
+        Atom get_atom() const;
+
         String* clone(Process* process, CloneCache& cache) override;
 
     private:
         std::string _value;
+
+        // Interned on first use as a property key, cleared whenever the
+        // value may be modified.
+        mutable Atom _atom;
     };
 
     class CloneCache final : public HeapRootSource {
@@ -351,9 +483,18 @@ namespace emerald {
             // We have to clone the object first because
             // there may be a circular reference.
             obj->_parent = _parent->clone(process, cache);
+            obj->write_barrier(obj->_parent);
+            obj->_parent->make_prototype();
         }
-        for (std::pair<std::string, PropertyDescriptor*> pair : get_properties()) {
-            obj->define_property(pair.first, pair.second->clone(process, cache));
+        for (Atom key : get_property_keys()) {
+            Shape::Property property;
+            _shape->lookup(key, property);
+            Value val = _slots[property.slot];
+            if (property.accessor) {
+                obj->define_property(key, static_cast<PropertyDescriptor*>(val.get_object())->clone(process, cache));
+            } else {
+                obj->define_property(key, val.clone(process, cache));
+            }
         }
         return obj;
     }
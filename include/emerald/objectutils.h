@@ -18,6 +18,8 @@
 #ifndef _EMERALD_OBJECTUTILS_H
 #define _EMERALD_OBJECTUTILS_H
 
+#include <optional>
+
 #include "fmt/format.h"
 
 #include "emerald/interpreter.h"
@@ -43,7 +45,7 @@
 #define CONVERT_VAL_TO(val, Type, name)                         \
     Type* name  = nullptr;                                      \
     do {                                                        \
-        name = dynamic_cast<Type*>(val);                        \
+        name = (val).get_object_as<Type>();                     \
         if (name == nullptr) {                                  \
             throw process->get_heap().allocate<Exception>(      \
                 process, "");                                   \
@@ -53,26 +55,54 @@
 #define CONVERT_ARG_TO(i, Type, name) CONVERT_VAL_TO(frame->get_arg(i), Type, name)
 #define CONVERT_RECV_TO(Type, name) CONVERT_VAL_TO(frame->get_receiver(), Type, name)
 
-#define TRY_CONVERT_VAL_TO(val, Type, name) Type* name = dynamic_cast<Type*>(val)
+#define TRY_CONVERT_VAL_TO(val, Type, name) Type* name = (val).get_object_as<Type>()
 #define TRY_CONVERT_ARG_TO(i, Type, name) TRY_CONVERT_VAL_TO(frame->get_arg(i), Type, name)
 #define TRY_CONVERT_RECV_TO(Type, name) TRY_CONVERT_VAL_TO(frame->get_receiver(), Type, name)
 
-#define TRY_CONVERT_OPTIONAL_ARG_TO(i, Type, name)          \
-    Type* name;                                             \
-    do {                                                    \
-        if (i < frame->num_args()) {                        \
-            name = dynamic_cast<Type*>(frame->get_arg(i));  \
-        } else {                                            \
-            name = nullptr;                                 \
-        }                                                   \
+#define TRY_CONVERT_OPTIONAL_ARG_TO(i, Type, name)              \
+    Type* name;                                                 \
+    do {                                                        \
+        if (i < frame->num_args()) {                            \
+            name = frame->get_arg(i).get_object_as<Type>();     \
+        } else {                                                \
+            name = nullptr;                                     \
+        }                                                       \
+    } while (false)
+
+// Numbers and booleans are usually immediates, but clones of their
+// prototypes are heap objects, so both forms are accepted.
+#define CONVERT_VAL_TO_PRIMITIVE(val, Kind, ctype, name)                \
+    ctype name;                                                         \
+    do {                                                                \
+        std::optional<ctype> opt = objectutils::try_get_##Kind(val);    \
+        if (!opt) {                                                     \
+            throw process->get_heap().allocate<Exception>(              \
+                process, "");                                           \
+        }                                                               \
+        name = *opt;                                                    \
+    } while (false)
+
+#define CONVERT_ARG_TO_NUMBER(i, name) CONVERT_VAL_TO_PRIMITIVE(frame->get_arg(i), number, double, name)
+#define CONVERT_RECV_TO_NUMBER(name) CONVERT_VAL_TO_PRIMITIVE(frame->get_receiver(), number, double, name)
+#define CONVERT_ARG_TO_BOOLEAN(i, name) CONVERT_VAL_TO_PRIMITIVE(frame->get_arg(i), boolean, bool, name)
+#define CONVERT_RECV_TO_BOOLEAN(name) CONVERT_VAL_TO_PRIMITIVE(frame->get_receiver(), boolean, bool, name)
+
+#define TRY_CONVERT_ARG_TO_NUMBER(i, name) std::optional<double> name = objectutils::try_get_number(frame->get_arg(i))
+#define TRY_CONVERT_ARG_TO_BOOLEAN(i, name) std::optional<bool> name = objectutils::try_get_boolean(frame->get_arg(i))
+
+#define TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(i, name)                     \
+    std::optional<double> name;                                         \
+    do {                                                                \
+        if (i < frame->num_args()) {                                    \
+            name = objectutils::try_get_number(frame->get_arg(i));      \
+        }                                                               \
     } while (false)
 
-#define NONE NONE_IN_CTX(process)
-#define NONE_IN_CTX(ctx) (process)->get_native_objects().get_null()
-#define BOOLEAN(val) BOOLEAN_IN_CTX(val, process)
-#define BOOLEAN_IN_CTX(val, ctx) (ctx)->get_native_objects().get_boolean(val)
-#define FALSE process->get_native_objects().get_boolean(false)
-#define TRUE process->get_native_objects().get_boolean(true)
+#define NONE Value::null()
+#define BOOLEAN(val) Value::boolean(val)
+#define FALSE Value::boolean(false)
+#define TRUE Value::boolean(true)
+#define NUMBER(num) Value::number(num)
 
 #define ARRAY_PROTOTYPE process->get_native_objects().get_array_prototype()
 #define ARRAY_ITERATOR_PROTOTYPE process->get_native_objects().get_array_iterator_prototype()
@@ -90,9 +120,6 @@
 #define ALLOC_NATIVE_FUNCTION(function) process->get_heap().allocate<NativeFunction>(process, function, module)
 #define ALLOC_NATIVE_FUNCTION_NO_MOD(function) process->get_heap().allocate<NativeFunction>(process, function)
 
-#define ALLOC_NUMBER(num) ALLOC_NUMBER_IN_CTX(num, process)
-#define ALLOC_NUMBER_IN_CTX(num, ctx) (ctx)->get_heap().allocate<Number>(ctx, num)
-
 #define ALLOC_MODULE(name) process->get_heap().allocate<Module>(process, name)
 
 #define ALLOC_OBJECT() ALLOC_OBJECT_IN_CTX(process)
@@ -101,19 +128,36 @@
 #define ALLOC_PROP_ACC_DESC(getter, setter) ALLOC_PROP_ACC_DESC_IN_CTX(getter, setter, process)
 #define ALLOC_PROP_ACC_DESC_IN_CTX(getter, setter, ctx) (ctx)->get_heap().allocate<PropertyDescriptor>(ctx, getter, setter)
 
-#define ALLOC_PROP_DATA_DESC(val) ALLOC_PROP_DATA_DESC_IN_CTX(val, process)
-#define ALLOC_PROP_DATA_DESC_IN_CTX(val, ctx) (ctx)->get_heap().allocate<PropertyDescriptor>(ctx, val)
-
 #define ALLOC_STRING(str) ALLOC_STRING_IN_CTX(str, process)
 #define ALLOC_STRING_IN_CTX(str, ctx) (ctx)->get_heap().allocate<String>(ctx, str)
 
 namespace emerald {
 namespace objectutils {
 
+    inline std::optional<double> try_get_number(Value val) {
+        if (val.is_number()) {
+            return val.get_number();
+        } else if (Number* num = val.get_object_as<Number>()) {
+            return num->get_native_value();
+        }
+
+        return std::nullopt;
+    }
+
+    inline std::optional<bool> try_get_boolean(Value val) {
+        if (val.is_boolean()) {
+            return val.get_boolean();
+        } else if (Boolean* boolean = val.get_object_as<Boolean>()) {
+            return boolean->get_native_value();
+        }
+
+        return std::nullopt;
+    }
+
     template <class InputIt1, class InputIt2>
     inline bool compare_range(InputIt1 first1, InputIt1 last1, InputIt2 first2, Process* process) {
-        return std::equal(first1, last1, first2, [&process](Object* lhs, Object* rhs) {
-            return Interpreter::execute_method<Boolean>(lhs, magic_methods::eq, { rhs }, process)->get_native_value();
+        return std::equal(first1, last1, first2, [&process](Value lhs, Value rhs) {
+            return Interpreter::execute_method<bool>(lhs, magic_methods::eq, { rhs }, process);
         });
     }
 
@@ -123,9 +167,9 @@ namespace objectutils {
             begin,
             end,
             seperator,
-            [&process](Object* obj) {
-                return Interpreter::execute_method<String>(
-                    obj,
+            [&process](Value val) {
+                return Interpreter::execute_method<String*>(
+                    val,
                     magic_methods::str,
                     {},
                     process)->get_native_value();
@@ -134,28 +178,28 @@ namespace objectutils {
 
     class ObjectIterator {
     public:
-        ObjectIterator(Process* process, Object* iterator)
+        ObjectIterator(Process* process, Value iterator)
             : _process(process),
             _iterator(iterator) {}
 
-        Object* cur() const {
-            return Interpreter::execute_method<Object>(
+        Value cur() const {
+            return Interpreter::execute_method<Value>(
                 _iterator,
                 magic_methods::cur,
                 {},
                 _process);
         }
 
-        Boolean* done() {
-            return Interpreter::execute_method<Boolean>(
+        bool done() {
+            return Interpreter::execute_method<bool>(
                 _iterator,
                 magic_methods::done,
                 {},
                 _process);
         }
 
-        Object* next() {
-            return Interpreter::execute_method<Object>(
+        Value next() {
+            return Interpreter::execute_method<Value>(
                 _iterator,
                 magic_methods::next,
                 {},
@@ -164,7 +208,7 @@ namespace objectutils {
 
     private:
         Process* _process;
-        Object* _iterator;
+        Value _iterator;
     };
 
 } // namespace objectutils
@@ -101,7 +101,31 @@ namespace emerald {
     X(ldlocs, 0)                \
     X(ldgbls, 0)                \
     /* Other */                 \
-    X(import, 1)
+    X(import, 1)                \
+    /* Superinstructions */     \
+    X(get_prop_str, 2)          \
+    X(set_prop_str, 2)          \
+    X(call_method, 2)           \
+    X(ldloc_get_prop, 2)        \
+    X(inc_local, 2)             \
+    /* Registers */             \
+    X(mov, 2)                   \
+    X(radd, 3)                  \
+    X(rsub, 3)                  \
+    X(rmul, 3)                  \
+    X(rdiv, 3)                  \
+    X(rmod, 3)                  \
+    X(req, 3)                   \
+    X(rneq, 3)                  \
+    X(rlt, 3)                   \
+    X(rgt, 3)                   \
+    X(rlte, 3)                  \
+    X(rgte, 3)                  \
+    X(rbit_or, 3)               \
+    X(rbit_xor, 3)              \
+    X(rbit_and, 3)              \
+    X(rbit_shl, 3)              \
+    X(rbit_shr, 3)
 
     class OpCode {
     public:
@@ -115,6 +139,10 @@ namespace emerald {
         static const std::string get_string(Value op);
         static uint8_t get_arg_count(Value op);
 
+        // Whether the operands of op are register operands, see
+        // Code::Operand.
+        static bool is_register_op(Value op);
+
     private:
         static const std::string _strings[NUM_OPCODES];
         static const uint8_t _arg_counts[NUM_OPCODES];
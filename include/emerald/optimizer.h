@@ -0,0 +1,66 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_OPTIMIZER_H
+#define _EMERALD_OPTIMIZER_H
+
+#include <vector>
+
+#include "emerald/code.h"
+
+namespace emerald {
+
+    // Rewrites compiled code in place: threads jumps, drops unreachable
+    // code, nops, dead stores and values that are pushed only to be popped,
+    // and fuses common sequences into superinstructions. Constant
+    // arithmetic is not folded since the number operators can be
+    // redefined at runtime.
+    class Optimizer {
+    public:
+        static void optimize(Code& code);
+
+    private:
+        Optimizer(Code& code);
+
+        Code& _code;
+        std::vector<Code::Instruction>& _instructions;
+        std::vector<bool> _jump_targets;
+        std::vector<bool> _read_locals;
+        bool _has_ldlocs;
+
+        void run();
+
+        bool remove_unreachable();
+        bool thread_jumps();
+        bool remove_dead_stores();
+        bool remove_dead_pushes();
+        bool fuse_prop_keys();
+        bool fuse_superinstructions();
+
+        void analyze();
+        void compact();
+        void remove(size_t i);
+        bool find_producer(size_t i, size_t depth, size_t& producer) const;
+
+        static bool is_jump(OpCode::Value op);
+        static bool is_pure_push(OpCode::Value op);
+        static bool get_stack_effect(const Code::Instruction& instr, size_t& pops, size_t& pushes);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_OPTIMIZER_H
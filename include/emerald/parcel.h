@@ -0,0 +1,99 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_PARCEL_H
+#define _EMERALD_PARCEL_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "emerald/no_copy.h"
+#include "emerald/value.h"
+
+namespace emerald {
+
+    class Object;
+    class Parcel;
+    class Process;
+
+    using ParcelRef = std::shared_ptr<const Parcel>;
+
+    // A copy of values made by one process for another, which lives in
+    // neither of their heaps. The sender packs the values on its own
+    // thread and the receiver unpacks them into its heap on its thread, so
+    // no process allocates in or reads from another's heap. Strings,
+    // arrays, objects, exceptions, functions and the modules they refer to
+    // can be packed, along with the prototypes they inherit from, as can
+    // objects of any type that packs itself through Object::pack. The
+    // builtin prototypes are replaced by the receiver's own rather than
+    // copied, and frozen values are unpacked as new wrappers around the
+    // same frozen value.
+    class Parcel {
+    public:
+        // What an object of a native type packs itself into. Make is called
+        // in the receiver with the object's parent once it exists, and fill
+        // once every object in the parcel has been made and given its
+        // properties, with the values the object referred to when packed.
+        class Native {
+        public:
+            using Make = std::function<Object*(Process* process, Object* parent)>;
+            using Fill = std::function<void(Object* obj, const std::vector<Value>& values)>;
+
+            Native(Make make, Fill fill = nullptr);
+
+            Object* make(Process* process, Object* parent) const;
+            void fill(Object* obj, const std::vector<Value>& values) const;
+
+        private:
+            Make _make;
+            Fill _fill;
+        };
+
+        ~Parcel();
+
+        NO_COPY(Parcel);
+
+        static ParcelRef pack(Value value, Process* process);
+        static ParcelRef pack(const std::vector<Value>& values, Process* process);
+
+        // Returns the first of the values packed.
+        Value unpack(Process* process) const;
+        std::vector<Value> unpack_all(Process* process) const;
+
+    private:
+        class Packer;
+        class Unpacker;
+        struct Node;
+
+        static const size_t NO_NODE = static_cast<size_t>(-1);
+
+        // An immediate, or the node of an object.
+        struct Ref {
+            Value immediate;
+            size_t node;
+        };
+
+        std::vector<Node> _nodes;
+        std::vector<Ref> _values;
+
+        Parcel();
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_PARCEL_H
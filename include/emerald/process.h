@@ -19,15 +19,20 @@
 #define _EMERALD_PROCESS_H
 
 #include <atomic>
+#include <exception>
+#include <functional>
 #include <mutex>
-#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "emerald/heap.h"
 #include "emerald/mailbox.h"
 #include "emerald/module_registry.h"
 #include "emerald/native_objects.h"
 #include "emerald/native_stack.h"
+#include "emerald/profiler.h"
+#include "emerald/scheduler.h"
+#include "emerald/shape.h"
 #include "emerald/stack.h"
 
 namespace emerald {
@@ -41,6 +46,7 @@ namespace emerald {
         enum class State {
             PENDING,
             RUNNING,
+            WAITING,
             COMPLETED
         };
 
@@ -60,32 +66,65 @@ namespace emerald {
         const NativeObjects& get_native_objects() const { return _native_objects; }
         NativeObjects& get_native_objects() { return _native_objects; }
 
+        const ShapeTree& get_shape_tree() const { return _shape_tree; }
+        ShapeTree& get_shape_tree() { return _shape_tree; }
+
         const NativeStack& get_native_stack() const { return _native_stack; }
         NativeStack& get_native_stack() { return _native_stack; }
 
         const Stack& get_stack() const { return _stack; }
         Stack& get_stack() { return _stack; }
 
+        const Profiler& get_profiler() const { return _profiler; }
+        Profiler& get_profiler() { return _profiler; }
+
         State get_state() const { return _state.load(); }
         void set_state(State state) { _state.store(state); }
 
+        const Scheduler::Task& get_task() const { return _task; }
+        Scheduler::Task& get_task() { return _task; }
+
+        // An exception thrown while the process ran native code, held until
+        // the code has returned to Jit::execute, which rethrows it.
+        std::exception_ptr& get_jit_exception() { return _jit_exception; }
+
+        // Looks up another process for this one to send to. Processes are
+        // never removed, so those found are cached, and later lookups don't
+        // contend on the ProcessManager's lock.
+        Process* get_peer(PID id);
+
+        // Called by the interpreter when a frame is entered and on jumps,
+        // the process gives up its worker once its time slice is used up.
+        void count_reduction() {
+            if (--_task.reductions == 0) {
+                Scheduler::preempt(this);
+            }
+        }
+
     private:
         friend class ProcessManager;
 
         PID _id;
         std::atomic<State> _state;
 
+        ShapeTree _shape_tree;
         Heap _heap;
         Mailbox _mailbox;
         ModuleRegistry _module_registry;
         NativeObjects _native_objects;
         NativeStack _native_stack;
         Stack _stack;
+        Profiler _profiler;
+        Scheduler::Task _task;
+        std::exception_ptr _jit_exception;
+
+        std::unordered_map<PID, Process*> _peers;
     };
 
     class ProcessManager {
     public:
         static Process* create();
+        static std::vector<Process*> create(size_t count);
         static void execute(Process::PID id, std::function<void(Process*)> f);
         static Process* get(Process::PID id);
         static void join(Process::PID id);
@@ -93,7 +132,6 @@ namespace emerald {
     private:
         static Process::PID _curr_id;
         static std::unordered_map<Process::PID, Process> _map;
-        static std::unordered_map<Process::PID, std::thread> _threads;
         static std::mutex _mutex;
     };
 
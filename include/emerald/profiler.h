@@ -0,0 +1,91 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_PROFILER_H
+#define _EMERALD_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    class Stack;
+
+    // A sampling CPU profiler for a single process. A timer thread raises
+    // a flag at every interval, and the interpreter takes the sample the
+    // next time it enters a function or jumps, where the stack is
+    // consistent. While stopped, the cost is checking the flag.
+    class Profiler {
+    public:
+        static constexpr std::chrono::microseconds DEFAULT_INTERVAL{ 1000 };
+
+        Profiler();
+        ~Profiler();
+
+        NO_COPY(Profiler);
+
+        void start(std::chrono::microseconds interval = DEFAULT_INTERVAL);
+        void stop();
+
+        bool is_running() const;
+
+        bool sample_requested() const {
+            return _sample_requested.load(std::memory_order_relaxed);
+        }
+
+        // The flag raised by the timer, which native code reads directly.
+        const std::atomic<bool>& get_sample_flag() const {
+            return _sample_requested;
+        }
+
+        // Records the label and current instruction of every frame on the
+        // stack, outermost first.
+        void take_sample(const Stack& stack);
+
+        size_t num_samples() const;
+
+        // The samples in the folded stack format read by flamegraph tools,
+        // one `frame;frame;frame count` line per distinct stack.
+        std::string get_folded_stacks() const;
+        bool write_folded_stacks(const std::filesystem::path& path) const;
+
+    private:
+        std::atomic<bool> _sample_requested;
+
+        bool _running;
+        std::thread _timer;
+        mutable std::mutex _timer_mutex;
+        std::condition_variable _timer_cv;
+
+        size_t _num_samples;
+        std::map<std::string, size_t> _samples;
+        mutable std::mutex _samples_mutex;
+
+        void run_timer(std::chrono::microseconds interval);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_PROFILER_H
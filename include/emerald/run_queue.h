@@ -0,0 +1,77 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_RUN_QUEUE_H
+#define _EMERALD_RUN_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    class Process;
+
+    // A lock-free work-stealing deque of runnable processes, after Chase
+    // and Lev. Only the worker owning the queue may push to it, while any
+    // thread may take from it. Processes are taken oldest first, so a
+    // preempted process goes behind the others. The buffer grows as
+    // needed, and buffers that are outgrown are kept until the queue is
+    // destroyed since a thief may still be reading them.
+    class RunQueue {
+    public:
+        static constexpr size_t INITIAL_CAPACITY = 256;
+
+        RunQueue();
+
+        NO_COPY(RunQueue);
+
+        // Owner only.
+        void push(Process* process);
+
+        // Returns nullptr if the queue is empty.
+        Process* take();
+
+        size_t size() const;
+
+    private:
+        struct Buffer {
+            Buffer(size_t capacity);
+
+            size_t capacity;
+            std::unique_ptr<std::atomic<Process*>[]> slots;
+
+            Process* get(int64_t i) const;
+            void put(int64_t i, Process* process);
+        };
+
+        std::atomic<int64_t> _top;
+        std::atomic<int64_t> _bottom;
+        std::atomic<Buffer*> _buffer;
+        std::vector<std::unique_ptr<Buffer>> _buffers;
+
+        Buffer* grow(Buffer* buffer, int64_t top, int64_t bottom);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_RUN_QUEUE_H
@@ -0,0 +1,187 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_SCHEDULER_H
+#define _EMERALD_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "emerald/fiber.h"
+#include "emerald/no_copy.h"
+#include "emerald/run_queue.h"
+
+namespace emerald {
+
+    class Process;
+
+    struct WorkerStats {
+        size_t queue_depth = 0;
+        size_t runs = 0;
+        size_t steals = 0;
+    };
+
+    struct SchedulerStats {
+        std::vector<WorkerStats> workers;
+        size_t injected_depth = 0;
+        size_t runnable = 0;
+    };
+
+    // Runs processes as fibers on a fixed pool of worker threads, one per
+    // core by default. A process keeps its worker until it has used up its
+    // reductions, which the interpreter counts on calls and jumps, or until
+    // it parks waiting for a message, a timer or another process. Parked
+    // processes hold no worker.
+    //
+    // Each worker has its own run queue. Processes made runnable on a
+    // worker, such as a receiver woken by a send, go on that worker's
+    // queue, and those made runnable elsewhere go on a shared injection
+    // queue. A worker with nothing to run steals from the others before
+    // going to sleep.
+    class Scheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static const uint32_t REDUCTIONS = 4000;
+
+        // The scheduling state of a process, kept in the process.
+        struct Task {
+            enum class Yield {
+                PREEMPTED,
+                PARKED
+            };
+
+            std::function<void(Process*)> entry;
+            std::unique_ptr<Fiber> fiber;
+            uint32_t reductions = REDUCTIONS;
+            Yield yield = Yield::PREEMPTED;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool spawned = false;
+            bool parked = false;
+            bool woken = false;
+            bool finished = false;
+            std::vector<Process*> joiners;
+
+            // Written by the worker running the process.
+            std::atomic<int64_t> run_time{0};
+            std::atomic<size_t> runs{0};
+            std::atomic<size_t> migrations{0};
+            size_t last_worker = SIZE_MAX;
+        };
+
+        // Takes effect when the first process is spawned.
+        static void set_num_workers(size_t num_workers);
+        static size_t get_num_workers();
+
+        static void spawn(Process* process, std::function<void(Process*)> entry);
+
+        // The process running on the calling thread, if any.
+        static Process* get_current();
+
+        // Gives the worker to another runnable process, if there is one,
+        // and starts a new time slice.
+        static void preempt(Process* process);
+
+        // Suspends the calling process until it's woken. Wakeups are never
+        // lost, but may be spurious, so callers park in a loop until what
+        // they wait for has happened.
+        static void park(Process* process);
+        static void wake(Process* process);
+
+        // Parks the calling process until it's woken or the deadline has
+        // passed, whichever comes first.
+        static void park_until(Process* process, Clock::time_point deadline);
+
+        static void sleep(Process* process, std::chrono::duration<double> duration);
+
+        // Waits until the process has finished, parking the calling
+        // process or blocking the calling thread.
+        static void join(Process* process);
+
+        static SchedulerStats get_stats();
+
+        // Time the process has spent running on a worker.
+        static std::chrono::nanoseconds get_run_time(const Process* process);
+
+    private:
+        struct Worker {
+            size_t index;
+            uint32_t seed;
+            RunQueue queue;
+            std::atomic<size_t> runs{0};
+            std::atomic<size_t> steals{0};
+            std::thread thread;
+        };
+
+        Scheduler();
+        ~Scheduler();
+
+        NO_COPY(Scheduler);
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::thread _timer;
+        std::atomic<bool> _stopping;
+
+        std::deque<Process*> _injected;
+        std::mutex _injected_mutex;
+
+        // Counts processes sitting in any run queue. Workers sleep once
+        // there are none, and are woken when one is pushed.
+        std::atomic<size_t> _num_runnable;
+        std::atomic<size_t> _num_idle;
+        std::mutex _idle_mutex;
+        std::condition_variable _idle_cv;
+
+        std::multimap<Clock::time_point, Process*> _timers;
+        std::mutex _timer_mutex;
+        std::condition_variable _timer_cv;
+
+        static std::atomic<size_t> _num_workers;
+
+        // The worker running on the calling thread, if any.
+        static thread_local Worker* _current_worker;
+
+        static Scheduler& get();
+
+        void push_runnable(Process* process);
+        Process* pop_runnable(Worker& worker);
+        Process* take_injected();
+        Process* steal(Worker& worker);
+
+        void run_worker(Worker& worker);
+        void add_timer(Process* process, Clock::time_point deadline);
+        void cancel_timer(Process* process, Clock::time_point deadline);
+        void run_timer();
+        void run(Worker& worker, Process* process);
+        void finish(Process* process);
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_SCHEDULER_H
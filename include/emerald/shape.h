@@ -0,0 +1,100 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_SHAPE_H
+#define _EMERALD_SHAPE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "emerald/atom.h"
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    // A shape describes the names of an object's own properties, the
+    // slot each one is stored in and whether the slot holds a value or an
+    // accessor. Objects that gain the same properties in the same order
+    // share a shape through the transition tree rooted at their process's
+    // ShapeTree. Objects with many properties, or whose properties change
+    // kind, switch to a private dictionary shape which is never shared.
+    class Shape {
+    public:
+        static const size_t MAX_TREE_SLOTS = 64;
+
+        struct Property {
+            size_t slot;
+            bool accessor;
+        };
+
+        Shape();
+
+        NO_COPY(Shape);
+
+        Shape* get_parent() const;
+
+        bool is_dictionary() const;
+        size_t get_num_slots() const;
+
+        bool lookup(Atom key, Property& property) const;
+        std::vector<Atom> get_keys() const;
+
+        Shape* get_transition(Atom key, bool accessor);
+        void add_dictionary_key(Atom key, bool accessor);
+        void set_dictionary_accessor(Atom key, bool accessor);
+
+        std::unique_ptr<Shape> to_dictionary() const;
+
+    private:
+        Shape(Shape* parent, Atom key, bool accessor);
+
+        Shape* _parent;
+        Atom _key;
+        bool _accessor;
+        size_t _num_slots;
+        bool _dictionary;
+
+        mutable std::unique_ptr<std::unordered_map<Atom, Property>> _table;
+        std::unordered_map<Atom, std::unique_ptr<Shape>> _transitions;
+        std::unordered_map<Atom, std::unique_ptr<Shape>> _accessor_transitions;
+
+        void build_table() const;
+    };
+
+    class ShapeTree {
+    public:
+        ShapeTree();
+
+        NO_COPY(ShapeTree);
+
+        Shape* get_root();
+
+        size_t get_prototype_epoch() const;
+        void invalidate_prototypes();
+
+    private:
+        Shape _root;
+
+        // Bumped whenever an object used as a prototype changes its own
+        // properties, which invalidates cached prototype lookups.
+        size_t _prototype_epoch;
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_SHAPE_H
@@ -21,12 +21,15 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
-#include <stack>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "emerald/code.h"
 #include "emerald/heap_managed.h"
 #include "emerald/heap_root_source.h"
+#include "emerald/inline_cache.h"
+#include "emerald/value.h"
 
 namespace emerald {
 
@@ -36,51 +39,73 @@ namespace emerald {
     class Stack : public HeapRootSource {
     public:
         static const uint16_t DEFAULT_MAX_SIZE = 8192;
+        static const size_t INITIAL_VALUES_CAPACITY = 1024;
 
         Stack(uint16_t max_size = DEFAULT_MAX_SIZE);
 
+        using InlineCaches = std::vector<std::unique_ptr<InlineCache>>;
+
         class Frame {
         public:
-            Frame(Object* receiver, std::shared_ptr<const Code> code, Module* globals, Object* locals);
-
-            Object* get_receiver() const;
+            Frame(
+                Stack* stack,
+                Value receiver,
+                std::shared_ptr<const Code> code,
+                Module* globals,
+                InlineCaches* inline_caches,
+                size_t locals_base,
+                size_t catch_base);
+
+            Value get_receiver() const;
             std::shared_ptr<const Code> get_code() const;
 
-            size_t get_instruction_pointer() const;
+            // The label of the frame's code, or the name of the module for
+            // module level code.
+            std::string get_label() const;
 
-            void increment_instruction_pointer();
+            // Where execution resumes when the interpreter enters the
+            // frame, the interpreter tracks it locally while running.
+            size_t get_instruction_pointer() const;
             void set_instruction_pointer(size_t ip);
 
-            bool has_instructions_left() const;
+            // The instruction being executed, published by the interpreter
+            // on every dispatch so profilers can tell where the frame is.
+            size_t get_current_instruction() const;
+            void set_current_instruction(const Code::PackedInstruction* instr) {
+                _current_instruction = instr;
+            }
 
-            const Code::Instruction& get_next_instruction() const;
+            InlineCache& get_inline_cache(size_t ip);
 
             const Module* get_globals() const;
             Module* get_globals();
 
-            const Object* get_global(const std::string& name) const;
-            Object* get_global(const std::string& name);
+            Value get_global(Atom name) const;
 
-            void set_global(const std::string& name, Object* val);
+            void set_global(Atom name, Value val);
 
             const Object* get_locals() const;
             Object* get_locals();
 
-            const Object* get_local(const std::string& name) const;
-            Object* get_local(const std::string& name);
+            void materialize_locals(Object* locals);
 
-            void set_local(const std::string& name, Object* val);
+            Value get_local(size_t id) const;
+
+            void set_local(size_t id, Value val);
 
             size_t num_locals() const;
 
-            const std::deque<Object*> get_data_stack() const;
+            size_t num_ds() const;
 
-            const Object* peek_ds() const;
-            Object* peek_ds();
+            Value peek_ds() const;
+            Value peek_ds(size_t depth) const;
 
-            Object* pop_ds();
-            std::vector<Object*> pop_n_ds(size_t n);
-            void push_ds(Object* val);
+            Value pop_ds();
+            std::vector<Value> pop_n_ds(size_t n);
+            void drop_n_ds(size_t n);
+            void push_ds(Value val) {
+                _stack->_values.push_back(val);
+            }
 
             void push_catch_ip(size_t ip);
             void pop_catch_ip();
@@ -88,15 +113,30 @@ namespace emerald {
             size_t get_catch_ip();
 
         private:
-            Object* _receiver;
+            friend class Jit;
+            friend class Stack;
+
+            Stack* _stack;
+            Value _receiver;
 
             std::shared_ptr<const Code> _code;
             size_t _ip;
+            const Code::PackedInstruction* _current_instruction;
+            InlineCaches* _inline_caches;
 
             Module* _globals;
+
+            // Locals live in slots indexed by their id in the code object,
+            // until ldlocs asks for them as an object. From then on the
+            // object is the single source of truth for the frame's locals.
             Object* _locals;
-            std::deque<Object*> _data_stack;
-            std::stack<size_t> _catch_stack;
+
+            // The frame's windows into the stack's values and catch ips:
+            // its local slots, followed by its data stack, which runs to
+            // the top of the values.
+            size_t _locals_base;
+            size_t _ds_base;
+            size_t _catch_base;
         };
 
         uint16_t max_size() const;
@@ -107,8 +147,15 @@ namespace emerald {
         const Frame& peek() const;
         Frame& peek();
 
+        const std::deque<Frame>& get_frames() const;
+
+        const std::vector<Value>& get_values() const;
+
         bool pop_frame();
-        void push_frame(Object* receiver, std::shared_ptr<const Code> code, Module* globals, Object* locals);
+
+        // The top num_args values of the current frame's data stack are
+        // moved into the new frame, where they start its data stack.
+        void push_frame(Value receiver, std::shared_ptr<const Code> code, Module* globals, size_t num_args = 0);
 
         const Module* peek_globals() const;
         Module* peek_globals();
@@ -116,9 +163,17 @@ namespace emerald {
         std::vector<HeapManaged*> get_roots() override;
 
     private:
+        friend class Jit;
+
         uint16_t _max_size;
 
         std::deque<Frame> _stack;
+        std::unordered_map<std::shared_ptr<const Code>, InlineCaches> _inline_caches;
+
+        // The local slots and data stacks of every frame, each frame's
+        // above its caller's.
+        std::vector<Value> _values;
+        std::vector<size_t> _catch_ips;
     };
 
 } // namespace emerald
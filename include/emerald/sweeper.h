@@ -0,0 +1,58 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _EMERALD_SWEEPER_H
+#define _EMERALD_SWEEPER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "emerald/no_copy.h"
+
+namespace emerald {
+
+    // A background thread shared by every heap, used to free dead objects
+    // so the process that owns the heap can keep running.
+    class Sweeper {
+    public:
+        static std::future<void> submit(std::function<void()> task);
+
+    private:
+        Sweeper();
+        ~Sweeper();
+
+        NO_COPY(Sweeper);
+
+        std::deque<std::packaged_task<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _stopping;
+        std::thread _thread;
+
+        static Sweeper& get();
+
+        void run();
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_SWEEPER_H
@@ -0,0 +1,169 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _EMERALD_VALUE_H
+#define _EMERALD_VALUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "emerald/atom.h"
+
+namespace emerald {
+
+    class CloneCache;
+    class MarkStack;
+    class Object;
+    class Process;
+
+    template <class T>
+    T* object_cast(Object* obj);
+
+    // A Value is a NaN-boxed 64 bit word. Doubles are stored as is,
+    // everything else lives in the payload of a quiet NaN:
+    //
+    //  - null, false and true are tagged immediates
+    //  - objects set the sign bit and carry a 48 bit pointer
+    //  - the empty value marks an absent result (e.g. a missing property)
+    class Value {
+    public:
+        Value()
+            : _bits(EMPTY_BITS) {}
+
+        Value(Object* obj)
+            : _bits(obj ? (OBJECT_BITS | reinterpret_cast<uintptr_t>(obj)) : EMPTY_BITS) {}
+
+        static Value number(double num) {
+            Value val;
+            if (num != num) {
+                val._bits = CANONICAL_NAN_BITS;
+            } else {
+                std::memcpy(&val._bits, &num, sizeof(double));
+            }
+            return val;
+        }
+
+        static Value boolean(bool b) {
+            return from_bits(b ? TRUE_BITS : FALSE_BITS);
+        }
+
+        static Value null() {
+            return from_bits(NULL_BITS);
+        }
+
+        static Value from_bits(uint64_t bits) {
+            Value val;
+            val._bits = bits;
+            return val;
+        }
+
+        uint64_t get_bits() const {
+            return _bits;
+        }
+
+        bool is_empty() const {
+            return _bits == EMPTY_BITS;
+        }
+
+        bool is_number() const {
+            return (_bits & QNAN) != QNAN;
+        }
+
+        bool is_boolean() const {
+            return (_bits | 1) == TRUE_BITS;
+        }
+
+        bool is_null() const {
+            return _bits == NULL_BITS;
+        }
+
+        bool is_object() const {
+            return (_bits & OBJECT_BITS) == OBJECT_BITS;
+        }
+
+        bool is_immediate() const {
+            return !is_object() && !is_empty();
+        }
+
+        double get_number() const {
+            double num;
+            std::memcpy(&num, &_bits, sizeof(double));
+            return num;
+        }
+
+        bool get_boolean() const {
+            return _bits == TRUE_BITS;
+        }
+
+        Object* get_object() const {
+            return is_object()
+                ? reinterpret_cast<Object*>(static_cast<uintptr_t>(_bits & ~OBJECT_BITS))
+                : nullptr;
+        }
+
+        template <class T>
+        T* get_object_as() const {
+            return object_cast<T>(get_object());
+        }
+
+        bool as_bool() const;
+        std::string as_str() const;
+
+        // The property key named by this value, strings reuse their atom.
+        Atom as_atom() const;
+
+        // Returns the heap object standing in for this value, boxing numbers.
+        // Booleans and null map onto their per process singletons.
+        Object* to_object(Process* process) const;
+
+        Value clone(Process* process, CloneCache& cache) const;
+
+        void mark(MarkStack& stack) const;
+
+        explicit operator bool() const {
+            return !is_empty();
+        }
+
+        bool operator==(const Value& other) const {
+            return _bits == other._bits;
+        }
+
+        bool operator!=(const Value& other) const {
+            return _bits != other._bits;
+        }
+
+        // The tagging, for code that works on the bits directly.
+        static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+        static constexpr uint64_t QNAN = 0x7ffc000000000000;
+
+        static constexpr uint64_t CANONICAL_NAN_BITS = 0x7ff8000000000000;
+
+        static constexpr uint64_t EMPTY_BITS = QNAN | 0;
+        static constexpr uint64_t NULL_BITS = QNAN | 1;
+        static constexpr uint64_t FALSE_BITS = QNAN | 2;
+        static constexpr uint64_t TRUE_BITS = QNAN | 3;
+
+        static constexpr uint64_t OBJECT_BITS = SIGN_BIT | QNAN;
+
+    private:
+        uint64_t _bits;
+    };
+
+} // namespace emerald
+
+#endif // _EMERALD_VALUE_H
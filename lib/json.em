@@ -53,7 +53,9 @@ object Tokenizer
             else if self.c == '"' then
                 self._advance()
                 while self.c != '"' do self._advance() end
-                return self._emit(TokenType.STRING_LITERAL)
+                let lexeme = self.json.substr(self.si + 1, self.i - self.si - 1)
+                self._advance()
+                return self._emit(TokenType.STRING_LITERAL, lexeme)
             else if self.c.isalpha() then
                 while self.c.isalpha() do self._advance() end
 
@@ -69,6 +71,7 @@ object Tokenizer
                 end
             else if self._is_ws(self.c) then
                 while self._is_ws(self.c) do self._advance() end
+                self.si = self.i
             else
                 return self._emit(TokenType.ILLEGAL)
             end
@@ -149,6 +152,8 @@ object Parser
                 self._expect(TokenType.RBRACE)
             end
             return obj
+        else if token.type == TokenType.STRING_LITERAL then
+            return token.lexeme
         else if token.type == TokenType.TRUE_LITERAL then
             return True
         else if token.type == TokenType.FALSE_LITERAL then
@@ -0,0 +1,68 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <mutex>
+#include <unordered_map>
+
+#include "emerald/atom.h"
+
+namespace emerald {
+
+    Atom::Atom(const char* str)
+        : Atom(std::string(str)) {}
+
+    Atom::Atom(const std::string& str) {
+        Entry* entry = new Entry{ str, std::hash<std::string>()(str), { 1 } };
+        _bits = reinterpret_cast<uintptr_t>(entry) | COMPUTED;
+    }
+
+    Atom Atom::intern(const std::string& str) {
+        // Atoms are interned during static initialization for the magic
+        // methods and may outlive other statics, so the table is created on
+        // first use and never destroyed.
+        static std::mutex* mutex = new std::mutex();
+        static std::unordered_map<std::string, Entry*>* table = new std::unordered_map<std::string, Entry*>();
+
+        std::lock_guard<std::mutex> lock(*mutex);
+        Entry*& entry = (*table)[str];
+        if (!entry) {
+            entry = new Entry{ str, std::hash<std::string>()(str), { 0 } };
+        }
+
+        Atom atom;
+        atom._bits = reinterpret_cast<uintptr_t>(entry);
+        return atom;
+    }
+
+    void Atom::release_computed() {
+        Entry* entry = get_entry();
+        if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete entry;
+        }
+    }
+
+    bool Atom::equals(const Atom& other) const {
+        if (!_bits || !other._bits) {
+            return false;
+        }
+
+        const Entry* entry = get_entry();
+        const Entry* other_entry = other.get_entry();
+        return entry->hash == other_entry->hash && entry->str == other_entry->str;
+    }
+
+} // namespace emerald
@@ -27,6 +27,7 @@
 
 #include "emerald/check.h"
 #include "emerald/code.h"
+#include "emerald/jit.h"
 
 #define SPACES 4
 
@@ -35,6 +36,16 @@
 
 namespace emerald {
 
+    static std::vector<Atom> intern_all(const std::vector<std::string>& names) {
+        std::vector<Atom> atoms;
+        atoms.reserve(names.size());
+        for (const std::string& name : names) {
+            atoms.push_back(Atom::intern(name));
+        }
+
+        return atoms;
+    }
+
     Code::Code()
         : _id(0) {
         _globals = std::make_shared<std::vector<std::string>>();
@@ -44,6 +55,11 @@ namespace emerald {
         std::ifstream ifs(path, std::ios::binary);
         boost::archive::binary_iarchive archive(ifs);
         archive >> *this;
+        link();
+    }
+
+    Code::~Code() {
+        delete _jit_code.load();
     }
 
     const std::string& Code::get_label() const {
@@ -58,6 +74,10 @@ namespace emerald {
         return _instructions.size(); 
     }
 
+    const Code::PackedInstruction* Code::get_packed_instructions() const {
+        return _packed_instructions.data();
+    }
+
     void Code::write_nop() {
         WRITE_OP(OpCode::nop);
     }
@@ -251,8 +271,7 @@ namespace emerald {
     }
 
     size_t Code::write_new_num(double val) {
-        size_t id = _num_constants.size();
-        _num_constants.push_back(val);
+        size_t id = add_num_constant(val);
 
         WRITE_OP_WARGS(OpCode::new_num, { id });
 
@@ -260,8 +279,7 @@ namespace emerald {
     }
 
     size_t Code::write_new_str(const std::string& val) {
-        size_t id = _str_constants.size();
-        _str_constants.push_back(val);
+        size_t id = add_str_constant(val);
 
         WRITE_OP_WARGS(OpCode::new_str, { id });
 
@@ -296,6 +314,18 @@ namespace emerald {
         WRITE_OP_WARGS(OpCode::set_prop, { push_self_back });
     }
 
+    void Code::write_get_prop_str(const std::string& key, bool push_self_back) {
+        WRITE_OP_WARGS(OpCode::get_prop_str, { add_str_constant(key), push_self_back });
+    }
+
+    void Code::write_set_prop_str(const std::string& key, bool push_self_back) {
+        WRITE_OP_WARGS(OpCode::set_prop_str, { add_str_constant(key), push_self_back });
+    }
+
+    void Code::write_call_method(const std::string& name, size_t num_args) {
+        WRITE_OP_WARGS(OpCode::call_method, { add_str_constant(name), num_args });
+    }
+
     void Code::write_self() {
         WRITE_OP(OpCode::self);
     }
@@ -387,6 +417,28 @@ namespace emerald {
         return id;
     }
 
+    void Code::write_mov(uint32_t dst, uint32_t src) {
+        WRITE_OP_WARGS(OpCode::mov, { dst, src });
+    }
+
+    void Code::write_register_op(OpCode::Value op, uint32_t dst, uint32_t lhs, uint32_t rhs) {
+        CHECK_THROW_INVALID_ARGUMENT(OpCode::is_register_op(op) && op != OpCode::mov,
+            "not a binary register instruction: " + OpCode::get_string(op));
+        WRITE_OP_WARGS(op, { dst, lhs, rhs });
+    }
+
+    size_t Code::add_num_constant(double val) {
+        size_t id = _num_constants.size();
+        _num_constants.push_back(val);
+        return id;
+    }
+
+    size_t Code::add_str_constant(const std::string& val) {
+        size_t id = _str_constants.size();
+        _str_constants.push_back(val);
+        return id;
+    }
+
     std::shared_ptr<const Code> Code::get_func(const std::string& label) const {
         return _functions[_function_labels.at(label)];
     }
@@ -419,6 +471,10 @@ namespace emerald {
         return _str_constants.at(id);
     }
 
+    Atom Code::get_str_atom(size_t id) const {
+        return _str_atoms.at(id);
+    }
+
     bool Code::is_local_name(const std::string& name) {
         return std::find(_locals.begin(), _locals.end(), name) != _locals.end();
     }
@@ -427,6 +483,10 @@ namespace emerald {
         return _locals.at(id);
     }
 
+    Atom Code::get_local_atom(size_t id) const {
+        return _local_atoms.at(id);
+    }
+
     const std::vector<std::string>& Code::get_local_names() const {
         return _locals;
     }
@@ -443,6 +503,10 @@ namespace emerald {
         return _globals->at(id);
     }
 
+    Atom Code::get_global_atom(size_t id) const {
+        return _global_atoms.at(id);
+    }
+
     std::shared_ptr<const std::vector<std::string>> Code::get_global_names() const {
         return _globals;
     }
@@ -520,6 +584,28 @@ namespace emerald {
         _instructions.push_back(instr); 
     }
 
+    void Code::link() {
+        _packed_instructions.clear();
+        _packed_instructions.reserve(_instructions.size() + 2);
+        for (const Instruction& instr : _instructions) {
+            PackedInstruction packed = { instr.get_op(), { 0, 0, 0 } };
+            for (size_t i = 0; i < instr.get_arg_count(); i++) {
+                CHECK_THROW_LOGIC_ERROR(instr.get_arg(i) <= UINT32_MAX, "instruction argument out of range");
+                packed.args[i] = instr.get_arg(i);
+            }
+            _packed_instructions.push_back(packed);
+        }
+        _packed_instructions.push_back({ OpCode::null, { 0, 0, 0 } });
+        _packed_instructions.push_back({ OpCode::ret, { 0, 0, 0 } });
+
+        _str_atoms = intern_all(_str_constants);
+        _local_atoms = intern_all(_locals);
+        _global_atoms = intern_all(*_globals);
+        for (const std::shared_ptr<Code>& func : _functions) {
+            func->link();
+        }
+    }
+
     std::string Code::to_string(size_t depth) const {
         std::ostringstream oss;
         if (depth > 0 && !_label.empty()) {
@@ -565,6 +651,16 @@ namespace emerald {
         return i < _locals.size();
     }
 
+    std::string Code::Operand::to_string(uint32_t operand) {
+        if (is_data_stack(operand)) {
+            return "ds";
+        } else if (is_constant(operand)) {
+            return "k" + std::to_string(get_id(operand));
+        }
+
+        return "r" + std::to_string(get_id(operand));
+    }
+
     Code::Instruction::Instruction()
         : _op(OpCode::nop) {}
 
@@ -606,11 +702,16 @@ namespace emerald {
 
         oss << OpCode::get_string(_op);
 
+        bool register_op = OpCode::is_register_op(_op);
         size_t size = _args.size();
         for (size_t i = 0; i < size; i++) {
             if (i == 0) oss << ' ';
             else oss << ',';
-            oss << _args[i];
+            if (register_op) {
+                oss << Operand::to_string(_args[i]);
+            } else {
+                oss << _args[i];
+            }
         }
 
         return oss.str();
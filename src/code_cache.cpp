@@ -44,6 +44,12 @@ namespace emerald {
         return _code.at(module_name);
     }
 
+    void CodeCache::add_code(const std::string& module_name, std::shared_ptr<Code> code) {
+        code->link();
+        _code[module_name] = code;
+        load_imports(*code);
+    }
+
     void CodeCache::load_code(const std::string& module_name) {
         if (NativeModuleInitRegistry::has_module_init(module_name)) {
             return;
@@ -52,7 +58,11 @@ namespace emerald {
         std::filesystem::path path = locate_code(module_name);
         std::shared_ptr<Code> code = std::make_shared<Code>(path);
         _code[module_name] = code;
-        for (const std::string& import_name : code->get_import_names()) {
+        load_imports(*code);
+    }
+
+    void CodeCache::load_imports(const Code& code) {
+        for (const std::string& import_name : code.get_import_names()) {
             if (_code.find(import_name) != _code.end()) continue;
             load_code(import_name);
         }
@@ -25,8 +25,9 @@ namespace emerald {
 
     std::shared_ptr<Code> Compiler::compile(
             const std::vector<std::shared_ptr<Statement>>& statements,
-            std::shared_ptr<Reporter> reporter) {
-        Compiler compiler(reporter);
+            std::shared_ptr<Reporter> reporter,
+            bool stack_only) {
+        Compiler compiler(reporter, stack_only);
         for (std::shared_ptr<Statement> statement : statements) {
             compiler.Visit(statement);
         }
@@ -38,9 +39,11 @@ namespace emerald {
         return compiler._code;
     }
 
-    Compiler::Compiler(std::shared_ptr<Reporter> reporter)
+    Compiler::Compiler(std::shared_ptr<Reporter> reporter, bool stack_only)
         : _reporter(reporter),
-        _code(new Code()) {}
+        _code(new Code()),
+        _stack_only(stack_only),
+        _num_temps(0) {}
 
     void Compiler::VisitStatementBlock(const std::shared_ptr<StatementBlock>& statement_block) {
         for (std::shared_ptr<Statement> statement : statement_block->get_statements()) {
@@ -81,16 +84,30 @@ namespace emerald {
         Visit(for_statement->get_block());
 
         code()->bind_label(condition);
-        if (for_statement->get_by_expression()) {
-            Visit(for_statement->get_by_expression());
+        if (uses_registers()) {
+            size_t num_temps = _num_temps;
+            uint32_t step;
+            if (for_statement->get_by_expression()) {
+                step = write_operand(for_statement->get_by_expression());
+            } else {
+                step = Code::Operand::constant(code()->add_num_constant((for_statement->increments()) ? 1 : -1));
+            }
+            _num_temps = num_temps;
+
+            uint32_t slot = Code::Operand::slot(code()->add_local_name(for_statement->get_init_statement()->get_identifier()));
+            code()->write_register_op(OpCode::radd, slot, slot, step);
         } else {
-            code()->write_new_num((for_statement->increments()) ? 1 : -1);
-        }
+            if (for_statement->get_by_expression()) {
+                Visit(for_statement->get_by_expression());
+            } else {
+                code()->write_new_num((for_statement->increments()) ? 1 : -1);
+            }
 
-        write_fs_load(for_statement);
+            write_fs_load(for_statement);
 
-        code()->write_add();
-        write_st(for_statement->get_init_statement()->get_identifier());
+            code()->write_add();
+            write_st(for_statement->get_init_statement()->get_identifier());
+        }
 
         write_fs_condition(for_statement);
         code()->write_jmp_true(beginning);
@@ -200,6 +217,10 @@ namespace emerald {
 
     void Compiler::VisitDeclarationStatement(const std::shared_ptr<DeclarationStatement>& declaration_statement) {
         if (const std::shared_ptr<Expression>& init = declaration_statement->get_init_expression()) {
+            if (uses_registers() && write_register_st(declaration_statement->get_identifier(), init)) {
+                return;
+            }
+
             Visit(init);
         } else {
             code()->write_null();
@@ -230,7 +251,13 @@ namespace emerald {
 
         Visit(object_statement->get_block());
 
-        const std::vector<std::string>& locals = code()->get_local_names();
+        std::vector<std::string> locals;
+        for (const std::string& local : code()->get_local_names()) {
+            if (!is_temp_name(local)) {
+                locals.push_back(local);
+            }
+        }
+
         for (const std::string& local : locals) {
             code()->write_ldloc(local);
             code()->write_new_str(local);
@@ -339,6 +366,8 @@ namespace emerald {
                 Visit(assignment_expression->get_right_expression());
                 VisitPropertyLoad(property);
                 write_comp_assign(op);
+                VisitPropertyStore(property, nullptr);
+                VisitPropertyLoad(property);
             } else {
                 VisitPropertyStore(property, assignment_expression->get_right_expression());
                 VisitPropertyLoad(property);
@@ -348,6 +377,8 @@ namespace emerald {
                 Visit(assignment_expression->get_right_expression());
                 VisitIdentifierLoad(identifier);
                 write_comp_assign(op);
+                VisitIdentifierStore(identifier, nullptr);
+                VisitIdentifierLoad(identifier);
             } else {
                 VisitIdentifierStore(identifier, assignment_expression->get_right_expression());
                 VisitIdentifierLoad(identifier);
@@ -390,6 +421,17 @@ namespace emerald {
     }
 
     void Compiler::VisitArithmeticExpression(const std::shared_ptr<BinaryOp>& binary_op) {
+        if (has_register_form(binary_op)) {
+            uint32_t lhs, rhs;
+            write_register_sources(binary_op, lhs, rhs);
+            code()->write_register_op(
+                get_register_op(binary_op->get_operator()),
+                Code::Operand::DATA_STACK,
+                lhs,
+                rhs);
+            return;
+        }
+
         Visit(binary_op->get_right_expression());
         Visit(binary_op->get_left_expression());
 
@@ -474,8 +516,13 @@ namespace emerald {
         }
 
         if (std::shared_ptr<Property> property = ASTNode::as<Property>(callee)) {
-            VisitPropertyLoad(property, true);
-            code()->write_call(true, num_args);
+            if (std::shared_ptr<StringLiteral> key = ASTNode::as<StringLiteral>(property->get_property())) {
+                Visit(property->get_object());
+                code()->write_call_method(key->get_value(), num_args);
+            } else {
+                VisitPropertyLoad(property, true);
+                code()->write_call(true, num_args);
+            }
         } else {
             Visit(callee);
             code()->write_call(false, num_args);
@@ -486,7 +533,15 @@ namespace emerald {
         VisitPropertyLoad(property, false);
     }
 
+    // Constant keys are looked up by their interned atom rather than
+    // pushed as strings.
     void Compiler::VisitPropertyLoad(const std::shared_ptr<Property>& property, bool push_self_back) {
+        if (std::shared_ptr<StringLiteral> key = ASTNode::as<StringLiteral>(property->get_property())) {
+            Visit(property->get_object());
+            code()->write_get_prop_str(key->get_value(), push_self_back);
+            return;
+        }
+
         Visit(property->get_property());
         Visit(property->get_object());
 
@@ -494,7 +549,14 @@ namespace emerald {
     }
 
     void Compiler::VisitPropertyStore(const std::shared_ptr<Property>& property, const std::shared_ptr<Expression>& val, bool push_self_back) {
-        Visit(val);
+        // A null val stores whatever is already on top of the data stack.
+        if (val) Visit(val);
+
+        if (std::shared_ptr<StringLiteral> key = ASTNode::as<StringLiteral>(property->get_property())) {
+            Visit(property->get_object());
+            code()->write_set_prop_str(key->get_value(), push_self_back);
+            return;
+        }
 
         Visit(property->get_property());
         Visit(property->get_object());
@@ -522,9 +584,13 @@ namespace emerald {
     }
 
     void Compiler::VisitIdentifierStore(const std::shared_ptr<Identifier>& identifier, const std::shared_ptr<Expression>& val) {
-        Visit(val);
-
         const std::string& name = identifier->get_identifier();
+        if (val && uses_registers() && code()->is_local_name(name) && write_register_st(name, val)) {
+            return;
+        }
+
+        if (val) Visit(val);
+
         if (code()->is_local_name(name)) {
             code()->write_stloc(name);
         } else if (code()->is_global_name(name)) {
@@ -625,6 +691,20 @@ namespace emerald {
     }
 
     void Compiler::write_fs_condition(const std::shared_ptr<ForStatement>& for_statement) {
+        if (uses_registers()) {
+            size_t num_temps = _num_temps;
+            uint32_t to = write_operand(for_statement->get_to_expression());
+            _num_temps = num_temps;
+
+            const std::string& name = for_statement->get_init_statement()->get_identifier();
+            code()->write_register_op(
+                for_statement->increments() ? OpCode::rlt : OpCode::rgt,
+                Code::Operand::DATA_STACK,
+                Code::Operand::slot(code()->add_local_name(name)),
+                to);
+            return;
+        }
+
         Visit(for_statement->get_to_expression());
 
         write_fs_load(for_statement);
@@ -670,4 +750,149 @@ namespace emerald {
         }
     }
 
+    bool Compiler::uses_registers() {
+        // Module level variables are globals, which have no slots.
+        return !_stack_only && !is_top_level();
+    }
+
+    bool Compiler::has_register_form(const std::shared_ptr<BinaryOp>& binary_op) {
+        if (!uses_registers() || get_register_op(binary_op->get_operator()) == OpCode::nop) {
+            return false;
+        }
+
+        OperandKind lhs = get_operand_kind(binary_op->get_left_expression());
+        OperandKind rhs = get_operand_kind(binary_op->get_right_expression());
+        if (lhs == OperandKind::DATA_STACK && rhs == OperandKind::DATA_STACK) {
+            return false;
+        } else if (lhs == OperandKind::CONSTANT && rhs == OperandKind::CONSTANT) {
+            // Uncommon enough that the stack form is used.
+            return false;
+        } else if (rhs == OperandKind::LOCAL && may_write_locals(binary_op->get_left_expression())) {
+            // A local operand is read when the instruction runs, after the
+            // left operand, though the right operand is evaluated first.
+            return false;
+        }
+
+        return true;
+    }
+
+    Compiler::OperandKind Compiler::get_operand_kind(const std::shared_ptr<Expression>& expression) {
+        if (std::shared_ptr<Identifier> identifier = ASTNode::as<Identifier>(expression)) {
+            if (code()->is_local_name(identifier->get_identifier())) {
+                return OperandKind::LOCAL;
+            }
+        } else if (ASTNode::as<NumberLiteral>(expression)) {
+            return OperandKind::CONSTANT;
+        } else if (std::shared_ptr<BinaryOp> binary_op = ASTNode::as<BinaryOp>(expression)) {
+            if (has_register_form(binary_op)) {
+                return OperandKind::TEMP;
+            }
+        }
+
+        return OperandKind::DATA_STACK;
+    }
+
+    uint32_t Compiler::write_operand(const std::shared_ptr<Expression>& expression) {
+        switch (get_operand_kind(expression)) {
+        case OperandKind::LOCAL: {
+            const std::string& name = ASTNode::as<Identifier>(expression)->get_identifier();
+            return Code::Operand::slot(code()->add_local_name(name));
+        }
+        case OperandKind::CONSTANT: {
+            double value = ASTNode::as<NumberLiteral>(expression)->get_value();
+            return Code::Operand::constant(code()->add_num_constant(value));
+        }
+        case OperandKind::TEMP: {
+            std::shared_ptr<BinaryOp> binary_op = ASTNode::as<BinaryOp>(expression);
+            uint32_t lhs, rhs;
+            write_register_sources(binary_op, lhs, rhs);
+            uint32_t temp = create_temp();
+            code()->write_register_op(get_register_op(binary_op->get_operator()), temp, lhs, rhs);
+            return temp;
+        }
+        case OperandKind::DATA_STACK:
+        default:
+            Visit(expression);
+            return Code::Operand::DATA_STACK;
+        }
+    }
+
+    void Compiler::write_register_sources(const std::shared_ptr<BinaryOp>& binary_op, uint32_t& lhs, uint32_t& rhs) {
+        size_t num_temps = _num_temps;
+        rhs = write_operand(binary_op->get_right_expression());
+        lhs = write_operand(binary_op->get_left_expression());
+
+        // Sources are read before the result is written, so the result can
+        // reuse their temporaries.
+        _num_temps = num_temps;
+    }
+
+    bool Compiler::write_register_st(const std::string& identifier, const std::shared_ptr<Expression>& val) {
+        OperandKind kind = get_operand_kind(val);
+        if (kind == OperandKind::TEMP) {
+            std::shared_ptr<BinaryOp> binary_op = ASTNode::as<BinaryOp>(val);
+            uint32_t lhs, rhs;
+            write_register_sources(binary_op, lhs, rhs);
+            code()->write_register_op(
+                get_register_op(binary_op->get_operator()),
+                Code::Operand::slot(code()->add_local_name(identifier)),
+                lhs,
+                rhs);
+            return true;
+        } else if (kind == OperandKind::LOCAL || kind == OperandKind::CONSTANT) {
+            uint32_t src = write_operand(val);
+            code()->write_mov(Code::Operand::slot(code()->add_local_name(identifier)), src);
+            return true;
+        }
+
+        return false;
+    }
+
+    uint32_t Compiler::create_temp() {
+        // Temporaries are locals with names no identifier can have.
+        return Code::Operand::slot(code()->add_local_name(fmt::format("%{0}", _num_temps++)));
+    }
+
+    bool Compiler::is_temp_name(const std::string& name) {
+        return !name.empty() && name[0] == '%';
+    }
+
+    bool Compiler::may_write_locals(const std::shared_ptr<Expression>& expression) {
+        if (std::shared_ptr<BinaryOp> binary_op = ASTNode::as<BinaryOp>(expression)) {
+            return may_write_locals(binary_op->get_left_expression())
+                || may_write_locals(binary_op->get_right_expression());
+        } else if (std::shared_ptr<UnaryOp> unary_op = ASTNode::as<UnaryOp>(expression)) {
+            return may_write_locals(unary_op->get_expression());
+        }
+
+        return !ASTNode::as<Identifier>(expression)
+            && !ASTNode::as<NumberLiteral>(expression)
+            && !ASTNode::as<StringLiteral>(expression)
+            && !ASTNode::as<BooleanLiteral>(expression)
+            && !ASTNode::as<NullLiteral>(expression)
+            && !ASTNode::as<SelfExpression>(expression);
+    }
+
+    OpCode::Value Compiler::get_register_op(const std::shared_ptr<Token>& op) {
+        switch (op->get_type()) {
+        case Token::BIT_OR: return OpCode::rbit_or;
+        case Token::BIT_XOR: return OpCode::rbit_xor;
+        case Token::BIT_AND: return OpCode::rbit_and;
+        case Token::EQ: return OpCode::req;
+        case Token::NEQ: return OpCode::rneq;
+        case Token::LT: return OpCode::rlt;
+        case Token::GT: return OpCode::rgt;
+        case Token::LTE: return OpCode::rlte;
+        case Token::GTE: return OpCode::rgte;
+        case Token::SHL: return OpCode::rbit_shl;
+        case Token::SHR: return OpCode::rbit_shr;
+        case Token::ADD: return OpCode::radd;
+        case Token::SUB: return OpCode::rsub;
+        case Token::MUL: return OpCode::rmul;
+        case Token::DIV: return OpCode::rdiv;
+        case Token::MOD: return OpCode::rmod;
+        default: return OpCode::nop;
+        }
+    }
+
 } // namespace emerald
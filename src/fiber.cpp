@@ -0,0 +1,114 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstdint>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "emerald/check.h"
+#include "emerald/fiber.h"
+
+namespace emerald {
+
+    namespace {
+
+        thread_local Fiber* current = nullptr;
+
+        size_t get_page_size() {
+            static const size_t page_size = sysconf(_SC_PAGESIZE);
+            return page_size;
+        }
+
+    } // namespace
+
+    Fiber::Fiber(std::function<void()> entry, size_t stack_size)
+        : _entry(std::move(entry)),
+        _stack(nullptr),
+        _stack_size(0),
+        _finished(false) {
+        // The lowest page is left inaccessible, so overflowing the stack
+        // faults instead of corrupting whatever is mapped below it.
+        size_t page_size = get_page_size();
+        _stack_size = (stack_size + page_size - 1) / page_size * page_size + page_size;
+        _stack = mmap(
+            nullptr,
+            _stack_size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+            -1,
+            0);
+        if (_stack == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        mprotect(_stack, page_size, PROT_NONE);
+
+        getcontext(&_context);
+        _context.uc_stack.ss_sp = _stack;
+        _context.uc_stack.ss_size = _stack_size;
+        _context.uc_link = &_caller;
+
+        // makecontext only passes ints, so the fiber is split in two.
+        uintptr_t self = reinterpret_cast<uintptr_t>(this);
+        makecontext(
+            &_context,
+            reinterpret_cast<void (*)()>(&Fiber::run),
+            2,
+            static_cast<unsigned int>(self >> 32),
+            static_cast<unsigned int>(self));
+    }
+
+    Fiber::~Fiber() {
+        munmap(_stack, _stack_size);
+    }
+
+    void Fiber::resume() {
+        CHECK_THROW_LOGIC_ERROR(!_finished, "cannot resume a finished fiber");
+
+        Fiber* previous = current;
+        current = this;
+        swapcontext(&_caller, &_context);
+        current = previous;
+    }
+
+    void Fiber::yield() {
+        swapcontext(&_context, &_caller);
+    }
+
+    bool Fiber::is_finished() const {
+        return _finished;
+    }
+
+    Fiber* Fiber::get_current() {
+        return current;
+    }
+
+    // Exceptions can't unwind past the start of the fiber's stack, an
+    // escaping exception terminates like it would at the top of a thread.
+    void Fiber::run(unsigned int hi, unsigned int lo) {
+        Fiber* fiber = reinterpret_cast<Fiber*>(
+            (static_cast<uintptr_t>(hi) << 32) | static_cast<uintptr_t>(lo));
+        [fiber]() noexcept {
+            fiber->_entry();
+        }();
+        fiber->_finished = true;
+    }
+
+} // namespace emerald
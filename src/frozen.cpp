@@ -0,0 +1,221 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "emerald/frozen.h"
+#include "emerald/heap_root_source.h"
+#include "emerald/object.h"
+#include "emerald/objectutils.h"
+#include "emerald/process.h"
+
+namespace emerald {
+
+    // Copies a value into the frozen region. An object reached more than
+    // once is copied once, an object that contains itself can't be frozen.
+    class Frozen::Freezer {
+    public:
+        Freezer(Process* process)
+            : _process(process) {}
+
+        Element freeze(Value value) {
+            Object* obj = value.get_object();
+            if (!obj) {
+                return { value, nullptr };
+            }
+
+            if (obj->is_frozen()) {
+                return { Value(), obj->get_frozen() };
+            }
+
+            if (Number* num = object_cast<Number>(obj)) {
+                return { Value::number(num->get_native_value()), nullptr };
+            } else if (Boolean* boolean = object_cast<Boolean>(obj)) {
+                return { Value::boolean(boolean->get_native_value()), nullptr };
+            } else if (object_cast<Null>(obj)) {
+                return { Value::null(), nullptr };
+            }
+
+            auto it = _frozen.find(obj);
+            if (it != _frozen.end()) {
+                return { Value(), it->second };
+            }
+
+            if (!_freezing.insert(obj).second) {
+                throw ALLOC_EXCEPTION_IN_CTX("cannot freeze a value that contains itself", _process);
+            }
+
+            FrozenRef frozen = freeze_object(obj);
+            _freezing.erase(obj);
+            _frozen.emplace(obj, frozen);
+            return { Value(), frozen };
+        }
+
+    private:
+        Process* _process;
+        std::unordered_map<Object*, FrozenRef> _frozen;
+        std::unordered_set<Object*> _freezing;
+
+        FrozenRef freeze_object(Object* obj) {
+            NativeObjects& native_objects = _process->get_native_objects();
+            std::shared_ptr<Frozen> frozen;
+            if (String* str = object_cast<String>(obj);
+                    str && is_plain(obj, native_objects.get_string_prototype())) {
+                frozen.reset(new Frozen(Kind::STRING));
+                frozen->_string = str->get_native_value();
+            } else if (Array* arr = object_cast<Array>(obj);
+                    arr && is_plain(obj, native_objects.get_array_prototype())) {
+                frozen.reset(new Frozen(Kind::ARRAY));
+                frozen->_elements.reserve(arr->size());
+                for (size_t i = 0; i < arr->size(); i++) {
+                    frozen->_elements.push_back(freeze(arr->at(i)));
+                }
+            } else if (obj->get_type() == Object::TYPE
+                    && obj->get_parent() == native_objects.get_object_prototype()) {
+                frozen.reset(new Frozen(Kind::OBJECT));
+                for (Atom key : obj->get_property_keys()) {
+                    Shape::Property property;
+                    obj->get_shape()->lookup(key, property);
+                    if (property.accessor) {
+                        throw ALLOC_EXCEPTION_IN_CTX("cannot freeze an object with accessor properties", _process);
+                    }
+
+                    frozen->_properties.emplace_back(key, freeze(obj->get_slot(property.slot)));
+                }
+            } else {
+                throw ALLOC_EXCEPTION_IN_CTX("only strings, arrays and plain objects can be frozen", _process);
+            }
+
+            return frozen;
+        }
+
+        // Strings and arrays keep neither their own properties nor a user
+        // defined prototype when frozen, so they must have none.
+        static bool is_plain(Object* obj, Object* prototype) {
+            return obj->get_parent() == prototype && obj->num_properties() == 0;
+        }
+    };
+
+    // Keeps the objects made while thawing a frozen object alive until
+    // they're reachable from it.
+    class Frozen::ThawRoots final : public HeapRootSource {
+    public:
+        ThawRoots(Heap& heap)
+            : _heap(heap) {
+            _heap.add_root_source(this);
+        }
+
+        ~ThawRoots() {
+            _heap.remove_root_source(this);
+        }
+
+        NO_COPY(ThawRoots);
+
+        void add(Object* obj) {
+            _roots.push_back(obj);
+        }
+
+        std::vector<HeapManaged*> get_roots() override {
+            return _roots;
+        }
+
+    private:
+        Heap& _heap;
+        std::vector<HeapManaged*> _roots;
+    };
+
+    Frozen::Frozen(Kind kind)
+        : _kind(kind) {}
+
+    Value Frozen::freeze(Value value, Process* process) {
+        Object* obj = value.get_object();
+        if (!obj || obj->is_frozen()) {
+            return value;
+        }
+
+        Freezer freezer(process);
+        return thaw(freezer.freeze(value), process);
+    }
+
+    Object* Frozen::thaw(const FrozenRef& frozen, Process* process) {
+        switch (frozen->_kind) {
+        case Kind::STRING: {
+            Object* obj = ALLOC_STRING("");
+            obj->_frozen = frozen;
+            return obj;
+        }
+        case Kind::ARRAY: {
+            Object* obj = ALLOC_EMPTY_ARRAY();
+            obj->_frozen = frozen;
+            return obj;
+        }
+        case Kind::OBJECT: {
+            ThawRoots roots(process->get_heap());
+            return thaw(frozen, process, roots);
+        }
+        }
+
+        return nullptr;
+    }
+
+    Value Frozen::thaw(const Element& element, Process* process) {
+        if (element.frozen) {
+            return thaw(element.frozen, process);
+        }
+
+        return element.immediate;
+    }
+
+    Frozen::Kind Frozen::get_kind() const {
+        return _kind;
+    }
+
+    const std::string& Frozen::get_string() const {
+        return _string;
+    }
+
+    const std::vector<Frozen::Element>& Frozen::get_elements() const {
+        return _elements;
+    }
+
+    const std::vector<std::pair<Atom, Frozen::Element>>& Frozen::get_properties() const {
+        return _properties;
+    }
+
+    // Unlike strings and arrays, an object's properties have to be given
+    // to the wrapper up front, along with wrappers for frozen values.
+    Object* Frozen::thaw(const FrozenRef& frozen, Process* process, ThawRoots& roots) {
+        if (frozen->_kind != Kind::OBJECT) {
+            return thaw(frozen, process);
+        }
+
+        Object* obj = ALLOC_OBJECT();
+        roots.add(obj);
+        for (const std::pair<Atom, Element>& property : frozen->_properties) {
+            const Element& element = property.second;
+            obj->define_property(property.first, element.frozen
+                ? Value(thaw(element.frozen, process, roots))
+                : element.immediate);
+        }
+
+        obj->_frozen = frozen;
+        return obj;
+    }
+
+} // namespace emerald
@@ -15,32 +15,44 @@
 **  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include "emerald/heap.h"
+#include "emerald/sweeper.h"
 
 namespace emerald {
 
     Heap::Heap()
-        : _threshold(512) {}
+        : _phase(Phase::IDLE),
+        _old_mark_stack(MarkStack::Generation::OLD),
+        _threshold(512),
+        _old_threshold(4096),
+        _pause_budget(1000) {}
 
     Heap::~Heap() {
-        for (HeapManaged* managed : _managed_set) {
-            delete managed;
+        abort_old_collection();
+
+        for (HeapManaged* managed : _nursery) {
+            deallocate(managed);
         }
-    }
 
-    const std::unordered_set<HeapManaged*>& Heap::get_managed_set() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _managed_set;
+        for (HeapManaged* managed : _old) {
+            deallocate(managed);
+        }
     }
 
     size_t Heap::get_managed_count() const {
         std::lock_guard<std::mutex> lock(_mutex);
-        return _managed_set.size();
+        // Objects being swept are counted until the sweep is finished.
+        return _nursery.size() + _old.size() + _sweep_job.objects.size();
     }
 
     void Heap::add_managed(HeapManaged* managed) {
         std::lock_guard<std::mutex> lock(_mutex);
-        _managed_set.insert(managed);
+        uint16_t type_id = HeapTypes::get_id<HeapManaged>();
+        managed->set_type_id(type_id);
+        _stats.record_allocation(type_id, sizeof(HeapManaged));
+        _nursery.push_back(managed);
     }
 
     void Heap::add_root_source(HeapRootSource* root_source) {
@@ -53,6 +65,21 @@ namespace emerald {
         _root_source_set.erase(root_source);
     }
 
+    void Heap::remember(HeapManaged* managed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!managed->is_remembered()) {
+            managed->set_remembered(true);
+            _remembered_set.push_back(managed);
+        }
+    }
+
+    void Heap::shade(HeapManaged* managed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_phase == Phase::MARKING) {
+            _old_mark_stack.push(managed);
+        }
+    }
+
     void Heap::collect() {
         std::lock_guard<std::mutex> lock(_mutex);
         collect_nolock();
@@ -68,24 +95,237 @@ namespace emerald {
         _threshold = threshold;
     }
 
+    std::chrono::microseconds Heap::pause_budget() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _pause_budget;
+    }
+
+    void Heap::set_pause_budget(std::chrono::microseconds pause_budget) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pause_budget = pause_budget;
+    }
+
+    bool Heap::is_marking() const {
+        return _phase == Phase::MARKING;
+    }
+
+    HeapStats Heap::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+    void Heap::start_profiling(size_t sample_interval, HeapStats::SiteLocator locator) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.start_profiling(sample_interval, locator);
+    }
+
+    void Heap::stop_profiling() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.stop_profiling();
+    }
+
+    void Heap::collect_young_nolock() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        if (_pause_budget.count() > 0) {
+            deadline = start + _pause_budget;
+        }
+
+        size_t objects = _nursery.size();
+        size_t num_old = _old.size();
+
+        MarkStack stack(MarkStack::Generation::YOUNG);
+        mark_roots(stack);
+        for (HeapManaged* managed : _remembered_set) {
+            stack.trace(managed);
+        }
+        stack.drain();
+
+        sweep_nursery();
+        clear_remembered_set();
+        size_t survivors = _old.size() - num_old;
+
+        if (_phase == Phase::SWEEPING) {
+            finish_old_sweep(false);
+        }
+
+        if (_phase == Phase::IDLE && _old.size() >= _old_threshold) {
+            // The nursery is empty, so every root is in the old generation.
+            _phase = Phase::MARKING;
+            mark_roots(_old_mark_stack);
+        }
+
+        if (_phase == Phase::MARKING && mark_old_slice(deadline)) {
+            // Stores into roots don't go through the write barrier, so
+            // they have to be scanned again before marking can finish.
+            mark_roots(_old_mark_stack);
+            _old_mark_stack.drain();
+
+            start_old_sweep();
+        }
+
+        _stats.record_collection({
+            CollectionStats::Kind::YOUNG,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start),
+            objects,
+            survivors
+        });
+    }
+
     void Heap::collect_nolock() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        abort_old_collection();
+
+        // Every survivor ends up in the old generation, so no old object
+        // references a young one afterwards.
+        clear_remembered_set();
+
+        MarkStack stack(MarkStack::Generation::ALL);
+        mark_roots(stack);
+        stack.drain();
+
+        // Only the nursery's survivors are known here, the old generation's
+        // are recorded once the sweeper is done with it.
+        size_t objects = _nursery.size();
+        start_old_sweep();
+        sweep_nursery();
+
+        _stats.record_collection({
+            CollectionStats::Kind::FULL,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start),
+            objects,
+            _old.size()
+        });
+    }
+
+    bool Heap::mark_old_slice(std::chrono::steady_clock::time_point deadline) {
+        while (!_old_mark_stack.drain(SLICE_STRIDE)) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Hands the old generation over to the sweeper, objects promoted from
+    // now on start a new old generation which is merged with the survivors.
+    void Heap::start_old_sweep() {
+        _phase = Phase::SWEEPING;
+        _sweep_job.objects.swap(_old);
+
+        SweepJob* job = &_sweep_job;
+        _sweep_done = Sweeper::submit([job]() {
+            sweep(*job);
+        });
+    }
+
+    bool Heap::finish_old_sweep(bool wait) {
+        if (!wait && _sweep_done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        _sweep_done.get();
+        _allocator.reclaim(_sweep_job.freed);
+        for (size_t type_id = 0; type_id < _sweep_job.freed_counts.size(); type_id++) {
+            _stats.record_free(type_id, _sweep_job.freed_counts[type_id]);
+        }
+        _stats.record_old_sweep(_sweep_job.objects.size(), _sweep_job.survivors.size());
+
+        _old.insert(_old.end(), _sweep_job.survivors.begin(), _sweep_job.survivors.end());
+        _sweep_job.objects.clear();
+        _sweep_job.survivors.clear();
+        _sweep_job.freed_counts.clear();
+
+        _phase = Phase::IDLE;
+        _old_threshold = std::max(_old_threshold, 2 * _old.size());
+        return true;
+    }
+
+    // Leaves the old generation unmarked with nothing left to sweep.
+    void Heap::abort_old_collection() {
+        if (_phase == Phase::MARKING) {
+            _old_mark_stack.clear();
+            for (HeapManaged* managed : _old) {
+                managed->unmark();
+            }
+            _phase = Phase::IDLE;
+        } else if (_phase == Phase::SWEEPING) {
+            finish_old_sweep(true);
+        }
+    }
+
+    // Runs on the sweeper's thread. Only the mark bits and memory of the
+    // job's objects are touched, which the owning process leaves alone
+    // until the job is finished.
+    void Heap::sweep(SweepJob& job) {
+        for (HeapManaged* managed : job.objects) {
+            if (managed->is_marked()) {
+                managed->unmark();
+                job.survivors.push_back(managed);
+                continue;
+            }
+
+            uint16_t type_id = managed->get_type_id();
+            if (type_id >= job.freed_counts.size()) {
+                job.freed_counts.resize(type_id + 1, 0);
+            }
+            job.freed_counts[type_id]++;
+
+            uint8_t size_class = managed->get_size_class();
+            if (size_class == HeapAllocator::LARGE_SIZE_CLASS) {
+                delete managed;
+            } else {
+                managed->~HeapManaged();
+                job.freed.add(managed, size_class);
+            }
+        }
+    }
+
+    void Heap::mark_roots(MarkStack& stack) {
         for (HeapRootSource* root_source : _root_source_set) {
             for (HeapManaged* managed : root_source->get_roots()) {
-                managed->mark();
+                managed->mark(stack);
             }
         }
+    }
 
-        for (std::unordered_set<HeapManaged*>::iterator it = _managed_set.begin();
-            it != _managed_set.end();) {
-            HeapManaged* managed = *it;
+    void Heap::sweep_nursery() {
+        for (HeapManaged* managed : _nursery) {
             if (!managed->is_marked()) {
-                it = _managed_set.erase(it);
-                delete managed;
+                deallocate(managed);
             } else {
                 managed->unmark();
-                it++;
+                managed->promote();
+                _old.push_back(managed);
+
+                // Nothing may have marked what the survivor references, so
+                // it has to be traced if the old generation is being marked.
+                if (_phase == Phase::MARKING) {
+                    _old_mark_stack.push(managed);
+                }
             }
         }
+        _nursery.clear();
+    }
+
+    void Heap::clear_remembered_set() {
+        for (HeapManaged* managed : _remembered_set) {
+            managed->set_remembered(false);
+        }
+        _remembered_set.clear();
+    }
+
+    void Heap::deallocate(HeapManaged* managed) {
+        _stats.record_free(managed->get_type_id());
+
+        uint8_t size_class = managed->get_size_class();
+        if (size_class == HeapAllocator::LARGE_SIZE_CLASS) {
+            delete managed;
+        } else {
+            managed->~HeapManaged();
+            _allocator.deallocate(managed, size_class);
+        }
     }
 
 } // namespace emerald
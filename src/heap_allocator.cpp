@@ -0,0 +1,97 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <new>
+
+#include "emerald/heap_allocator.h"
+
+namespace emerald {
+
+    HeapAllocator::FreedCells::FreedCells() {
+        _heads.fill(nullptr);
+        _tails.fill(nullptr);
+    }
+
+    void HeapAllocator::FreedCells::add(void* ptr, uint8_t size_class) {
+        FreeCell* cell = static_cast<FreeCell*>(ptr);
+        cell->next = _heads[size_class];
+        _heads[size_class] = cell;
+        if (_tails[size_class] == nullptr) {
+            _tails[size_class] = cell;
+        }
+    }
+
+    HeapAllocator::HeapAllocator() {
+        _free_lists.fill(nullptr);
+    }
+
+    HeapAllocator::~HeapAllocator() {
+        for (void* chunk : _chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* HeapAllocator::allocate(uint8_t size_class) {
+        if (_free_lists[size_class] == nullptr) {
+            refill(size_class);
+        }
+
+        FreeCell* cell = _free_lists[size_class];
+        _free_lists[size_class] = cell->next;
+        return cell;
+    }
+
+    void HeapAllocator::deallocate(void* ptr, uint8_t size_class) {
+        FreeCell* cell = static_cast<FreeCell*>(ptr);
+        cell->next = _free_lists[size_class];
+        _free_lists[size_class] = cell;
+    }
+
+    void HeapAllocator::reclaim(FreedCells& cells) {
+        for (size_t i = 0; i < NUM_SIZE_CLASSES; i++) {
+            if (cells._heads[i] == nullptr) continue;
+
+            cells._tails[i]->next = _free_lists[i];
+            _free_lists[i] = cells._heads[i];
+            cells._heads[i] = nullptr;
+            cells._tails[i] = nullptr;
+        }
+    }
+
+    size_t HeapAllocator::get_num_chunks() const {
+        return _chunks.size();
+    }
+
+    void HeapAllocator::refill(uint8_t size_class) {
+        size_t cell_size = (size_class + 1) * GRANULARITY;
+        char* chunk = static_cast<char*>(::operator new(CHUNK_SIZE));
+        _chunks.push_back(chunk);
+
+        // Thread the cells in address order so consecutive allocations
+        // are adjacent in memory.
+        FreeCell* head = _free_lists[size_class];
+        for (size_t offset = CHUNK_SIZE - CHUNK_SIZE % cell_size; offset > 0;) {
+            offset -= cell_size;
+            FreeCell* cell = reinterpret_cast<FreeCell*>(chunk + offset);
+            cell->next = head;
+            head = cell;
+        }
+        _free_lists[size_class] = head;
+    }
+
+} // namespace emerald
@@ -15,12 +15,17 @@
 **  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include "emerald/heap_allocator.h"
 #include "emerald/heap_managed.h"
 
 namespace emerald {
 
     HeapManaged::HeapManaged()
-        : _marked(false) {}
+        : _marked(false),
+        _old(false),
+        _remembered(false),
+        _size_class(HeapAllocator::LARGE_SIZE_CLASS),
+        _type_id(0) {}
 
     HeapManaged::~HeapManaged() {}
 
@@ -28,16 +33,89 @@ namespace emerald {
         return _marked;
     }
 
-    void HeapManaged::mark() {
-        if (_marked) return;
-        _marked = true;
-        reach();
+    void HeapManaged::mark(MarkStack& stack) {
+        stack.push(this);
     }
 
     void HeapManaged::unmark() {
         _marked = false;
     }
 
-    void HeapManaged::reach() {}
+    bool HeapManaged::is_old() const {
+        return _old;
+    }
+
+    void HeapManaged::promote() {
+        _old = true;
+    }
+
+    bool HeapManaged::is_remembered() const {
+        return _remembered;
+    }
+
+    void HeapManaged::set_remembered(bool remembered) {
+        _remembered = remembered;
+    }
+
+    uint8_t HeapManaged::get_size_class() const {
+        return _size_class;
+    }
+
+    void HeapManaged::set_size_class(uint8_t size_class) {
+        _size_class = size_class;
+    }
+
+    uint16_t HeapManaged::get_type_id() const {
+        return _type_id;
+    }
+
+    void HeapManaged::set_type_id(uint16_t type_id) {
+        _type_id = type_id;
+    }
+
+    void HeapManaged::reach(MarkStack&) {}
+
+    MarkStack::MarkStack(Generation generation)
+        : _generation(generation) {}
+
+    void MarkStack::push(HeapManaged* managed) {
+        // The generation is checked first, the old generation's mark bits
+        // may be being cleared by the sweeper during a young collection.
+        if (_generation == Generation::YOUNG && managed->_old) return;
+        if (_generation == Generation::OLD && !managed->_old) return;
+        if (managed->_marked) return;
+        managed->_marked = true;
+        _stack.push_back(managed);
+    }
+
+    void MarkStack::trace(HeapManaged* managed) {
+        managed->reach(*this);
+    }
+
+    void MarkStack::drain() {
+        while (!_stack.empty()) {
+            HeapManaged* managed = _stack.back();
+            _stack.pop_back();
+            managed->reach(*this);
+        }
+    }
+
+    bool MarkStack::drain(size_t limit) {
+        for (size_t i = 0; i < limit && !_stack.empty(); i++) {
+            HeapManaged* managed = _stack.back();
+            _stack.pop_back();
+            managed->reach(*this);
+        }
+
+        return _stack.empty();
+    }
+
+    bool MarkStack::empty() const {
+        return _stack.empty();
+    }
+
+    void MarkStack::clear() {
+        _stack.clear();
+    }
 
 } // namespace emerald
@@ -0,0 +1,234 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "emerald/heap_stats.h"
+#include "emerald/scheduler.h"
+
+namespace emerald {
+
+    std::mutex HeapTypes::_mutex;
+    std::vector<std::string> HeapTypes::_names;
+
+    std::string HeapTypes::get_name(uint16_t id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _names[id];
+    }
+
+    uint16_t HeapTypes::add(const std::type_info& info) {
+        std::string name = info.name();
+#ifdef __GNUG__
+        int status = 0;
+        std::unique_ptr<char, void(*)(void*)> demangled(
+            abi::__cxa_demangle(info.name(), nullptr, nullptr, &status),
+            std::free);
+        if (status == 0) {
+            name = demangled.get();
+        }
+#endif
+        size_t pos = name.rfind("::");
+        if (pos != std::string::npos) {
+            name = name.substr(pos + 2);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _names.push_back(name);
+        return _names.size() - 1;
+    }
+
+    bool AllocationSite::operator<(const AllocationSite& other) const {
+        return std::tie(label, instruction) < std::tie(other.label, other.instruction);
+    }
+
+    HeapStats::HeapStats()
+        : _created(std::chrono::steady_clock::now()),
+        _num_allocations(0),
+        _allocated_bytes(0),
+        _num_young_collections(0),
+        _num_full_collections(0),
+        _num_old_collections(0),
+        _total_pause(0),
+        _max_pause(0),
+        _young_survivor_ratio(0),
+        _old_survivor_ratio(0),
+        _sample_interval(0),
+        _until_sample(0),
+        _profiling_process(nullptr) {}
+
+    void HeapStats::record_allocation(uint16_t type_id, size_t size) {
+        if (type_id >= _live_counts.size()) {
+            _live_counts.resize(type_id + 1, 0);
+            _type_sizes.resize(type_id + 1, 0);
+        }
+
+        _live_counts[type_id]++;
+        _type_sizes[type_id] = size;
+        _num_allocations++;
+        _allocated_bytes += size;
+
+        if (_sample_interval > 0 && --_until_sample == 0) {
+            reset_sample_countdown();
+            if (Scheduler::get_current() == _profiling_process) {
+                _samples[std::make_tuple(_locator(), type_id)]++;
+            }
+        }
+    }
+
+    void HeapStats::record_free(uint16_t type_id, size_t count) {
+        _live_counts[type_id] -= count;
+    }
+
+    void HeapStats::record_collection(const CollectionStats& collection) {
+        if (collection.kind == CollectionStats::Kind::YOUNG) {
+            _num_young_collections++;
+            if (collection.objects > 0) {
+                _young_survivor_ratio = static_cast<double>(collection.survivors) / collection.objects;
+            }
+        } else {
+            _num_full_collections++;
+        }
+
+        _total_pause += collection.pause;
+        _max_pause = std::max(_max_pause, collection.pause);
+
+        _recent_collections.push_back(collection);
+        if (_recent_collections.size() > MAX_RECENT_COLLECTIONS) {
+            _recent_collections.pop_front();
+        }
+    }
+
+    void HeapStats::record_old_sweep(size_t objects, size_t survivors) {
+        _num_old_collections++;
+        if (objects > 0) {
+            _old_survivor_ratio = static_cast<double>(survivors) / objects;
+        }
+    }
+
+    size_t HeapStats::get_num_types() const {
+        return _live_counts.size();
+    }
+
+    size_t HeapStats::get_live_count(uint16_t type_id) const {
+        return type_id < _live_counts.size() ? _live_counts[type_id] : 0;
+    }
+
+    size_t HeapStats::get_live_bytes(uint16_t type_id) const {
+        return type_id < _live_counts.size() ? _live_counts[type_id] * _type_sizes[type_id] : 0;
+    }
+
+    size_t HeapStats::get_live_count() const {
+        size_t count = 0;
+        for (size_t type_count : _live_counts) {
+            count += type_count;
+        }
+        return count;
+    }
+
+    size_t HeapStats::get_live_bytes() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < _live_counts.size(); i++) {
+            bytes += _live_counts[i] * _type_sizes[i];
+        }
+        return bytes;
+    }
+
+    size_t HeapStats::get_num_allocations() const {
+        return _num_allocations;
+    }
+
+    size_t HeapStats::get_allocated_bytes() const {
+        return _allocated_bytes;
+    }
+
+    double HeapStats::get_allocation_rate() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _created;
+        return elapsed.count() > 0 ? _allocated_bytes / elapsed.count() : 0;
+    }
+
+    size_t HeapStats::get_num_collections(CollectionStats::Kind kind) const {
+        return kind == CollectionStats::Kind::YOUNG ? _num_young_collections : _num_full_collections;
+    }
+
+    size_t HeapStats::get_num_old_collections() const {
+        return _num_old_collections;
+    }
+
+    std::chrono::microseconds HeapStats::get_total_pause() const {
+        return _total_pause;
+    }
+
+    std::chrono::microseconds HeapStats::get_max_pause() const {
+        return _max_pause;
+    }
+
+    const std::deque<CollectionStats>& HeapStats::get_recent_collections() const {
+        return _recent_collections;
+    }
+
+    double HeapStats::get_young_survivor_ratio() const {
+        return _young_survivor_ratio;
+    }
+
+    double HeapStats::get_old_survivor_ratio() const {
+        return _old_survivor_ratio;
+    }
+
+    void HeapStats::start_profiling(size_t sample_interval, SiteLocator locator) {
+        _sample_interval = std::max<size_t>(sample_interval, 1);
+        reset_sample_countdown();
+        _locator = locator;
+        _profiling_process = Scheduler::get_current();
+        _samples.clear();
+    }
+
+    void HeapStats::stop_profiling() {
+        _sample_interval = 0;
+        _locator = nullptr;
+    }
+
+    bool HeapStats::is_profiling() const {
+        return _sample_interval > 0;
+    }
+
+    // The interval is randomized around its mean, so loops that allocate a
+    // multiple of the interval don't keep sampling the same site.
+    void HeapStats::reset_sample_countdown() {
+        std::uniform_int_distribution<size_t> distribution(1, 2 * _sample_interval - 1);
+        _until_sample = distribution(_sample_random);
+    }
+
+    std::vector<AllocationSample> HeapStats::get_profile() const {
+        std::vector<AllocationSample> profile;
+        for (const auto& [key, count] : _samples) {
+            profile.push_back({ std::get<0>(key), std::get<1>(key), count });
+        }
+
+        std::sort(profile.begin(), profile.end(), [](const AllocationSample& lhs, const AllocationSample& rhs) {
+            return lhs.count > rhs.count;
+        });
+        return profile;
+    }
+
+} // namespace emerald
@@ -0,0 +1,142 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "emerald/inline_cache.h"
+#include "emerald/object.h"
+#include "emerald/shape.h"
+
+namespace emerald {
+
+    InlineCache::InlineCache()
+        : _num_entries(0) {}
+
+    Value InlineCache::lookup(const Object* obj, Atom key, size_t epoch, bool& accessor) const {
+        if (_num_entries == 0 || key != _key) {
+            return Value();
+        }
+
+        Shape* shape = obj->get_shape();
+        for (size_t i = 0; i < _num_entries; i++) {
+            const Entry& entry = _entries[i];
+            if (entry.shape != shape || entry.transition) {
+                continue;
+            }
+
+            if (!entry.holder) {
+                accessor = entry.accessor;
+                return obj->get_slot(entry.slot);
+            }
+
+            // Prototype hits also depend on the rest of the chain, which
+            // is only known to be unchanged while the epoch is.
+            if (entry.parent == obj->get_parent() && entry.epoch == epoch) {
+                accessor = entry.accessor;
+                return entry.holder->get_slot(entry.slot);
+            }
+        }
+
+        return Value();
+    }
+
+    void InlineCache::add_lookup(const Object* obj, Atom key, Object* holder, const Shape::Property& property, size_t epoch) {
+        if (!can_add(obj->get_shape(), key)) {
+            return;
+        }
+
+        _entries[_num_entries++] = {
+            obj->get_shape(),
+            nullptr,
+            obj->get_parent(),
+            holder == obj ? nullptr : holder,
+            property.slot,
+            property.accessor,
+            epoch
+        };
+    }
+
+    bool InlineCache::lookup_own(const Object* obj, Atom key, size_t& slot) const {
+        if (_num_entries == 0 || key != _key) {
+            return false;
+        }
+
+        Shape* shape = obj->get_shape();
+        for (size_t i = 0; i < _num_entries; i++) {
+            const Entry& entry = _entries[i];
+            if (entry.shape == shape && !entry.transition && !entry.holder && !entry.accessor) {
+                slot = entry.slot;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void InlineCache::add_own(const Object* obj, Atom key, const Shape::Property& property) {
+        add_lookup(obj, key, const_cast<Object*>(obj), property, 0);
+    }
+
+    Shape* InlineCache::lookup_transition(const Object* obj, Atom key, size_t epoch) const {
+        if (_num_entries == 0 || key != _key) {
+            return nullptr;
+        }
+
+        Shape* shape = obj->get_shape();
+        for (size_t i = 0; i < _num_entries; i++) {
+            const Entry& entry = _entries[i];
+            if (entry.shape == shape
+                    && entry.transition
+                    && entry.parent == obj->get_parent()
+                    && entry.epoch == epoch) {
+                return entry.transition;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void InlineCache::add_transition(Shape* shape, Object* parent, Atom key, Shape* transition, size_t epoch) {
+        if (!can_add(shape, key)) {
+            return;
+        }
+
+        _entries[_num_entries++] = {
+            shape,
+            transition,
+            parent,
+            nullptr,
+            0,
+            false,
+            epoch
+        };
+    }
+
+    bool InlineCache::can_add(Shape* shape, Atom key) {
+        // Dictionary shapes belong to a single object and may be freed with
+        // it, so they are never cached.
+        if (shape->is_dictionary()) {
+            return false;
+        }
+
+        if (key != _key) {
+            _key = key;
+            _num_entries = 0;
+        }
+
+        return _num_entries < MAX_ENTRIES;
+    }
+
+} // namespace emerald
@@ -15,367 +15,487 @@
 **  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <stdexcept>
+
 #include "emerald/code.h"
 #include "emerald/code_cache.h"
 #include "emerald/interpreter.h"
 #include "emerald/iterutils.h"
+#include "emerald/jit.h"
 #include "emerald/module.h"
 #include "emerald/objectutils.h"
 
 namespace emerald {
 
-    Object* Interpreter::execute(Process* process) {
+    Value Interpreter::execute(Process* process) {
         Stack& stack = process->get_stack();
         Stack::Frame& current_frame = stack.peek();
-        while (current_frame.has_instructions_left()) {
+        while (true) {
             try {
-                const Code::Instruction& instr = current_frame.get_next_instruction();
-                current_frame.increment_instruction_pointer();
-
-                switch (instr.get_op()) {
-                case OpCode::nop:
-                    break;
-                case OpCode::jmp:
-                    current_frame.set_instruction_pointer(instr.get_arg(0));
-                    break;
-                case OpCode::jmp_true:
-                    if (call_method0<Boolean>(current_frame.pop_ds(), magic_methods::boolean, process)->get_native_value()) {
-                        current_frame.set_instruction_pointer(instr.get_arg(0));
-                    }
-                    break;
-                case OpCode::jmp_true_or_pop:
-                    if (call_method0<Boolean>(current_frame.peek_ds(), magic_methods::boolean, process)->get_native_value()) {
-                        current_frame.set_instruction_pointer(instr.get_arg(0));
-                    } else {
-                        current_frame.pop_ds();
-                    }
-                    break;
-                case OpCode::jmp_false:
-                    if (!call_method0<Boolean>(current_frame.pop_ds(), magic_methods::boolean, process)->get_native_value()) {
-                        current_frame.set_instruction_pointer(instr.get_arg(0));
-                    }
-                    break;
-                case OpCode::jmp_false_or_pop:
-                    if (!call_method0<Boolean>(current_frame.peek_ds(), magic_methods::boolean, process)->get_native_value()) {
-                        current_frame.set_instruction_pointer(instr.get_arg(0));
-                    } else {
-                        current_frame.pop_ds();
-                    }
-                    break;
-                case OpCode::jmp_data:
-                    if (current_frame.get_data_stack().size()) {
-                        current_frame.set_instruction_pointer(instr.get_arg(0));
-                    }
-                    break;
-                case OpCode::pop:
-                    current_frame.pop_n_ds(instr.get_arg(0));
-                    break;
-                case OpCode::neg:
-                    current_frame.push_ds(call_method0<Object>(current_frame.pop_ds(), magic_methods::neg, process));
-                    break;
-                case OpCode::log_neg:
-                    current_frame.push_ds(BOOLEAN(
-                        !call_method0<Boolean>(
-                            current_frame.pop_ds(),
-                            magic_methods::boolean,
-                            process
-                        )->get_native_value()));
-                    break;
-                case OpCode::add:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::add, process));
-                    break;
-                case OpCode::sub:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::sub, process));  
-                    break;
-                case OpCode::mul:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::mul, process));
-                    break;
-                case OpCode::div:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::div, process));
-                    break;
-                case OpCode::mod:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::mod, process));
-                    break;
-                case OpCode::iadd:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::iadd, process));
-                    break;
-                case OpCode::isub:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::isub, process));
-                    break;
-                case OpCode::imul:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::imul, process));
-                    break;
-                case OpCode::idiv:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::idiv, process));
-                    break;
-                case OpCode::imod:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::imod, process));
-                    break;
-                case OpCode::eq:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::eq, process));
-                    break;
-                case OpCode::neq:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::neq, process));
-                    break;
-                case OpCode::lt:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::lt, process));
-                    break;
-                case OpCode::gt:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::gt, process));
-                    break;
-                case OpCode::lte:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::lte, process));
-                    break;
-                case OpCode::gte:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::gte, process));
-                    break;
-                case OpCode::bit_not:
-                    current_frame.push_ds(call_method0<Object>(current_frame.pop_ds(), magic_methods::bit_not, process));
-                    break;
-                case OpCode::bit_or:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::bit_or, process));
-                    break;
-                case OpCode::bit_xor:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::bit_xor, process));
-                    break;
-                case OpCode::bit_and:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::bit_and, process));
-                    break;
-                case OpCode::bit_shl:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::bit_shl, process));
-                    break;
-                case OpCode::bit_shr:
-                    current_frame.push_ds(call_method1<Object>(current_frame.pop_ds(), magic_methods::bit_shr, process));
-                    break;
-                case OpCode::str:
-                    current_frame.push_ds(call_method0<String>(current_frame.pop_ds(), magic_methods::str, process));
-                    break;
-                case OpCode::boolean:
-                    current_frame.push_ds(call_method0<Boolean>(current_frame.pop_ds(), magic_methods::boolean, process));
-                    break;
-                case OpCode::call: {
-                    Object* obj = current_frame.pop_ds();
-                    Object* receiver;
-                    if (instr.get_arg(0)) {
-                        receiver = current_frame.pop_ds();
-                    } else {
-                        receiver = current_frame.get_globals();
-                    }
-                    std::vector<Object*> args = current_frame.pop_n_ds(instr.get_arg(1));
-                    current_frame.push_ds(call_obj<Object>(obj, receiver, args, process));
-                    break;
-                }
-                case OpCode::ret: {
-                    Object* ret = current_frame.pop_ds();
+                return execute_frame(current_frame, process);
+            } catch (Object* exc) {
+                if (!current_frame.has_catch_ip()) {
                     stack.pop_frame();
-                    return ret;
+                    throw;
                 }
-                case OpCode::new_obj:
-                    current_frame.push_ds(new_obj(instr.get_arg(0), instr.get_arg(1), process));
-                    break;
-                case OpCode::init: {
-                    Object* receiver = current_frame.pop_ds();
-                    call_method<Object>(receiver, magic_methods::init, instr.get_arg(0), process);
-                    current_frame.push_ds(receiver);
-                    break;
+
+                current_frame.set_instruction_pointer(current_frame.get_catch_ip());
+                current_frame.pop_catch_ip();
+                current_frame.push_ds(exc);
+            }
+        }
+    }
+
+// Threaded dispatch jumps straight from one instruction's handler to the
+// next through a table of label addresses, which GCC and Clang support as
+// an extension. Other compilers dispatch through the switch. Handlers with
+// locals close their scope before dispatching, since leaving a scope through
+// a computed goto does not run destructors.
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPUTED_GOTO
+#endif
+
+#ifdef COMPUTED_GOTO
+#define TARGET(name) op_##name:
+#define DISPATCH()                                    \
+    do {                                              \
+        instr = ip++;                                 \
+        current_frame.set_current_instruction(instr); \
+        goto *dispatch_table[instr->op];              \
+    } while (0)
+#else
+#define TARGET(name) case OpCode::name:
+#define DISPATCH() continue
+#endif
+
+// The profiler's timer only raises a flag, samples are taken when a frame
+// is entered and on jumps, so loops and recursion are both covered. The
+// scheduler counts reductions at the same points.
+#define POLL()                             \
+    do {                                   \
+        if (profiler.sample_requested()) { \
+            profiler.take_sample(stack);   \
+        }                                  \
+        process->count_reduction();        \
+    } while (0)
+
+// Loops end in a backward jump, once they are hot the frame continues in
+// native code from the jump's target.
+#define JUMP(target)                                                    \
+    do {                                                                \
+        if ((target) <= static_cast<size_t>(instr - instrs)) {          \
+            if (const JitCode* jit_code = Jit::count(*code)) {          \
+                current_frame.set_instruction_pointer(target);          \
+                return Jit::execute(*jit_code, current_frame, process); \
+            }                                                           \
+        }                                                               \
+        ip = instrs + (target);                                         \
+        POLL();                                                         \
+    } while (0)
+
+    Value Interpreter::execute_frame(Stack::Frame& current_frame, Process* process) {
+        Stack& stack = process->get_stack();
+        Profiler& profiler = process->get_profiler();
+        const Code* code = current_frame.get_code().get();
+        const Code::PackedInstruction* instrs = code->get_packed_instructions();
+        const Code::PackedInstruction* ip = instrs + current_frame.get_instruction_pointer();
+        const Code::PackedInstruction* instr;
+
+        POLL();
+        if (const JitCode* jit_code = Jit::count(*code)) {
+            return Jit::execute(*jit_code, current_frame, process);
+        }
+
+#ifdef COMPUTED_GOTO
+#define X(name, arg_count) &&op_##name,
+        static void* const dispatch_table[OpCode::NUM_OPCODES] = {
+            _OPCODES
+        };
+#undef X
+
+        DISPATCH();
+#else
+        while (true) {
+            instr = ip++;
+            current_frame.set_current_instruction(instr);
+            switch (instr->op) {
+#endif
+            TARGET(nop)
+                DISPATCH();
+            TARGET(jmp)
+                JUMP(instr->args[0]);
+                DISPATCH();
+            TARGET(jmp_true)
+                if (call_method0<bool>(current_frame.pop_ds(), magic_methods::boolean, process)) {
+                    JUMP(instr->args[0]);
                 }
-                case OpCode::new_func: {
-                    std::shared_ptr<const Code> code = current_frame.get_code()->get_func(instr.get_arg(0));
-                    Function* func = process->get_heap().allocate<Function>(
-                        process,
-                        code,
-                        current_frame.get_globals());
-                    current_frame.push_ds(func);
-                    break;
+                DISPATCH();
+            TARGET(jmp_true_or_pop)
+                if (call_method0<bool>(current_frame.peek_ds(), magic_methods::boolean, process)) {
+                    JUMP(instr->args[0]);
+                } else {
+                    current_frame.pop_ds();
                 }
-                case OpCode::new_num: {
-                    double value = current_frame.get_code()->get_num_constant(instr.get_arg(0));
-                    Number* num = ALLOC_NUMBER(value);
-                    current_frame.push_ds(num);
-                    break;
+                DISPATCH();
+            TARGET(jmp_false)
+                if (!call_method0<bool>(current_frame.pop_ds(), magic_methods::boolean, process)) {
+                    JUMP(instr->args[0]);
                 }
-                case OpCode::new_str: {
-                    const std::string& value = current_frame.get_code()->get_str_constant(instr.get_arg(0));
-                    String* str = ALLOC_STRING(value);
-                    current_frame.push_ds(str);
-                    break;
+                DISPATCH();
+            TARGET(jmp_false_or_pop)
+                if (!call_method0<bool>(current_frame.peek_ds(), magic_methods::boolean, process)) {
+                    JUMP(instr->args[0]);
+                } else {
+                    current_frame.pop_ds();
                 }
-                case OpCode::new_boolean: {
-                    bool value = instr.get_arg(0);
-                    Boolean* boolean = BOOLEAN(value);
-                    current_frame.push_ds(boolean);
-                    break;
+                DISPATCH();
+            TARGET(jmp_data)
+                if (current_frame.num_ds()) {
+                    JUMP(instr->args[0]);
                 }
-                case OpCode::new_arr: {
-                    Array* array = ALLOC_EMPTY_ARRAY();
-                    for (size_t i = 0; i < instr.get_arg(0); i++) {
-                        array->push(current_frame.pop_ds());
-                    }
-                    current_frame.push_ds(array);
-                    break;
+                DISPATCH();
+            TARGET(pop)
+                current_frame.drop_n_ds(instr->args[0]);
+                DISPATCH();
+            TARGET(neg)
+                current_frame.push_ds(call_method0<Value>(current_frame.pop_ds(), magic_methods::neg, process));
+                DISPATCH();
+            TARGET(log_neg)
+                current_frame.push_ds(BOOLEAN(
+                    !call_method0<bool>(
+                        current_frame.pop_ds(),
+                        magic_methods::boolean,
+                        process)));
+                DISPATCH();
+            TARGET(add)
+            TARGET(sub)
+            TARGET(mul)
+            TARGET(div)
+            TARGET(mod)
+            TARGET(iadd)
+            TARGET(isub)
+            TARGET(imul)
+            TARGET(idiv)
+            TARGET(imod)
+            TARGET(eq)
+            TARGET(neq)
+            TARGET(lt)
+            TARGET(gt)
+            TARGET(lte)
+            TARGET(gte)
+            TARGET(bit_or)
+            TARGET(bit_xor)
+            TARGET(bit_and)
+            TARGET(bit_shl)
+            TARGET(bit_shr)
+                execute_binary_op(instr->op, current_frame, process);
+                DISPATCH();
+            TARGET(bit_not)
+                current_frame.push_ds(call_method0<Value>(current_frame.pop_ds(), magic_methods::bit_not, process));
+                DISPATCH();
+            TARGET(str)
+                current_frame.push_ds(call_method0<String*>(current_frame.pop_ds(), magic_methods::str, process));
+                DISPATCH();
+            TARGET(boolean)
+                current_frame.push_ds(BOOLEAN(call_method0<bool>(current_frame.pop_ds(), magic_methods::boolean, process)));
+                DISPATCH();
+            TARGET(call) {
+                Value obj = current_frame.pop_ds();
+                Value receiver;
+                if (instr->args[0]) {
+                    receiver = current_frame.pop_ds();
+                } else {
+                    receiver = current_frame.get_globals();
                 }
-                case OpCode::null: {
-                    current_frame.push_ds(NONE);
-                    break;
+                current_frame.push_ds(call_obj_from_stack(obj, receiver, instr->args[1], process));
+            }
+            DISPATCH();
+            TARGET(ret) {
+                Value ret = current_frame.pop_ds();
+                stack.pop_frame();
+                return ret;
+            }
+            TARGET(new_obj)
+                current_frame.push_ds(new_obj(instr->args[0], instr->args[1], process));
+                DISPATCH();
+            TARGET(init) {
+                Value receiver = current_frame.pop_ds();
+                call_method<Value>(receiver, magic_methods::init, instr->args[0], process);
+                current_frame.push_ds(receiver);
+            }
+            DISPATCH();
+            TARGET(new_func) {
+                std::shared_ptr<const Code> func_code = code->get_func(instr->args[0]);
+                Function* func = process->get_heap().allocate<Function>(
+                    process,
+                    func_code,
+                    current_frame.get_globals());
+                current_frame.push_ds(func);
+            }
+            DISPATCH();
+            TARGET(new_num) {
+                double value = code->get_num_constant(instr->args[0]);
+                current_frame.push_ds(NUMBER(value));
+            }
+            DISPATCH();
+            TARGET(new_str) {
+                Atom value = code->get_str_atom(instr->args[0]);
+                String* str = process->get_heap().allocate<String>(process, STRING_PROTOTYPE, value);
+                current_frame.push_ds(str);
+            }
+            DISPATCH();
+            TARGET(new_boolean) {
+                bool value = instr->args[0];
+                current_frame.push_ds(BOOLEAN(value));
+            }
+            DISPATCH();
+            TARGET(new_arr) {
+                Array* array = ALLOC_EMPTY_ARRAY();
+                for (size_t i = 0; i < instr->args[0]; i++) {
+                    array->push(current_frame.pop_ds());
                 }
-                case OpCode::def_accessor_prop: {
-                    Object* obj = current_frame.pop_ds();
-                    Object* key = current_frame.pop_ds();
-                    Object* getter = current_frame.pop_ds();
-                    Object* setter;
-                    if (instr.get_arg(0)) {
-                        setter = current_frame.pop_ds();
-                    } else {
-                        setter = nullptr;
-                    }
-                    if (instr.get_arg(1)) {
-                        current_frame.push_ds(obj);
-                    }
-                    PropertyDescriptor* descriptor = ALLOC_PROP_ACC_DESC(getter, setter);
-                    obj->define_property(key->as_str(), descriptor);
-                    break;
+                current_frame.push_ds(array);
+            }
+            DISPATCH();
+            TARGET(null) {
+                current_frame.push_ds(NONE);
+            }
+            DISPATCH();
+            TARGET(def_accessor_prop) {
+                // Operands stay on the data stack until the property is
+                // defined, so a collection triggered by the descriptor
+                // allocation can still reach them.
+                Value obj = current_frame.peek_ds(0);
+                Value key = current_frame.peek_ds(1);
+                Object* getter = current_frame.peek_ds(2).to_object(process);
+                Object* setter;
+                if (instr->args[0]) {
+                    setter = current_frame.peek_ds(3).to_object(process);
+                } else {
+                    setter = nullptr;
                 }
-                case OpCode::def_data_prop: {
-                    Object* obj = current_frame.pop_ds();
-                    Object* key = current_frame.pop_ds();
-                    Object* val = current_frame.pop_ds();
-                    PropertyDescriptor* descriptor = ALLOC_PROP_DATA_DESC(val);
-                    if (instr.get_arg(0)) {
-                        current_frame.push_ds(obj);
-                    }
-                    obj->define_property(key->as_str(), descriptor);
-                    break;
+                PropertyDescriptor* descriptor = ALLOC_PROP_ACC_DESC(getter, setter);
+                obj.to_object(process)->define_property(key.as_atom(), descriptor);
+                current_frame.drop_n_ds(instr->args[0] ? 4 : 3);
+                if (instr->args[1]) {
+                    current_frame.push_ds(obj);
                 }
-                case OpCode::get_prop: {
-                    Object* obj = current_frame.pop_ds();
-                    Object* key = current_frame.pop_ds();
-                    if (Object* val = obj->get_property(key->as_str())) {
-                        if (instr.get_arg(0)) {
-                            current_frame.push_ds(obj);
-                        }
-                        current_frame.push_ds(val);
-                    } else {
-                        throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key->as_str()));
-                    }
-                    break;
+            }
+            DISPATCH();
+            TARGET(def_data_prop) {
+                Value obj = current_frame.peek_ds(0);
+                Value key = current_frame.peek_ds(1);
+                Value val = current_frame.peek_ds(2);
+                obj.to_object(process)->define_property(key.as_atom(), val);
+                current_frame.drop_n_ds(3);
+                if (instr->args[0]) {
+                    current_frame.push_ds(obj);
                 }
-                case OpCode::set_prop: {
-                    Object* obj = current_frame.pop_ds();
-                    Object* key = current_frame.pop_ds();
-                    Object* val = current_frame.pop_ds();
-                    if (instr.get_arg(0)) {
+            }
+            DISPATCH();
+            TARGET(get_prop) {
+                Value obj = current_frame.pop_ds();
+                Value key = current_frame.pop_ds();
+                if (Value val = get_property(obj, key.as_atom(), current_frame.get_inline_cache(instr - instrs), process)) {
+                    if (instr->args[0]) {
                         current_frame.push_ds(obj);
                     }
-                    obj->set_property(key->as_str(), val);
-                    break;
+                    current_frame.push_ds(val);
+                } else {
+                    throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.as_str()));
                 }
-                case OpCode::self:
-                    current_frame.push_ds(current_frame.get_receiver());
-                    break;
-                case OpCode::enter_try:
-                    current_frame.push_catch_ip(instr.get_arg(0));
-                    break;
-                case OpCode::exit_try:
-                    current_frame.pop_catch_ip();
-                    current_frame.set_instruction_pointer(instr.get_arg(0));
-                    break;
-                case OpCode::throw_exc:
-                    throw current_frame.pop_ds();
-                case OpCode::get_iter: {
-                    // Check if the object on the data stack implements the methods
-                    // in the iterator protocol.
-                    Object* peek = current_frame.peek_ds();
-                    if (peek->has_property(magic_methods::cur) &&
-                        peek->has_property(magic_methods::done) &&
-                        peek->has_property(magic_methods::next)) {
-                        // nop
-                    } else {
-                        current_frame.push_ds(call_method0<Object>(current_frame.pop_ds(), magic_methods::iter, process));
-                    }
-                    break;
+            }
+            DISPATCH();
+            TARGET(set_prop) {
+                Value obj = current_frame.peek_ds(0);
+                Value key = current_frame.peek_ds(1);
+                Value val = current_frame.peek_ds(2);
+                set_property(obj.to_object(process), key.as_atom(), val, current_frame.get_inline_cache(instr - instrs), process);
+                current_frame.drop_n_ds(3);
+                if (instr->args[0]) {
+                    current_frame.push_ds(obj);
                 }
-                case OpCode::iter_cur:
-                    current_frame.push_ds(call_method0<Object>(current_frame.peek_ds(), magic_methods::cur, process));
-                    break;
-                case OpCode::iter_done: {
-                    Object* iter = current_frame.peek_ds();
-                    Boolean* done = call_method0<Boolean>(iter, magic_methods::done, process);
-                    if (done->get_native_value()) {
-                        current_frame.pop_ds();
-                    }
-                    current_frame.push_ds(done);
-                    break;
+            }
+            DISPATCH();
+            TARGET(self)
+                current_frame.push_ds(current_frame.get_receiver());
+                DISPATCH();
+            TARGET(enter_try)
+                current_frame.push_catch_ip(instr->args[0]);
+                DISPATCH();
+            TARGET(exit_try)
+                current_frame.pop_catch_ip();
+                JUMP(instr->args[0]);
+                DISPATCH();
+            TARGET(throw_exc)
+                throw current_frame.pop_ds().to_object(process);
+            TARGET(get_iter) {
+                // Check if the object on the data stack implements the methods
+                // in the iterator protocol.
+                Value peek = current_frame.peek_ds();
+                if (has_property(peek, magic_methods::cur, process) &&
+                    has_property(peek, magic_methods::done, process) &&
+                    has_property(peek, magic_methods::next, process)) {
+                    // nop
+                } else {
+                    current_frame.push_ds(call_method0<Value>(current_frame.pop_ds(), magic_methods::iter, process));
                 }
-                case OpCode::iter_next:
-                    current_frame.push_ds(call_method0<Object>(current_frame.peek_ds(), magic_methods::next, process));
-                    break;
-                case OpCode::ldgbl: {
-                    const std::string& name = current_frame.get_code()->get_global_name(
-                        instr.get_arg(0));
-                    Object* global = current_frame.get_global(name);
-                    if (global == nullptr) global = NONE;
-                    current_frame.push_ds(global);
-                    break;
+            }
+            DISPATCH();
+            TARGET(iter_cur)
+                current_frame.push_ds(call_method0<Value>(current_frame.peek_ds(), magic_methods::cur, process));
+                DISPATCH();
+            TARGET(iter_done) {
+                Value iter = current_frame.peek_ds();
+                bool done = call_method0<bool>(iter, magic_methods::done, process);
+                if (done) {
+                    current_frame.pop_ds();
                 }
-                case OpCode::stgbl: {
-                    const std::string& name = current_frame.get_code()->get_global_name(
-                        instr.get_arg(0));
-                    Object* val = current_frame.pop_ds();
-                    current_frame.set_global(name, val);
-                    break;
+                current_frame.push_ds(BOOLEAN(done));
+            }
+            DISPATCH();
+            TARGET(iter_next)
+                current_frame.push_ds(call_method0<Value>(current_frame.peek_ds(), magic_methods::next, process));
+                DISPATCH();
+            TARGET(ldgbl) {
+                Atom name = code->get_global_atom(instr->args[0]);
+                Value global = current_frame.get_global(name);
+                if (!global) global = NONE;
+                current_frame.push_ds(global);
+            }
+            DISPATCH();
+            TARGET(stgbl) {
+                Atom name = code->get_global_atom(instr->args[0]);
+                current_frame.set_global(name, current_frame.peek_ds());
+                current_frame.pop_ds();
+            }
+            DISPATCH();
+            TARGET(ldloc) {
+                Value local = current_frame.get_local(instr->args[0]);
+                if (!local) local = NONE;
+                current_frame.push_ds(local);
+            }
+            DISPATCH();
+            TARGET(stloc)
+                current_frame.set_local(instr->args[0], current_frame.peek_ds());
+                current_frame.pop_ds();
+                DISPATCH();
+            TARGET(ldlocs)
+                if (!current_frame.get_locals()) {
+                    current_frame.materialize_locals(ALLOC_OBJECT());
                 }
-                case OpCode::ldloc: {
-                    const std::string& name = current_frame.get_code()->get_local_name(
-                        instr.get_arg(0));
-                    Object* local = current_frame.get_local(name);
-                    if (local == nullptr) local = NONE;
-                    current_frame.push_ds(local);
-                    break;
+                current_frame.push_ds(current_frame.get_locals());
+                DISPATCH();
+            TARGET(ldgbls)
+                current_frame.push_ds(current_frame.get_globals());
+                DISPATCH();
+            TARGET(import) {
+                const std::string& name = code->get_import_name(
+                    instr->args[0]);
+                current_frame.push_ds(import_module(name, process));
+            }
+            DISPATCH();
+            TARGET(get_prop_str) {
+                Value obj = current_frame.pop_ds();
+                Atom key = code->get_str_atom(instr->args[0]);
+                if (Value val = get_property(obj, key, current_frame.get_inline_cache(instr - instrs), process)) {
+                    if (instr->args[1]) {
+                        current_frame.push_ds(obj);
+                    }
+                    current_frame.push_ds(val);
+                } else {
+                    throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
                 }
-                case OpCode::stloc: {
-                    const std::string& name = current_frame.get_code()->get_local_name(
-                        instr.get_arg(0));
-                    current_frame.set_local(name, current_frame.pop_ds());
-                    break;
+            }
+            DISPATCH();
+            TARGET(set_prop_str) {
+                Value obj = current_frame.peek_ds(0);
+                Value val = current_frame.peek_ds(1);
+                Atom key = code->get_str_atom(instr->args[0]);
+                set_property(obj.to_object(process), key, val, current_frame.get_inline_cache(instr - instrs), process);
+                current_frame.drop_n_ds(2);
+                if (instr->args[1]) {
+                    current_frame.push_ds(obj);
                 }
-                case OpCode::ldlocs:
-                    current_frame.push_ds(current_frame.get_locals());
-                    break;
-                case OpCode::ldgbls:
-                    current_frame.push_ds(current_frame.get_globals());
-                    break;
-                case OpCode::import: {
-                    const std::string& name = current_frame.get_code()->get_import_name(
-                        instr.get_arg(0));
-                    current_frame.push_ds(import_module(name, process));
-                    break;
+            }
+            DISPATCH();
+            TARGET(call_method) {
+                Value receiver = current_frame.pop_ds();
+                Atom key = code->get_str_atom(instr->args[0]);
+                Value method = get_property(receiver, key, current_frame.get_inline_cache(instr - instrs), process);
+                if (!method) {
+                    current_frame.drop_n_ds(instr->args[1]);
+                    throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
                 }
-                default:
-                    break;
+                current_frame.push_ds(call_obj_from_stack(method, receiver, instr->args[1], process));
+            }
+            DISPATCH();
+            TARGET(ldloc_get_prop) {
+                Value obj = current_frame.get_local(instr->args[0]);
+                if (!obj) obj = NONE;
+                Atom key = code->get_str_atom(instr->args[1]);
+                if (Value val = get_property(obj, key, current_frame.get_inline_cache(instr - instrs), process)) {
+                    current_frame.push_ds(val);
+                } else {
+                    throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
                 }
-            } catch (Object* exc) {
-                if (!current_frame.has_catch_ip()) {
-                    stack.pop_frame();
-                    throw;
+            }
+            DISPATCH();
+            TARGET(inc_local) {
+                Value local = current_frame.get_local(instr->args[0]);
+                double value = code->get_num_constant(instr->args[1]);
+                if (local.is_number() && process->get_native_objects().has_builtin_number_ops()) {
+                    current_frame.set_local(instr->args[0], NUMBER(local.get_number() + value));
+                } else {
+                    if (!local) local = NONE;
+                    current_frame.push_ds(NUMBER(value));
+                    current_frame.push_ds(local);
+                    execute_binary_op(OpCode::iadd, current_frame, process);
+                    current_frame.set_local(instr->args[0], current_frame.peek_ds());
+                    current_frame.pop_ds();
                 }
-
-                current_frame.set_instruction_pointer(current_frame.get_catch_ip());
-                current_frame.pop_catch_ip();
-                current_frame.push_ds(exc);
+            }
+            DISPATCH();
+            TARGET(mov)
+                store_operand(instr->args[0], load_operand(instr->args[1], current_frame, code), current_frame);
+                DISPATCH();
+            TARGET(radd)
+            TARGET(rsub)
+            TARGET(rmul)
+            TARGET(rdiv)
+            TARGET(rmod)
+            TARGET(req)
+            TARGET(rneq)
+            TARGET(rlt)
+            TARGET(rgt)
+            TARGET(rlte)
+            TARGET(rgte)
+            TARGET(rbit_or)
+            TARGET(rbit_xor)
+            TARGET(rbit_and)
+            TARGET(rbit_shl)
+            TARGET(rbit_shr)
+                execute_register_op(instr, current_frame, code, process);
+                DISPATCH();
+#ifndef COMPUTED_GOTO
+            default:
+                throw std::logic_error(fmt::format("invalid opcode: {0}", instr->op));
             }
         }
-
-        stack.pop_frame();
-        return NONE;
+#endif
     }
 
-    Object* Interpreter::execute_module(const std::string& module_name, Process* process) {
+#undef JUMP
+#undef POLL
+#undef DISPATCH
+#undef TARGET
+#undef COMPUTED_GOTO
+
+    Value Interpreter::execute_module(const std::string& module_name, Process* process) {
         std::shared_ptr<Code> code = CodeCache::get_or_load_code(module_name);
         Module* entry_module = process->get_heap().allocate<Module>(process, module_name, code);
         process->get_module_registry().add_module(entry_module);
-        Object* locals = ALLOC_OBJECT();
-
-        process->get_stack().push_frame(entry_module, entry_module->get_code(), entry_module, locals);
+        process->get_stack().push_frame(entry_module, entry_module->get_code(), entry_module);
 
         return execute(process);
     }
@@ -384,36 +504,132 @@ namespace emerald {
         bool created;
         Module* module = get_module(name, created, process); 
         if (created && !module->is_native()) {
-            Object* locals = ALLOC_OBJECT();
-            process->get_stack().push_frame(module, module->get_code(), module, locals);
+            process->get_stack().push_frame(module, module->get_code(), module);
             execute(process);
         }
 
         return module;
     }
 
+    Value Interpreter::get_property(Value obj, Atom name, Process* process) {
+        Shape::Property property;
+        if (Object* holder = get_property_holder(obj, process)->find_property_holder(name, property)) {
+            Value val = holder->get_slot(property.slot);
+            if (!property.accessor) {
+                return val;
+            }
+
+            return call_obj<Value>(static_cast<PropertyDescriptor*>(val.get_object())->get_getter(), obj, {}, process);
+        }
+
+        return Value();
+    }
+
+    Value Interpreter::get_property(Value obj, Atom name, InlineCache& cache, Process* process) {
+        Object* receiver = get_property_holder(obj, process);
+        size_t epoch = process->get_shape_tree().get_prototype_epoch();
+        bool accessor;
+        Value val = cache.lookup(receiver, name, epoch, accessor);
+        if (!val) {
+            Shape::Property property;
+            Object* holder = receiver->find_property_holder(name, property);
+            if (!holder) {
+                return Value();
+            }
+
+            val = holder->get_slot(property.slot);
+            accessor = property.accessor;
+            cache.add_lookup(receiver, name, holder, property, epoch);
+        }
+
+        if (!accessor) {
+            return val;
+        }
+
+        return call_obj<Value>(static_cast<PropertyDescriptor*>(val.get_object())->get_getter(), obj, {}, process);
+    }
+
+    void Interpreter::set_property(Object* obj, Atom name, Value val, InlineCache& cache, Process* process) {
+        if (obj->is_watched() || obj->is_frozen()) {
+            obj->set_property(name, val);
+            return;
+        }
+
+        size_t slot;
+        if (cache.lookup_own(obj, name, slot)) {
+            obj->set_slot(slot, val);
+            return;
+        }
+
+        size_t epoch = process->get_shape_tree().get_prototype_epoch();
+        if (Shape* transition = cache.lookup_transition(obj, name, epoch)) {
+            obj->add_property(transition, val);
+            return;
+        }
+
+        Shape* shape = obj->get_shape();
+        Shape::Property property;
+        bool own = shape->lookup(name, property);
+        obj->set_property(name, val);
+        if (own && !property.accessor) {
+            cache.add_own(obj, name, property);
+        } else if (obj->get_shape()->get_parent() == shape) {
+            // The store added a property rather than running a setter, so
+            // the same transition can be taken while the prototypes agree.
+            cache.add_transition(shape, obj->get_parent(), name, obj->get_shape(), epoch);
+        }
+    }
+
+    bool Interpreter::has_property(Value obj, Atom name, Process* process) {
+        return get_property_holder(obj, process)->has_property(name);
+    }
+
     template <>
-    Object* Interpreter::call_obj<Object>(Object* obj, Object* receiver, const std::vector<Object*>& args, Process* process) {
+    Value Interpreter::call_obj<Value>(Value obj, Value receiver, const std::vector<Value>& args, Process* process) {
         Stack& stack = process->get_stack();
-        if (Function* func = dynamic_cast<Function*>(obj)) {
-            Object* locals = ALLOC_OBJECT();
-            stack.push_frame(receiver, func->get_code(), func->get_globals(), locals);
+        if (Function* func = obj.get_object_as<Function>()) {
+            stack.push_frame(receiver, func->get_code(), func->get_globals());
 
             Stack::Frame& current_frame = stack.peek();
-            for (Object* arg : iterutils::reverse(args)) {
+            for (Value arg : iterutils::reverse(args)) {
                 current_frame.push_ds(arg);
             }
 
             return execute(process);
-        } else if (NativeFunction* func = dynamic_cast<NativeFunction*>(obj)) {
+        } else if (NativeFunction* func = obj.get_object_as<NativeFunction>()) {
             return (*func)(receiver, args, func->get_globals());
-        } else if (Object* prop = obj->get_property(magic_methods::call)) {
-            return call_obj<Object>(prop, obj, args, process);
+        } else if (Value prop = get_property(obj, magic_methods::call, process)) {
+            return call_obj<Value>(prop, obj, args, process);
         } else {
             throw process->get_heap().allocate<Exception>(process, "object is not callable");
         }
     }
 
+    // The arguments are on top of the current frame's data stack, pushed in
+    // reverse. Functions take them in place as the start of their own data
+    // stack and natives read them in place; anything else gets them popped
+    // into a vector.
+    Value Interpreter::call_obj_from_stack(Value obj, Value receiver, size_t num_args, Process* process) {
+        Stack& stack = process->get_stack();
+        if (Function* func = obj.get_object_as<Function>()) {
+            stack.push_frame(receiver, func->get_code(), func->get_globals(), num_args);
+            return execute(process);
+        } else if (NativeFunction* func = obj.get_object_as<NativeFunction>()) {
+            Value res;
+            try {
+                res = func->invoke_from_stack(receiver, num_args, func->get_globals());
+            } catch (...) {
+                stack.peek().drop_n_ds(num_args);
+                throw;
+            }
+            stack.peek().drop_n_ds(num_args);
+            return res;
+        }
+
+        std::vector<Value> args = stack.peek().pop_n_ds(num_args);
+        return call_obj<Value>(obj, receiver, args, process);
+    }
+
     Module* Interpreter::get_module(const std::string& name, bool& created, Process* process) {
         ModuleRegistry& registry = process->get_module_registry();
         if (registry.has_module(name)) {
@@ -438,24 +654,241 @@ namespace emerald {
         return module;
     }
 
-    Object* Interpreter::new_obj(bool explicit_parent, size_t num_props, Process* process) {
+    Value Interpreter::new_obj(bool explicit_parent, size_t num_props, Process* process) {
         Stack::Frame& current_frame = process->get_stack().peek();
-        Object* receiver;
+        Value receiver;
         if (explicit_parent) {
             receiver = current_frame.pop_ds();
         } else {
             receiver = OBJECT_PROTOTYPE;
         }
 
-        Object* self = call_method0<Object>(receiver, magic_methods::clone, process);
+        Object* self = call_method0<Object*>(receiver, magic_methods::clone, process);
+
+        // The new object and its properties stay on the data stack until
+        // every property is stored, so collections can still reach them.
+        current_frame.push_ds(self);
         for (size_t i = 0; i < num_props; i++) {
-            Object* key = current_frame.pop_ds();
-            Object* val = current_frame.pop_ds();
+            Value key = current_frame.peek_ds(2 * i + 1);
+            Value val = current_frame.peek_ds(2 * i + 2);
 
-            self->set_property(key->as_str(), val); 
+            self->set_property(key.as_atom(), val); 
         }
+        current_frame.drop_n_ds(2 * num_props + 1);
 
         return self;
     }
 
+    void Interpreter::execute_binary_op(OpCode::Value op, Stack::Frame& frame, Process* process) {
+        Value lhs = frame.pop_ds();
+        Value rhs = frame.peek_ds();
+        Value res;
+
+        if (try_builtin_binary_op(op, lhs, rhs, res, process)) {
+            frame.pop_ds();
+            frame.push_ds(res);
+            return;
+        }
+
+        frame.push_ds(call_method1<Value>(lhs, get_binary_op_name(op), process));
+    }
+
+    void Interpreter::execute_register_op(const Code::PackedInstruction* instr, Stack::Frame& frame, const Code* code, Process* process) {
+        OpCode::Value op = get_stack_op(instr->op);
+        Value lhs = load_operand(instr->args[1], frame, code);
+        Value rhs = load_operand(instr->args[2], frame, code);
+        Value res;
+
+        if (!try_builtin_binary_op(op, lhs, rhs, res, process)) {
+            frame.push_ds(rhs);
+            res = call_method1<Value>(lhs, get_binary_op_name(op), process);
+        }
+
+        store_operand(instr->args[0], res, frame);
+    }
+
+    Value Interpreter::load_operand(uint32_t operand, Stack::Frame& frame, const Code* code) {
+        if (Code::Operand::is_constant(operand)) {
+            return NUMBER(code->get_num_constant(Code::Operand::get_id(operand)));
+        } else if (Code::Operand::is_data_stack(operand)) {
+            return frame.pop_ds();
+        }
+
+        Value val = frame.get_local(operand);
+        return val ? val : NONE;
+    }
+
+    void Interpreter::store_operand(uint32_t operand, Value val, Stack::Frame& frame) {
+        if (Code::Operand::is_data_stack(operand)) {
+            frame.push_ds(val);
+        } else {
+            frame.set_local(operand, val);
+        }
+    }
+
+    bool Interpreter::try_builtin_binary_op(OpCode::Value op, Value lhs, Value rhs, Value& res, Process* process) {
+        NativeObjects& native_objects = process->get_native_objects();
+        if (lhs.is_number() && rhs.is_number()) {
+            return native_objects.has_builtin_number_ops()
+                && try_number_binary_op(op, lhs.get_number(), rhs.get_number(), res);
+        } else if (lhs.is_object() && rhs.is_object() && native_objects.has_builtin_string_ops()) {
+            String* lhs_str = lhs.get_object_as<String>();
+            String* rhs_str = rhs.get_object_as<String>();
+            return is_builtin_string(lhs_str, process) && rhs_str
+                && try_string_binary_op(op, lhs_str, rhs_str, res, process);
+        }
+
+        return false;
+    }
+
+    bool Interpreter::try_number_binary_op(OpCode::Value op, double lhs, double rhs, Value& res) {
+        switch (op) {
+        case OpCode::add:
+        case OpCode::iadd:
+            res = Value::number(lhs + rhs);
+            return true;
+        case OpCode::sub:
+        case OpCode::isub:
+            res = Value::number(lhs - rhs);
+            return true;
+        case OpCode::mul:
+        case OpCode::imul:
+            res = Value::number(lhs * rhs);
+            return true;
+        case OpCode::div:
+        case OpCode::idiv:
+            res = Value::number(lhs / rhs);
+            return true;
+        case OpCode::mod:
+        case OpCode::imod:
+            if ((long)rhs == 0) {
+                return false;
+            }
+            res = Value::number((long)lhs % (long)rhs);
+            return true;
+        case OpCode::eq:
+            res = Value::boolean(lhs == rhs);
+            return true;
+        case OpCode::neq:
+            res = Value::boolean(lhs != rhs);
+            return true;
+        case OpCode::lt:
+            res = Value::boolean(lhs < rhs);
+            return true;
+        case OpCode::gt:
+            res = Value::boolean(lhs > rhs);
+            return true;
+        case OpCode::lte:
+            res = Value::boolean(lhs <= rhs);
+            return true;
+        case OpCode::gte:
+            res = Value::boolean(lhs >= rhs);
+            return true;
+        case OpCode::bit_or:
+            res = Value::number((long)lhs | (long)rhs);
+            return true;
+        case OpCode::bit_xor:
+            res = Value::number((long)lhs ^ (long)rhs);
+            return true;
+        case OpCode::bit_and:
+            res = Value::number((long)lhs & (long)rhs);
+            return true;
+        case OpCode::bit_shl:
+            res = Value::number((long)lhs << (long)rhs);
+            return true;
+        case OpCode::bit_shr:
+            res = Value::number((long)lhs >> (long)rhs);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Interpreter::try_string_binary_op(OpCode::Value op, const String* lhs, const String* rhs, Value& res, Process* process) {
+        switch (op) {
+        case OpCode::add:
+            res = ALLOC_STRING(lhs->get_native_value() + rhs->get_native_value());
+            return true;
+        case OpCode::eq:
+            res = Value::boolean(lhs->get_native_value() == rhs->get_native_value());
+            return true;
+        case OpCode::neq:
+            res = Value::boolean(lhs->get_native_value() != rhs->get_native_value());
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Interpreter::is_builtin_string(String* str, Process* process) {
+        // A string can only pick up different operators through its own
+        // properties or a user defined prototype.
+        return str
+            && str->get_parent() == STRING_PROTOTYPE
+            && str->num_properties() == 0;
+    }
+
+    Atom Interpreter::get_binary_op_name(OpCode::Value op) {
+        switch (op) {
+        case OpCode::add: return magic_methods::add;
+        case OpCode::sub: return magic_methods::sub;
+        case OpCode::mul: return magic_methods::mul;
+        case OpCode::div: return magic_methods::div;
+        case OpCode::mod: return magic_methods::mod;
+        case OpCode::iadd: return magic_methods::iadd;
+        case OpCode::isub: return magic_methods::isub;
+        case OpCode::imul: return magic_methods::imul;
+        case OpCode::idiv: return magic_methods::idiv;
+        case OpCode::imod: return magic_methods::imod;
+        case OpCode::eq: return magic_methods::eq;
+        case OpCode::neq: return magic_methods::neq;
+        case OpCode::lt: return magic_methods::lt;
+        case OpCode::gt: return magic_methods::gt;
+        case OpCode::lte: return magic_methods::lte;
+        case OpCode::gte: return magic_methods::gte;
+        case OpCode::bit_or: return magic_methods::bit_or;
+        case OpCode::bit_xor: return magic_methods::bit_xor;
+        case OpCode::bit_and: return magic_methods::bit_and;
+        case OpCode::bit_shl: return magic_methods::bit_shl;
+        case OpCode::bit_shr: return magic_methods::bit_shr;
+        default:
+            throw std::logic_error(fmt::format("not a binary operator: {0}", OpCode::get_string(op)));
+        }
+    }
+
+    OpCode::Value Interpreter::get_stack_op(OpCode::Value op) {
+        switch (op) {
+        case OpCode::radd: return OpCode::add;
+        case OpCode::rsub: return OpCode::sub;
+        case OpCode::rmul: return OpCode::mul;
+        case OpCode::rdiv: return OpCode::div;
+        case OpCode::rmod: return OpCode::mod;
+        case OpCode::req: return OpCode::eq;
+        case OpCode::rneq: return OpCode::neq;
+        case OpCode::rlt: return OpCode::lt;
+        case OpCode::rgt: return OpCode::gt;
+        case OpCode::rlte: return OpCode::lte;
+        case OpCode::rgte: return OpCode::gte;
+        case OpCode::rbit_or: return OpCode::bit_or;
+        case OpCode::rbit_xor: return OpCode::bit_xor;
+        case OpCode::rbit_and: return OpCode::bit_and;
+        case OpCode::rbit_shl: return OpCode::bit_shl;
+        case OpCode::rbit_shr: return OpCode::bit_shr;
+        default:
+            throw std::logic_error(fmt::format("not a binary register instruction: {0}", OpCode::get_string(op)));
+        }
+    }
+
+    Object* Interpreter::get_property_holder(Value obj, Process* process) {
+        if (obj.is_object()) {
+            return obj.get_object();
+        } else if (obj.is_number()) {
+            return NUMBER_PROTOTYPE;
+        }
+
+        // Booleans and None resolve through their singletons so properties
+        // set on them remain visible to every immediate of the same value.
+        return obj.to_object(process);
+    }
+
 } // namespace emerald
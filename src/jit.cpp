@@ -0,0 +1,1513 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+
+#include "emerald/interpreter.h"
+#include "emerald/jit.h"
+#include "emerald/module.h"
+#include "emerald/objectutils.h"
+
+#ifdef EMERALD_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace emerald {
+
+    namespace {
+
+        // How native code was left, helpers for conditional jumps return
+        // TAKEN when the jump is taken. Code that returned leaves the value
+        // on top of its data stack.
+        enum Status : uint32_t {
+            CONTINUE = 0,
+            TAKEN = 1,
+            RETURNED = 2,
+            THREW = 3
+        };
+
+    } // namespace
+
+    JitCode::JitCode(uint8_t* memory, size_t size, std::vector<uint32_t> entries)
+        : _memory(memory),
+        _size(size),
+        _entries(std::move(entries)) {}
+
+    JitCode::~JitCode() {
+#ifdef EMERALD_JIT
+        munmap(_memory, _size);
+#endif
+    }
+
+    JitCode::Function JitCode::get_function() const {
+        return reinterpret_cast<Function>(_memory);
+    }
+
+    const uint8_t* JitCode::get_entry(size_t ip) const {
+        return _memory + _entries[ip];
+    }
+
+    size_t JitCode::get_size() const {
+        return _size;
+    }
+
+    // The instructions the JIT supports, each performed the same way as
+    // in Interpreter::execute_frame. Native code calls them for whatever it
+    // doesn't do inline, and when its inline fast path doesn't apply.
+    struct JitHelpers {
+        using Helper = uint32_t (*)(
+            Stack::Frame* frame,
+            Process* process,
+            const Code* code,
+            const Code::PackedInstruction* instr);
+
+        static Helper get(OpCode::Value op);
+
+        static OpCode::Value get_stack_op(OpCode::Value op) {
+            return Interpreter::get_stack_op(op);
+        }
+
+        template <uint32_t (*F)(Stack::Frame&, Process*, const Code*, const Code::PackedInstruction*)>
+        static uint32_t guard(
+            Stack::Frame* frame,
+            Process* process,
+            const Code* code,
+            const Code::PackedInstruction* instr) {
+            // Exceptions can't unwind through native code, which has no
+            // unwind information, so they are held on the process and
+            // rethrown once the native code has returned.
+            frame->set_current_instruction(instr);
+            try {
+                return F(*frame, process, code, instr);
+            } catch (...) {
+                process->get_jit_exception() = std::current_exception();
+                return THREW;
+            }
+        }
+
+#define JIT_HELPER(name) \
+    static uint32_t name([[maybe_unused]] Stack::Frame& frame, [[maybe_unused]] Process* process, \
+        [[maybe_unused]] const Code* code, [[maybe_unused]] const Code::PackedInstruction* instr)
+
+        JIT_HELPER(poll_profiler) {
+            process->get_profiler().take_sample(process->get_stack());
+            return CONTINUE;
+        }
+
+        JIT_HELPER(preempt) {
+            Scheduler::preempt(process);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(jmp_true) {
+            return Interpreter::call_method0<bool>(frame.pop_ds(), magic_methods::boolean, process) ? TAKEN : CONTINUE;
+        }
+
+        JIT_HELPER(jmp_true_or_pop) {
+            if (Interpreter::call_method0<bool>(frame.peek_ds(), magic_methods::boolean, process)) {
+                return TAKEN;
+            }
+
+            frame.pop_ds();
+            return CONTINUE;
+        }
+
+        JIT_HELPER(jmp_false) {
+            return Interpreter::call_method0<bool>(frame.pop_ds(), magic_methods::boolean, process) ? CONTINUE : TAKEN;
+        }
+
+        JIT_HELPER(jmp_false_or_pop) {
+            if (!Interpreter::call_method0<bool>(frame.peek_ds(), magic_methods::boolean, process)) {
+                return TAKEN;
+            }
+
+            frame.pop_ds();
+            return CONTINUE;
+        }
+
+        JIT_HELPER(jmp_data) {
+            return frame.num_ds() ? TAKEN : CONTINUE;
+        }
+
+        JIT_HELPER(nop) {
+            return CONTINUE;
+        }
+
+        JIT_HELPER(pop) {
+            frame.drop_n_ds(instr->args[0]);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(neg) {
+            frame.push_ds(Interpreter::call_method0<Value>(frame.pop_ds(), magic_methods::neg, process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(log_neg) {
+            frame.push_ds(BOOLEAN(!Interpreter::call_method0<bool>(frame.pop_ds(), magic_methods::boolean, process)));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(binary_op) {
+            Interpreter::execute_binary_op(instr->op, frame, process);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(bit_not) {
+            frame.push_ds(Interpreter::call_method0<Value>(frame.pop_ds(), magic_methods::bit_not, process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(str) {
+            frame.push_ds(Interpreter::call_method0<String*>(frame.pop_ds(), magic_methods::str, process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(boolean) {
+            frame.push_ds(BOOLEAN(Interpreter::call_method0<bool>(frame.pop_ds(), magic_methods::boolean, process)));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(call) {
+            Value obj = frame.pop_ds();
+            Value receiver;
+            if (instr->args[0]) {
+                receiver = frame.pop_ds();
+            } else {
+                receiver = frame.get_globals();
+            }
+            frame.push_ds(Interpreter::call_obj_from_stack(obj, receiver, instr->args[1], process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_obj) {
+            frame.push_ds(Interpreter::new_obj(instr->args[0], instr->args[1], process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(init) {
+            Value receiver = frame.pop_ds();
+            Interpreter::call_method<Value>(receiver, magic_methods::init, instr->args[0], process);
+            frame.push_ds(receiver);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_func) {
+            Function* func = process->get_heap().allocate<Function>(
+                process,
+                code->get_func(instr->args[0]),
+                frame.get_globals());
+            frame.push_ds(func);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_num) {
+            frame.push_ds(NUMBER(code->get_num_constant(instr->args[0])));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_str) {
+            Atom value = code->get_str_atom(instr->args[0]);
+            frame.push_ds(process->get_heap().allocate<String>(process, STRING_PROTOTYPE, value));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_boolean) {
+            frame.push_ds(BOOLEAN(instr->args[0]));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(new_arr) {
+            Array* array = ALLOC_EMPTY_ARRAY();
+            for (size_t i = 0; i < instr->args[0]; i++) {
+                array->push(frame.pop_ds());
+            }
+            frame.push_ds(array);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(null) {
+            frame.push_ds(NONE);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(def_accessor_prop) {
+            Value obj = frame.peek_ds(0);
+            Value key = frame.peek_ds(1);
+            Object* getter = frame.peek_ds(2).to_object(process);
+            Object* setter = instr->args[0] ? frame.peek_ds(3).to_object(process) : nullptr;
+            PropertyDescriptor* descriptor = ALLOC_PROP_ACC_DESC(getter, setter);
+            obj.to_object(process)->define_property(key.as_atom(), descriptor);
+            frame.drop_n_ds(instr->args[0] ? 4 : 3);
+            if (instr->args[1]) {
+                frame.push_ds(obj);
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(def_data_prop) {
+            Value obj = frame.peek_ds(0);
+            Value key = frame.peek_ds(1);
+            Value val = frame.peek_ds(2);
+            obj.to_object(process)->define_property(key.as_atom(), val);
+            frame.drop_n_ds(3);
+            if (instr->args[0]) {
+                frame.push_ds(obj);
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(get_prop) {
+            Value obj = frame.pop_ds();
+            Value key = frame.pop_ds();
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Value val = Interpreter::get_property(obj, key.as_atom(), cache, process);
+            if (!val) {
+                throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.as_str()));
+            }
+
+            if (instr->args[0]) {
+                frame.push_ds(obj);
+            }
+            frame.push_ds(val);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(set_prop) {
+            Value obj = frame.peek_ds(0);
+            Value key = frame.peek_ds(1);
+            Value val = frame.peek_ds(2);
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Interpreter::set_property(obj.to_object(process), key.as_atom(), val, cache, process);
+            frame.drop_n_ds(3);
+            if (instr->args[0]) {
+                frame.push_ds(obj);
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(self) {
+            frame.push_ds(frame.get_receiver());
+            return CONTINUE;
+        }
+
+        JIT_HELPER(enter_try) {
+            frame.push_catch_ip(instr->args[0]);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(exit_try) {
+            frame.pop_catch_ip();
+            return CONTINUE;
+        }
+
+        JIT_HELPER(throw_exc) {
+            throw frame.pop_ds().to_object(process);
+        }
+
+        JIT_HELPER(get_iter) {
+            Value peek = frame.peek_ds();
+            if (!Interpreter::has_property(peek, magic_methods::cur, process) ||
+                !Interpreter::has_property(peek, magic_methods::done, process) ||
+                !Interpreter::has_property(peek, magic_methods::next, process)) {
+                frame.push_ds(Interpreter::call_method0<Value>(frame.pop_ds(), magic_methods::iter, process));
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(iter_cur) {
+            frame.push_ds(Interpreter::call_method0<Value>(frame.peek_ds(), magic_methods::cur, process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(iter_done) {
+            bool done = Interpreter::call_method0<bool>(frame.peek_ds(), magic_methods::done, process);
+            if (done) {
+                frame.pop_ds();
+            }
+            frame.push_ds(BOOLEAN(done));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(iter_next) {
+            frame.push_ds(Interpreter::call_method0<Value>(frame.peek_ds(), magic_methods::next, process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(ldgbl) {
+            Value global = frame.get_global(code->get_global_atom(instr->args[0]));
+            frame.push_ds(global ? global : NONE);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(stgbl) {
+            frame.set_global(code->get_global_atom(instr->args[0]), frame.peek_ds());
+            frame.pop_ds();
+            return CONTINUE;
+        }
+
+        JIT_HELPER(ldloc) {
+            Value local = frame.get_local(instr->args[0]);
+            frame.push_ds(local ? local : NONE);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(stloc) {
+            frame.set_local(instr->args[0], frame.peek_ds());
+            frame.pop_ds();
+            return CONTINUE;
+        }
+
+        JIT_HELPER(ldlocs) {
+            if (!frame.get_locals()) {
+                frame.materialize_locals(ALLOC_OBJECT());
+            }
+            frame.push_ds(frame.get_locals());
+            return CONTINUE;
+        }
+
+        JIT_HELPER(ldgbls) {
+            frame.push_ds(frame.get_globals());
+            return CONTINUE;
+        }
+
+        JIT_HELPER(get_prop_str) {
+            Value obj = frame.pop_ds();
+            Atom key = code->get_str_atom(instr->args[0]);
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Value val = Interpreter::get_property(obj, key, cache, process);
+            if (!val) {
+                throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
+            }
+
+            if (instr->args[1]) {
+                frame.push_ds(obj);
+            }
+            frame.push_ds(val);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(set_prop_str) {
+            Value obj = frame.peek_ds(0);
+            Value val = frame.peek_ds(1);
+            Atom key = code->get_str_atom(instr->args[0]);
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Interpreter::set_property(obj.to_object(process), key, val, cache, process);
+            frame.drop_n_ds(2);
+            if (instr->args[1]) {
+                frame.push_ds(obj);
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(call_method) {
+            Value receiver = frame.pop_ds();
+            Atom key = code->get_str_atom(instr->args[0]);
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Value method = Interpreter::get_property(receiver, key, cache, process);
+            if (!method) {
+                frame.drop_n_ds(instr->args[1]);
+                throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
+            }
+
+            frame.push_ds(Interpreter::call_obj_from_stack(method, receiver, instr->args[1], process));
+            return CONTINUE;
+        }
+
+        JIT_HELPER(ldloc_get_prop) {
+            Value obj = frame.get_local(instr->args[0]);
+            if (!obj) obj = NONE;
+            Atom key = code->get_str_atom(instr->args[1]);
+            InlineCache& cache = frame.get_inline_cache(instr - code->get_packed_instructions());
+            Value val = Interpreter::get_property(obj, key, cache, process);
+            if (!val) {
+                throw process->get_heap().allocate<Exception>(process, fmt::format("no such property: {0}", key.get_str()));
+            }
+
+            frame.push_ds(val);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(inc_local) {
+            Value local = frame.get_local(instr->args[0]);
+            double value = code->get_num_constant(instr->args[1]);
+            if (local.is_number() && process->get_native_objects().has_builtin_number_ops()) {
+                frame.set_local(instr->args[0], NUMBER(local.get_number() + value));
+            } else {
+                frame.push_ds(NUMBER(value));
+                frame.push_ds(local ? local : NONE);
+                Interpreter::execute_binary_op(OpCode::iadd, frame, process);
+                frame.set_local(instr->args[0], frame.peek_ds());
+                frame.pop_ds();
+            }
+            return CONTINUE;
+        }
+
+        JIT_HELPER(mov) {
+            Interpreter::store_operand(instr->args[0], Interpreter::load_operand(instr->args[1], frame, code), frame);
+            return CONTINUE;
+        }
+
+        JIT_HELPER(register_op) {
+            Interpreter::execute_register_op(instr, frame, code, process);
+            return CONTINUE;
+        }
+
+#undef JIT_HELPER
+    };
+
+    JitHelpers::Helper JitHelpers::get(OpCode::Value op) {
+        switch (op) {
+        case OpCode::nop: return guard<nop>;
+        case OpCode::jmp_true: return guard<jmp_true>;
+        case OpCode::jmp_true_or_pop: return guard<jmp_true_or_pop>;
+        case OpCode::jmp_false: return guard<jmp_false>;
+        case OpCode::jmp_false_or_pop: return guard<jmp_false_or_pop>;
+        case OpCode::jmp_data: return guard<jmp_data>;
+        case OpCode::pop: return guard<pop>;
+        case OpCode::neg: return guard<neg>;
+        case OpCode::log_neg: return guard<log_neg>;
+        case OpCode::add:
+        case OpCode::sub:
+        case OpCode::mul:
+        case OpCode::div:
+        case OpCode::mod:
+        case OpCode::iadd:
+        case OpCode::isub:
+        case OpCode::imul:
+        case OpCode::idiv:
+        case OpCode::imod:
+        case OpCode::eq:
+        case OpCode::neq:
+        case OpCode::lt:
+        case OpCode::gt:
+        case OpCode::lte:
+        case OpCode::gte:
+        case OpCode::bit_or:
+        case OpCode::bit_xor:
+        case OpCode::bit_and:
+        case OpCode::bit_shl:
+        case OpCode::bit_shr:
+            return guard<binary_op>;
+        case OpCode::bit_not: return guard<bit_not>;
+        case OpCode::str: return guard<str>;
+        case OpCode::boolean: return guard<boolean>;
+        case OpCode::call: return guard<call>;
+        case OpCode::new_obj: return guard<new_obj>;
+        case OpCode::init: return guard<init>;
+        case OpCode::new_func: return guard<new_func>;
+        case OpCode::new_num: return guard<new_num>;
+        case OpCode::new_str: return guard<new_str>;
+        case OpCode::new_boolean: return guard<new_boolean>;
+        case OpCode::new_arr: return guard<new_arr>;
+        case OpCode::null: return guard<null>;
+        case OpCode::def_accessor_prop: return guard<def_accessor_prop>;
+        case OpCode::def_data_prop: return guard<def_data_prop>;
+        case OpCode::get_prop: return guard<get_prop>;
+        case OpCode::set_prop: return guard<set_prop>;
+        case OpCode::self: return guard<self>;
+        case OpCode::enter_try: return guard<enter_try>;
+        case OpCode::exit_try: return guard<exit_try>;
+        case OpCode::throw_exc: return guard<throw_exc>;
+        case OpCode::get_iter: return guard<get_iter>;
+        case OpCode::iter_cur: return guard<iter_cur>;
+        case OpCode::iter_done: return guard<iter_done>;
+        case OpCode::iter_next: return guard<iter_next>;
+        case OpCode::ldgbl: return guard<ldgbl>;
+        case OpCode::stgbl: return guard<stgbl>;
+        case OpCode::ldloc: return guard<ldloc>;
+        case OpCode::stloc: return guard<stloc>;
+        case OpCode::ldlocs: return guard<ldlocs>;
+        case OpCode::ldgbls: return guard<ldgbls>;
+        case OpCode::get_prop_str: return guard<get_prop_str>;
+        case OpCode::set_prop_str: return guard<set_prop_str>;
+        case OpCode::call_method: return guard<call_method>;
+        case OpCode::ldloc_get_prop: return guard<ldloc_get_prop>;
+        case OpCode::inc_local: return guard<inc_local>;
+        case OpCode::mov: return guard<mov>;
+        case OpCode::radd:
+        case OpCode::rsub:
+        case OpCode::rmul:
+        case OpCode::rdiv:
+        case OpCode::rmod:
+        case OpCode::req:
+        case OpCode::rneq:
+        case OpCode::rlt:
+        case OpCode::rgt:
+        case OpCode::rlte:
+        case OpCode::rgte:
+        case OpCode::rbit_or:
+        case OpCode::rbit_xor:
+        case OpCode::rbit_and:
+        case OpCode::rbit_shl:
+        case OpCode::rbit_shr:
+            return guard<register_op>;
+        // Imports only run in module code, which runs once.
+        default: return nullptr;
+        }
+    }
+
+#ifdef EMERALD_JIT
+    namespace {
+
+        // Called by native code when a push finds the data stack full. No
+        // exception can unwind through native code, so running out of
+        // memory here ends the program.
+        void push_value(std::vector<Value>* values, uint64_t bits) noexcept {
+            values->push_back(Value::from_bits(bits));
+        }
+
+        // Native code pushes and pops the data stack in place, which relies
+        // on a vector being its begin, end and capacity pointers in that
+        // order, as it is in libstdc++ and libc++. Without that layout code
+        // stays in the interpreter.
+        const int32_t VALUES_BEGIN = 0;
+        const int32_t VALUES_END = sizeof(Value*);
+        const int32_t VALUES_CAPACITY = 2 * sizeof(Value*);
+
+        bool has_vector_layout() {
+            std::vector<Value> values(2);
+            values.reserve(4);
+
+            Value* pointers[3];
+            if (sizeof(values) != sizeof(pointers)) {
+                return false;
+            }
+
+            std::memcpy(pointers, static_cast<const void*>(&values), sizeof(pointers));
+            return pointers[0] == values.data()
+                && pointers[1] == values.data() + values.size()
+                && pointers[2] == values.data() + values.capacity();
+        }
+
+        enum Register : uint8_t {
+            RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+            R8, R9, R10, R11, R12, R13, R14, R15
+        };
+
+        enum FloatRegister : uint8_t {
+            XMM0,
+            XMM1
+        };
+
+        // Conditions come in pairs that differ in their lowest bit, one the
+        // negation of the other.
+        enum Condition : uint8_t {
+            BELOW = 0x2,
+            ABOVE_OR_EQUAL = 0x3,
+            EQUAL = 0x4,
+            NOT_EQUAL = 0x5,
+            BELOW_OR_EQUAL = 0x6,
+            ABOVE = 0x7,
+            PARITY = 0xa,
+            NO_PARITY = 0xb
+        };
+
+        Condition negate(Condition condition) {
+            return static_cast<Condition>(condition ^ 1);
+        }
+
+        // The scalar double instructions taking two registers.
+        enum FloatOp : uint8_t {
+            ADDSD = 0x58,
+            MULSD = 0x59,
+            SUBSD = 0x5c,
+            DIVSD = 0x5e
+        };
+
+        // Just enough of an x86-64 assembler for JitCompiler. Jumps are
+        // emitted with 32 bit displacements that are patched once every
+        // instruction's offset is known. Memory operands are a base register
+        // and a displacement. Instructions on bytes only take rax to rbx.
+        class Assembler {
+        public:
+            const std::vector<uint8_t>& get_buffer() const { return _buffer; }
+            uint32_t get_offset() const { return _buffer.size(); }
+
+            void emit(std::initializer_list<uint8_t> bytes) {
+                _buffer.insert(_buffer.end(), bytes);
+            }
+
+            void emit_imm32(uint32_t imm) {
+                uint8_t bytes[sizeof(imm)];
+                std::memcpy(bytes, &imm, sizeof(imm));
+                _buffer.insert(_buffer.end(), bytes, bytes + sizeof(imm));
+            }
+
+            void emit_imm64(uint64_t imm) {
+                uint8_t bytes[sizeof(imm)];
+                std::memcpy(bytes, &imm, sizeof(imm));
+                _buffer.insert(_buffer.end(), bytes, bytes + sizeof(imm));
+            }
+
+            void push(Register reg) {
+                emit_rex(false, 0, reg);
+                emit({ static_cast<uint8_t>(0x50 | (reg & 7)) });
+            }
+
+            void pop(Register reg) {
+                emit_rex(false, 0, reg);
+                emit({ static_cast<uint8_t>(0x58 | (reg & 7)) });
+            }
+
+            void mov(Register dst, Register src) { emit_rr(true, { 0x89 }, src, dst); }
+
+            void mov_imm(Register dst, uint64_t imm) {
+                emit_rex(true, 0, dst);
+                emit({ static_cast<uint8_t>(0xb8 | (dst & 7)) });
+                emit_imm64(imm);
+            }
+
+            void mov_imm32(Register dst, uint32_t imm) {
+                emit_rex(false, 0, dst);
+                emit({ static_cast<uint8_t>(0xb8 | (dst & 7)) });
+                emit_imm32(imm);
+            }
+
+            void load(Register dst, Register base, int32_t disp) { emit_mem(true, { 0x8b }, dst, base, disp); }
+            void store(Register base, int32_t disp, Register src) { emit_mem(true, { 0x89 }, src, base, disp); }
+
+            void add(Register dst, Register src) { emit_rr(true, { 0x01 }, src, dst); }
+            void and_(Register dst, Register src) { emit_rr(true, { 0x21 }, src, dst); }
+            void or_(Register dst, Register src) { emit_rr(true, { 0x09 }, src, dst); }
+            void xor_(Register dst, Register src) { emit_rr(true, { 0x31 }, src, dst); }
+            void cmp(Register lhs, Register rhs) { emit_rr(true, { 0x39 }, rhs, lhs); }
+            void cmp(Register lhs, Register base, int32_t disp) { emit_mem(true, { 0x3b }, lhs, base, disp); }
+            void test(Register lhs, Register rhs) { emit_rr(true, { 0x85 }, rhs, lhs); }
+            void test32(Register lhs, Register rhs) { emit_rr(false, { 0x85 }, rhs, lhs); }
+            void cmov(Condition condition, Register dst, Register src) {
+                emit_rr(true, { 0x0f, static_cast<uint8_t>(0x40 | condition) }, dst, src);
+            }
+
+            void add_imm(Register dst, int32_t imm) {
+                emit_rr(true, { 0x81 }, 0, dst);
+                emit_imm32(imm);
+            }
+
+            void or_imm(Register dst, int8_t imm) {
+                emit_rr(true, { 0x83 }, 1, dst);
+                emit({ static_cast<uint8_t>(imm) });
+            }
+
+            void cmp32_imm(Register lhs, int8_t imm) {
+                emit_rr(false, { 0x83 }, 7, lhs);
+                emit({ static_cast<uint8_t>(imm) });
+            }
+
+            // Subtract from the quad word, double word and compare the byte
+            // in memory.
+            void sub_mem(Register base, int32_t disp, int32_t imm) {
+                emit_mem(true, { 0x81 }, 5, base, disp);
+                emit_imm32(imm);
+            }
+
+            void sub_mem32(Register base, int32_t disp, int8_t imm) {
+                emit_mem(false, { 0x83 }, 5, base, disp);
+                emit({ static_cast<uint8_t>(imm) });
+            }
+
+            void cmp_mem8(Register base, int32_t disp, int8_t imm) {
+                emit_mem(false, { 0x80 }, 7, base, disp);
+                emit({ static_cast<uint8_t>(imm) });
+            }
+
+            void set(Condition condition, Register dst) {
+                emit({ 0x0f, static_cast<uint8_t>(0x90 | condition), modrm(0, dst) });
+            }
+
+            void and8(Register dst, Register src) { emit({ 0x20, modrm(src, dst) }); }
+            void or8(Register dst, Register src) { emit({ 0x08, modrm(src, dst) }); }
+            void movzx8(Register dst, Register src) { emit({ 0x0f, 0xb6, modrm(dst, src) }); }
+
+            // rdx:rax = sign extended rax, then divides it by src, leaving
+            // the quotient in rax and the remainder in rdx.
+            void cqo() { emit({ 0x48, 0x99 }); }
+            void idiv(Register src) { emit_rr(true, { 0xf7 }, 7, src); }
+
+            // Shift dst by cl.
+            void shl(Register dst) { emit_rr(true, { 0xd3 }, 4, dst); }
+            void sar(Register dst) { emit_rr(true, { 0xd3 }, 7, dst); }
+
+            void movq(FloatRegister dst, Register src) {
+                emit({ 0x66 });
+                emit_rr(true, { 0x0f, 0x6e }, dst, src);
+            }
+
+            void movq(Register dst, FloatRegister src) {
+                emit({ 0x66 });
+                emit_rr(true, { 0x0f, 0x7e }, src, dst);
+            }
+
+            void float_op(FloatOp op, FloatRegister dst, FloatRegister src) {
+                emit({ 0xf2, 0x0f, op, modrm(dst, src) });
+            }
+
+            void ucomisd(FloatRegister lhs, FloatRegister rhs) {
+                emit({ 0x66, 0x0f, 0x2e, modrm(lhs, rhs) });
+            }
+
+            // Converts between doubles and 64 bit integers, truncating
+            // towards zero.
+            void cvttsd2si(Register dst, FloatRegister src) {
+                emit({ 0xf2 });
+                emit_rr(true, { 0x0f, 0x2c }, dst, src);
+            }
+
+            void cvtsi2sd(FloatRegister dst, Register src) {
+                emit({ 0xf2 });
+                emit_rr(true, { 0x0f, 0x2a }, dst, src);
+            }
+
+            void call(Register target) { emit_rr(false, { 0xff }, 2, target); }
+            void jump(Register target) { emit_rr(false, { 0xff }, 4, target); }
+            void ret() { emit({ 0xc3 }); }
+
+            // Each returns the offset of the displacement to patch.
+            uint32_t jump() {
+                emit({ 0xe9 });
+                return emit_displacement();
+            }
+
+            uint32_t jump_if(Condition condition) {
+                emit({ 0x0f, static_cast<uint8_t>(0x80 | condition) });
+                return emit_displacement();
+            }
+
+            void patch(uint32_t at, uint32_t target) {
+                int32_t displacement = static_cast<int32_t>(target) - static_cast<int32_t>(at + 4);
+                std::memcpy(_buffer.data() + at, &displacement, sizeof(displacement));
+            }
+
+            void patch_here(uint32_t at) {
+                patch(at, get_offset());
+            }
+
+        private:
+            std::vector<uint8_t> _buffer;
+
+            static uint8_t modrm(uint8_t reg, uint8_t rm) {
+                return 0xc0 | ((reg & 7) << 3) | (rm & 7);
+            }
+
+            void emit_rex(bool wide, uint8_t reg, uint8_t rm) {
+                uint8_t rex = 0x40 | (wide << 3) | ((reg >> 3) << 2) | (rm >> 3);
+                if (rex != 0x40) {
+                    emit({ rex });
+                }
+            }
+
+            // An instruction on reg and the register rm, reg is the opcode
+            // extension for instructions that have one.
+            void emit_rr(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t rm) {
+                emit_rex(wide, reg, rm);
+                emit(opcode);
+                emit({ modrm(reg, rm) });
+            }
+
+            // An instruction on reg and [base + disp].
+            void emit_mem(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, Register base, int32_t disp) {
+                emit_rex(wide, reg, base);
+                emit(opcode);
+                emit({ static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)) });
+                if ((base & 7) == RSP) {
+                    emit({ 0x24 });
+                }
+                emit_imm32(disp);
+            }
+
+            uint32_t emit_displacement() {
+                uint32_t at = get_offset();
+                emit({ 0, 0, 0, 0 });
+                return at;
+            }
+        };
+
+        static_assert((Value::FALSE_BITS | 1) == Value::TRUE_BITS, "booleans are built from a comparison's result");
+
+        // Compiles a code object to a function with the JitCode::Function
+        // signature. Values are worked on in rax, rsi and rdi, with rcx, rdx
+        // and r8 as scratch. The context, frame, process, code, stack values
+        // and offset of the frame's locals are kept in callee saved
+        // registers, so they survive helper calls.
+        class JitCompiler {
+        public:
+            JitCompiler(const Code& code)
+                : _code(code),
+                _instrs(code.get_packed_instructions()),
+                _num_instrs(code.get_num_instructions() + 2),
+                _inline_locals(true) {
+                // Once ldlocs has moved a frame's locals to an object they
+                // are no longer in its slots, code that can do so leaves
+                // locals to the helpers.
+                for (size_t i = 0; i < _num_instrs; i++) {
+                    if (_instrs[i].op == OpCode::ldlocs) {
+                        _inline_locals = false;
+                    }
+                }
+            }
+
+            std::unique_ptr<JitCode> compile() {
+                emit_prologue();
+
+                std::vector<uint32_t> entries(_num_instrs);
+                for (size_t i = 0; i < _num_instrs; i++) {
+                    entries[i] = _asm.get_offset();
+                    if (!emit_instruction(i)) {
+                        return nullptr;
+                    }
+                }
+
+                uint32_t exit = _asm.get_offset();
+                emit_epilogue();
+
+                for (const auto& [at, target] : _jumps) {
+                    _asm.patch(at, target == EXIT ? exit : entries[target]);
+                }
+
+                return install(std::move(entries));
+            }
+
+        private:
+            static const size_t EXIT = SIZE_MAX;
+
+            static const Register CONTEXT = R14;
+            static const Register FRAME = RBX;
+            static const Register PROCESS = R12;
+            static const Register CODE = R13;
+            static const Register VALUES = R15;
+            static const Register LOCALS_OFFSET = RBP;
+
+            const Code& _code;
+            const Code::PackedInstruction* _instrs;
+            size_t _num_instrs;
+            bool _inline_locals;
+
+            Assembler _asm;
+            std::vector<std::pair<uint32_t, size_t>> _jumps;
+
+            void emit_prologue() {
+                _asm.push(RBP);
+                _asm.push(RBX);
+                _asm.push(R12);
+                _asm.push(R13);
+                _asm.push(R14);
+                _asm.push(R15);
+                _asm.emit({ 0x48, 0x83, 0xec, 0x08 });  // sub rsp, 8, to align calls
+                _asm.mov(CONTEXT, RDI);
+                _asm.load(FRAME, CONTEXT, offsetof(JitCode::Context, frame));
+                _asm.load(PROCESS, CONTEXT, offsetof(JitCode::Context, process));
+                _asm.load(CODE, CONTEXT, offsetof(JitCode::Context, code));
+                _asm.load(VALUES, CONTEXT, offsetof(JitCode::Context, values));
+                _asm.load(LOCALS_OFFSET, CONTEXT, offsetof(JitCode::Context, locals_offset));
+                _asm.jump(RSI);
+            }
+
+            void emit_epilogue() {
+                _asm.emit({ 0x48, 0x83, 0xc4, 0x08 });  // add rsp, 8
+                _asm.pop(R15);
+                _asm.pop(R14);
+                _asm.pop(R13);
+                _asm.pop(R12);
+                _asm.pop(RBX);
+                _asm.pop(RBP);
+                _asm.ret();
+            }
+
+            void emit_call(JitHelpers::Helper helper, const Code::PackedInstruction* instr) {
+                _asm.mov(RDI, FRAME);
+                _asm.mov(RSI, PROCESS);
+                _asm.mov(RDX, CODE);
+                _asm.mov_imm(RCX, reinterpret_cast<uint64_t>(instr));
+                _asm.mov_imm(RAX, reinterpret_cast<uint64_t>(helper));
+                _asm.call(RAX);
+                _asm.test32(RAX, RAX);
+            }
+
+            // Performs the instruction with its helper, leaving the code if
+            // it returned or threw.
+            void emit_helper(const Code::PackedInstruction* instr) {
+                emit_call(JitHelpers::get(instr->op), instr);
+                emit_jump_if(NOT_EQUAL, EXIT);
+            }
+
+            void emit_jump(size_t target) {
+                _jumps.emplace_back(_asm.jump(), target);
+            }
+
+            void emit_jump_if(Condition condition, size_t target) {
+                _jumps.emplace_back(_asm.jump_if(condition), target);
+            }
+
+            // Jumps from instruction i to target. Backward jumps poll the
+            // profiler and count a reduction, like the interpreter does on
+            // every jump.
+            void emit_goto(size_t i, size_t target) {
+                if (target <= i) {
+                    _asm.load(RAX, CONTEXT, offsetof(JitCode::Context, sample_requested));
+                    _asm.cmp_mem8(RAX, 0, 0);
+                    uint32_t no_sample = _asm.jump_if(EQUAL);
+                    emit_call(JitHelpers::guard<JitHelpers::poll_profiler>, _instrs + i);
+                    emit_jump_if(NOT_EQUAL, EXIT);
+                    _asm.patch_here(no_sample);
+                    _asm.load(RAX, CONTEXT, offsetof(JitCode::Context, reductions));
+                    _asm.sub_mem32(RAX, 0, 1);
+                    emit_jump_if(NOT_EQUAL, target);
+                    emit_call(JitHelpers::guard<JitHelpers::preempt>, _instrs + i);
+                    emit_jump_if(NOT_EQUAL, EXIT);
+                }
+                emit_jump(target);
+            }
+
+            void emit_goto_if(Condition condition, size_t i, size_t target) {
+                if (target > i) {
+                    emit_jump_if(condition, target);
+                } else {
+                    uint32_t not_taken = _asm.jump_if(negate(condition));
+                    emit_goto(i, target);
+                    _asm.patch_here(not_taken);
+                }
+            }
+
+            // Jumps to slow when the flag in the context is cleared.
+            void emit_check_flag(size_t offset, std::vector<uint32_t>& slow) {
+                _asm.load(RCX, CONTEXT, offset);
+                _asm.cmp_mem8(RCX, 0, 0);
+                slow.push_back(_asm.jump_if(EQUAL));
+            }
+
+            void emit_peek(Register dst, size_t depth) {
+                _asm.load(RCX, VALUES, VALUES_END);
+                _asm.load(dst, RCX, -static_cast<int32_t>((depth + 1) * sizeof(Value)));
+            }
+
+            void emit_drop(size_t n) {
+                if (n) {
+                    _asm.sub_mem(VALUES, VALUES_END, n * sizeof(Value));
+                }
+            }
+
+            // Pushes src, which can't be rcx. There is known to be room when
+            // the instruction has dropped a value.
+            void emit_push(Register src, bool room) {
+                uint32_t has_room = 0;
+                uint32_t done = 0;
+                _asm.load(RCX, VALUES, VALUES_END);
+                if (!room) {
+                    _asm.cmp(RCX, VALUES, VALUES_CAPACITY);
+                    has_room = _asm.jump_if(NOT_EQUAL);
+                    _asm.mov(RSI, src);
+                    _asm.mov(RDI, VALUES);
+                    _asm.mov_imm(RAX, reinterpret_cast<uint64_t>(&push_value));
+                    _asm.call(RAX);
+                    done = _asm.jump();
+                    _asm.patch_here(has_room);
+                }
+                _asm.store(RCX, 0, src);
+                _asm.add_imm(RCX, sizeof(Value));
+                _asm.store(VALUES, VALUES_END, RCX);
+                if (!room) {
+                    _asm.patch_here(done);
+                }
+            }
+
+            // Leaves the address of the frame's local slots in rcx.
+            void emit_locals() {
+                _asm.load(RCX, VALUES, VALUES_BEGIN);
+                _asm.add(RCX, LOCALS_OFFSET);
+            }
+
+            void emit_load_local(Register dst, size_t id) {
+                emit_locals();
+                _asm.load(dst, RCX, id * sizeof(Value));
+            }
+
+            void emit_store_local(size_t id, Register src) {
+                emit_locals();
+                _asm.store(RCX, id * sizeof(Value), src);
+            }
+
+            // Locals that were never set read as null.
+            void emit_empty_to_null(Register reg) {
+                _asm.mov_imm(RCX, Value::NULL_BITS);
+                _asm.mov_imm(RDX, Value::EMPTY_BITS);
+                _asm.cmp(reg, RDX);
+                _asm.cmov(EQUAL, reg, RCX);
+            }
+
+            bool is_local(uint32_t operand) const {
+                return !Code::Operand::is_constant(operand) && !Code::Operand::is_data_stack(operand);
+            }
+
+            // Loads an operand of a register instruction without consuming
+            // it, data stack operands are counted in depth. Locals that were
+            // never set are left empty.
+            void emit_load_operand(Register dst, uint32_t operand, size_t& depth) {
+                if (Code::Operand::is_constant(operand)) {
+                    double value = _code.get_num_constant(Code::Operand::get_id(operand));
+                    _asm.mov_imm(dst, Value::number(value).get_bits());
+                } else if (Code::Operand::is_data_stack(operand)) {
+                    emit_peek(dst, depth++);
+                } else {
+                    emit_load_local(dst, operand);
+                }
+            }
+
+            void emit_store_operand(uint32_t operand, Register src, bool room) {
+                if (Code::Operand::is_data_stack(operand)) {
+                    emit_push(src, room);
+                } else {
+                    emit_store_local(operand, src);
+                }
+            }
+
+            // Jumps to slow unless the value in reg is a number.
+            void emit_check_number(Register reg, std::vector<uint32_t>& slow) {
+                _asm.mov(RDX, reg);
+                _asm.and_(RDX, R8);
+                _asm.cmp(RDX, R8);
+                slow.push_back(_asm.jump_if(EQUAL));
+            }
+
+            // Boxes the double in xmm0 into rax.
+            void emit_number_result() {
+                _asm.movq(RAX, XMM0);
+                _asm.mov_imm(RCX, Value::CANONICAL_NAN_BITS);
+                _asm.ucomisd(XMM0, XMM0);
+                _asm.cmov(PARITY, RAX, RCX);
+            }
+
+            // Boxes the flag in al into rax.
+            void emit_boolean_result() {
+                _asm.movzx8(RAX, RAX);
+                _asm.mov_imm(RCX, Value::FALSE_BITS);
+                _asm.or_(RAX, RCX);
+            }
+
+            // Boxes the 64 bit integer in rax into rax.
+            void emit_integer_result() {
+                _asm.cvtsi2sd(XMM0, RAX);
+                _asm.movq(RAX, XMM0);
+            }
+
+            // The binary operators, done inline when both operands are
+            // numbers and the Number prototype's operators are the builtin
+            // ones, as in Interpreter::try_number_binary_op.
+            void emit_binary_op(const Code::PackedInstruction* instr, OpCode::Value op, uint32_t lhs, uint32_t rhs, uint32_t dst) {
+                std::vector<uint32_t> slow;
+                size_t depth = 0;
+                emit_load_operand(RSI, lhs, depth);
+                emit_load_operand(RDI, rhs, depth);
+                emit_check_flag(offsetof(JitCode::Context, builtin_number_ops), slow);
+                _asm.mov_imm(R8, Value::QNAN);
+                if (!Code::Operand::is_constant(lhs)) {
+                    emit_check_number(RSI, slow);
+                }
+                if (!Code::Operand::is_constant(rhs)) {
+                    emit_check_number(RDI, slow);
+                }
+
+                _asm.movq(XMM0, RSI);
+                _asm.movq(XMM1, RDI);
+                switch (op) {
+                case OpCode::add:
+                case OpCode::iadd:
+                    _asm.float_op(ADDSD, XMM0, XMM1);
+                    emit_number_result();
+                    break;
+                case OpCode::sub:
+                case OpCode::isub:
+                    _asm.float_op(SUBSD, XMM0, XMM1);
+                    emit_number_result();
+                    break;
+                case OpCode::mul:
+                case OpCode::imul:
+                    _asm.float_op(MULSD, XMM0, XMM1);
+                    emit_number_result();
+                    break;
+                case OpCode::div:
+                case OpCode::idiv:
+                    _asm.float_op(DIVSD, XMM0, XMM1);
+                    emit_number_result();
+                    break;
+                case OpCode::mod:
+                case OpCode::imod:
+                    // A zero divisor is left to Number's __mod__.
+                    _asm.cvttsd2si(RCX, XMM1);
+                    _asm.test(RCX, RCX);
+                    slow.push_back(_asm.jump_if(EQUAL));
+                    _asm.cvttsd2si(RAX, XMM0);
+                    _asm.cqo();
+                    _asm.idiv(RCX);
+                    _asm.mov(RAX, RDX);
+                    emit_integer_result();
+                    break;
+                case OpCode::eq:
+                    _asm.ucomisd(XMM0, XMM1);
+                    _asm.set(EQUAL, RAX);
+                    _asm.set(NO_PARITY, RCX);
+                    _asm.and8(RAX, RCX);
+                    emit_boolean_result();
+                    break;
+                case OpCode::neq:
+                    _asm.ucomisd(XMM0, XMM1);
+                    _asm.set(NOT_EQUAL, RAX);
+                    _asm.set(PARITY, RCX);
+                    _asm.or8(RAX, RCX);
+                    emit_boolean_result();
+                    break;
+                case OpCode::lt:
+                    _asm.ucomisd(XMM1, XMM0);
+                    _asm.set(ABOVE, RAX);
+                    emit_boolean_result();
+                    break;
+                case OpCode::gt:
+                    _asm.ucomisd(XMM0, XMM1);
+                    _asm.set(ABOVE, RAX);
+                    emit_boolean_result();
+                    break;
+                case OpCode::lte:
+                    _asm.ucomisd(XMM1, XMM0);
+                    _asm.set(ABOVE_OR_EQUAL, RAX);
+                    emit_boolean_result();
+                    break;
+                case OpCode::gte:
+                    _asm.ucomisd(XMM0, XMM1);
+                    _asm.set(ABOVE_OR_EQUAL, RAX);
+                    emit_boolean_result();
+                    break;
+                default:
+                    _asm.cvttsd2si(RAX, XMM0);
+                    _asm.cvttsd2si(RCX, XMM1);
+                    switch (op) {
+                    case OpCode::bit_or: _asm.or_(RAX, RCX); break;
+                    case OpCode::bit_xor: _asm.xor_(RAX, RCX); break;
+                    case OpCode::bit_and: _asm.and_(RAX, RCX); break;
+                    case OpCode::bit_shl: _asm.shl(RAX); break;
+                    default: _asm.sar(RAX); break;
+                    }
+                    emit_integer_result();
+                    break;
+                }
+
+                emit_drop(depth);
+                emit_store_operand(dst, RAX, depth > 0);
+                uint32_t done = _asm.jump();
+
+                for (uint32_t at : slow) {
+                    _asm.patch_here(at);
+                }
+                emit_helper(instr);
+                _asm.patch_here(done);
+            }
+
+            // Conditional jumps on booleans are done inline while nothing
+            // has replaced their __boolean__.
+            void emit_branch(size_t i, const Code::PackedInstruction* instr) {
+                std::vector<uint32_t> slow;
+                size_t target = instr->args[0];
+                emit_peek(RAX, 0);
+                emit_check_flag(offsetof(JitCode::Context, builtin_boolean_ops), slow);
+                _asm.mov_imm(RDX, Value::TRUE_BITS);
+                _asm.mov(RCX, RAX);
+                _asm.or_imm(RCX, 1);
+                _asm.cmp(RCX, RDX);
+                slow.push_back(_asm.jump_if(NOT_EQUAL));
+
+                switch (instr->op) {
+                case OpCode::jmp_true:
+                    emit_drop(1);
+                    _asm.cmp(RAX, RDX);
+                    emit_goto_if(EQUAL, i, target);
+                    break;
+                case OpCode::jmp_false:
+                    emit_drop(1);
+                    _asm.cmp(RAX, RDX);
+                    emit_goto_if(NOT_EQUAL, i, target);
+                    break;
+                case OpCode::jmp_true_or_pop:
+                    _asm.cmp(RAX, RDX);
+                    emit_goto_if(EQUAL, i, target);
+                    emit_drop(1);
+                    break;
+                default:
+                    _asm.cmp(RAX, RDX);
+                    emit_goto_if(NOT_EQUAL, i, target);
+                    emit_drop(1);
+                    break;
+                }
+                emit_jump(i + 1);
+
+                for (uint32_t at : slow) {
+                    _asm.patch_here(at);
+                }
+                emit_helper_branch(i, instr);
+            }
+
+            // Performs a conditional jump with its helper.
+            void emit_helper_branch(size_t i, const Code::PackedInstruction* instr) {
+                emit_call(JitHelpers::get(instr->op), instr);
+                emit_jump_if(EQUAL, i + 1);
+                _asm.cmp32_imm(RAX, TAKEN);
+                emit_jump_if(NOT_EQUAL, EXIT);
+                emit_goto(i, instr->args[0]);
+            }
+
+            bool emit_instruction(size_t i) {
+                const Code::PackedInstruction* instr = _instrs + i;
+                switch (instr->op) {
+                case OpCode::jmp:
+                    emit_goto(i, instr->args[0]);
+                    return true;
+                case OpCode::jmp_true:
+                case OpCode::jmp_true_or_pop:
+                case OpCode::jmp_false:
+                case OpCode::jmp_false_or_pop:
+                    emit_branch(i, instr);
+                    return true;
+                case OpCode::jmp_data:
+                    emit_helper_branch(i, instr);
+                    return true;
+                case OpCode::exit_try:
+                    emit_helper(instr);
+                    emit_goto(i, instr->args[0]);
+                    return true;
+                case OpCode::ret:
+                    _asm.mov_imm32(RAX, RETURNED);
+                    emit_jump(EXIT);
+                    return true;
+                case OpCode::pop:
+                    emit_drop(instr->args[0]);
+                    return true;
+                case OpCode::null:
+                    _asm.mov_imm(RAX, Value::NULL_BITS);
+                    emit_push(RAX, false);
+                    return true;
+                case OpCode::new_boolean:
+                    _asm.mov_imm(RAX, Value::boolean(instr->args[0]).get_bits());
+                    emit_push(RAX, false);
+                    return true;
+                case OpCode::new_num:
+                    _asm.mov_imm(RAX, Value::number(_code.get_num_constant(instr->args[0])).get_bits());
+                    emit_push(RAX, false);
+                    return true;
+                case OpCode::ldloc:
+                    if (!_inline_locals) {
+                        break;
+                    }
+                    emit_load_local(RAX, instr->args[0]);
+                    emit_empty_to_null(RAX);
+                    emit_push(RAX, false);
+                    return true;
+                case OpCode::stloc:
+                    if (!_inline_locals) {
+                        break;
+                    }
+                    emit_peek(RAX, 0);
+                    emit_store_local(instr->args[0], RAX);
+                    emit_drop(1);
+                    return true;
+                case OpCode::add:
+                case OpCode::sub:
+                case OpCode::mul:
+                case OpCode::div:
+                case OpCode::mod:
+                case OpCode::iadd:
+                case OpCode::isub:
+                case OpCode::imul:
+                case OpCode::idiv:
+                case OpCode::imod:
+                case OpCode::eq:
+                case OpCode::neq:
+                case OpCode::lt:
+                case OpCode::gt:
+                case OpCode::lte:
+                case OpCode::gte:
+                case OpCode::bit_or:
+                case OpCode::bit_xor:
+                case OpCode::bit_and:
+                case OpCode::bit_shl:
+                case OpCode::bit_shr:
+                    emit_binary_op(instr, instr->op, Code::Operand::DATA_STACK, Code::Operand::DATA_STACK, Code::Operand::DATA_STACK);
+                    return true;
+                case OpCode::radd:
+                case OpCode::rsub:
+                case OpCode::rmul:
+                case OpCode::rdiv:
+                case OpCode::rmod:
+                case OpCode::req:
+                case OpCode::rneq:
+                case OpCode::rlt:
+                case OpCode::rgt:
+                case OpCode::rlte:
+                case OpCode::rgte:
+                case OpCode::rbit_or:
+                case OpCode::rbit_xor:
+                case OpCode::rbit_and:
+                case OpCode::rbit_shl:
+                case OpCode::rbit_shr:
+                    if (!_inline_locals && (is_local(instr->args[0]) || is_local(instr->args[1]) || is_local(instr->args[2]))) {
+                        break;
+                    }
+                    emit_binary_op(instr, JitHelpers::get_stack_op(instr->op), instr->args[1], instr->args[2], instr->args[0]);
+                    return true;
+                case OpCode::mov: {
+                    if (!_inline_locals && (is_local(instr->args[0]) || is_local(instr->args[1]))) {
+                        break;
+                    }
+                    size_t depth = 0;
+                    emit_load_operand(RAX, instr->args[1], depth);
+                    if (is_local(instr->args[1])) {
+                        emit_empty_to_null(RAX);
+                    }
+                    emit_drop(depth);
+                    emit_store_operand(instr->args[0], RAX, depth > 0);
+                    return true;
+                }
+                case OpCode::inc_local: {
+                    if (!_inline_locals) {
+                        break;
+                    }
+                    std::vector<uint32_t> slow;
+                    emit_load_local(RSI, instr->args[0]);
+                    emit_check_flag(offsetof(JitCode::Context, builtin_number_ops), slow);
+                    _asm.mov_imm(R8, Value::QNAN);
+                    emit_check_number(RSI, slow);
+                    _asm.movq(XMM0, RSI);
+                    _asm.mov_imm(RAX, Value::number(_code.get_num_constant(instr->args[1])).get_bits());
+                    _asm.movq(XMM1, RAX);
+                    _asm.float_op(ADDSD, XMM0, XMM1);
+                    emit_number_result();
+                    emit_store_local(instr->args[0], RAX);
+                    emit_jump(i + 1);
+                    for (uint32_t at : slow) {
+                        _asm.patch_here(at);
+                    }
+                    emit_helper(instr);
+                    return true;
+                }
+                default:
+                    break;
+                }
+
+                if (JitHelpers::get(instr->op)) {
+                    emit_helper(instr);
+                    return true;
+                }
+                return false;
+            }
+
+            std::unique_ptr<JitCode> install(std::vector<uint32_t> entries) {
+                const std::vector<uint8_t>& buffer = _asm.get_buffer();
+                size_t page_size = sysconf(_SC_PAGESIZE);
+                size_t size = (buffer.size() + page_size - 1) / page_size * page_size;
+                void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (memory == MAP_FAILED) {
+                    return nullptr;
+                }
+
+                std::memcpy(memory, buffer.data(), buffer.size());
+                if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+                    munmap(memory, size);
+                    return nullptr;
+                }
+
+                return std::make_unique<JitCode>(static_cast<uint8_t*>(memory), size, std::move(entries));
+            }
+        };
+
+    } // namespace
+#endif
+
+    std::atomic<bool> Jit::_enabled(false);
+    std::atomic<uint32_t> Jit::_threshold(Jit::DEFAULT_THRESHOLD);
+    std::atomic<size_t> Jit::_num_compiled(0);
+    std::mutex Jit::_mutex;
+
+    bool Jit::is_enabled() {
+        return _enabled.load();
+    }
+
+    void Jit::set_enabled(bool enabled) {
+        _enabled.store(enabled);
+    }
+
+    uint32_t Jit::get_threshold() {
+        return _threshold.load();
+    }
+
+    void Jit::set_threshold(uint32_t threshold) {
+        _threshold.store(threshold);
+    }
+
+    size_t Jit::get_num_compiled() {
+        return _num_compiled.load();
+    }
+
+    Value Jit::execute(const JitCode& jit_code, Stack::Frame& frame, Process* process) {
+        Stack& stack = process->get_stack();
+        NativeObjects& native_objects = process->get_native_objects();
+        JitCode::Context context = {
+            &frame,
+            process,
+            frame._code.get(),
+            &stack._values,
+            frame._locals_base * sizeof(Value),
+            &process->get_profiler().get_sample_flag(),
+            &process->get_task().reductions,
+            &native_objects._builtin_number_ops,
+            &native_objects._builtin_boolean_ops
+        };
+
+        uint32_t status = jit_code.get_function()(&context, jit_code.get_entry(frame.get_instruction_pointer()));
+        if (status == THREW) {
+            std::exception_ptr exc = process->get_jit_exception();
+            process->get_jit_exception() = nullptr;
+            std::rethrow_exception(exc);
+        }
+
+        Value ret = frame.pop_ds();
+        stack.pop_frame();
+        return ret;
+    }
+
+    const JitCode* Jit::compile(const Code& code) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (const JitCode* jit_code = code._jit_code.load(std::memory_order_acquire)) {
+            return jit_code;
+        }
+
+#ifdef EMERALD_JIT
+        static const bool supported = has_vector_layout();
+        if (supported && !code._jit_failed.load()) {
+            if (std::unique_ptr<JitCode> jit_code = JitCompiler(code).compile()) {
+                code._jit_code.store(jit_code.release(), std::memory_order_release);
+                _num_compiled++;
+                return code._jit_code.load(std::memory_order_relaxed);
+            }
+        }
+#endif
+
+        code._jit_failed.store(true);
+        return nullptr;
+    }
+
+} // namespace emerald
@@ -16,36 +16,121 @@
 */
 
 #include "emerald/mailbox.h"
-#include "emerald/object.h"
 
 namespace emerald {
 
-    void Mailbox::push_msg(Object* message) {
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _mailbox.push_back(message);
+    Mailbox::Mailbox(Process* process)
+        : _process(process),
+        _head(new Node{ Message(), nullptr }),
+        _waiting(false),
+        _size(0),
+        _max_size(0),
+        _num_received(0) {
+        _tail = _head.load();
+    }
+
+    Mailbox::~Mailbox() {
+        Node* node = _tail;
+        while (node) {
+            Node* next = node->next.load();
+            delete node;
+            node = next;
         }
+    }
+
+    void Mailbox::push_msg(Value message) {
+        push({ message, nullptr });
+    }
+
+    void Mailbox::push_msg(const ParcelRef& message) {
+        push({ Value(), message });
+    }
+
+    Value Mailbox::pop_msg() {
+        while (true) {
+            if (Value message = try_pop_msg()) return message;
 
-        _cv.notify_one();
+            if (prepare_to_park()) {
+                Scheduler::park(_process);
+            }
+
+            _waiting.store(false);
+        }
     }
 
-    Object* Mailbox::pop_msg() {
-        std::unique_lock<std::mutex> lock(_mutex);
-        while (_mailbox.empty()) _cv.wait(lock);
+    Value Mailbox::pop_msg(Scheduler::Clock::time_point deadline) {
+        while (true) {
+            if (Value message = try_pop_msg()) return message;
+            if (Scheduler::Clock::now() >= deadline) return Value();
 
-        Object* message = _mailbox.front();
-        _mailbox.pop_front();
+            if (prepare_to_park()) {
+                Scheduler::park_until(_process, deadline);
+            }
 
-        return message;
+            _waiting.store(false);
+        }
     }
 
-    std::vector<HeapManaged*> Mailbox::get_roots() {
-        std::vector<HeapManaged*> roots;
-        for (Object* msg : _mailbox) {
-            roots.push_back(msg);
+    Value Mailbox::try_pop_msg() {
+        if (_received.empty()) {
+            take_linked();
+            if (_received.empty()) return Value();
+        }
+
+        Message message = std::move(_received.front());
+        _received.pop_front();
+
+        _size--;
+        _num_received.fetch_add(1, std::memory_order_relaxed);
+
+        if (message.parcel) {
+            return message.parcel->unpack(_process);
         }
 
-        return roots;
+        return message.value;
+    }
+
+    size_t Mailbox::size() const {
+        return _size.load();
+    }
+
+    size_t Mailbox::get_max_size() const {
+        return _max_size.load();
+    }
+
+    size_t Mailbox::get_num_received() const {
+        return _num_received.load();
+    }
+
+    bool Mailbox::prepare_to_park() {
+        _waiting.store(true);
+        return _received.empty() && _tail->next.load() == nullptr;
+    }
+
+    void Mailbox::push(const Message& message) {
+        // Counted before the message is visible, so that the consumer
+        // never takes the size below zero.
+        size_t size = ++_size;
+        size_t max_size = _max_size.load(std::memory_order_relaxed);
+        while (size > max_size && !_max_size.compare_exchange_weak(max_size, size)) {}
+
+        Node* node = new Node{ message, nullptr };
+        Node* prev = _head.exchange(node);
+        prev->next.store(node);
+
+        if (_waiting.load() && _waiting.exchange(false)) {
+            Scheduler::wake(_process);
+        }
+    }
+
+    // Scanning the buffer is much cheaper than chasing the nodes, which
+    // matters when a burst of messages has built up.
+    void Mailbox::take_linked() {
+        while (Node* next = _tail->next.load()) {
+            _received.push_back(std::move(next->message));
+            delete _tail;
+            _tail = next;
+        }
     }
 
 } // namespace emerald
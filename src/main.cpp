@@ -26,9 +26,12 @@
 #include "emerald/colors.h"
 #include "emerald/compiler.h"
 #include "emerald/interpreter.h"
+#include "emerald/jit.h"
 #include "emerald/modules/init.h"
+#include "emerald/optimizer.h"
 #include "emerald/parser.h"
 #include "emerald/reporter.h"
+#include "emerald/scheduler.h"
 #include "emerald/source.h"
 #include "emerald/strutils.h"
 
@@ -65,6 +68,12 @@ int main(int argc, char** argv) {
     bool bytecode_save;
     bytecode->add_flag("-s,--save", bytecode_save, "indicates whether the bytecode should be persisted to desk");
 
+    bool bytecode_optimize = false;
+    bytecode->add_flag("-O,--optimize", bytecode_optimize, "indicates whether the bytecode should be optimized");
+
+    bool bytecode_stack_only = false;
+    bytecode->add_flag("--stack-only", bytecode_stack_only, "indicates whether register instructions should be left out");
+
     bytecode->callback([&]() {
         std::shared_ptr<emerald::Reporter> reporter = std::make_shared<emerald::Reporter>();
         std::filesystem::path path(bytecode_source_file);
@@ -78,12 +87,17 @@ int main(int argc, char** argv) {
 
         std::shared_ptr<emerald::Code> code = emerald::Compiler::compile(
             statements,
-            reporter);
+            reporter,
+            bytecode_stack_only);
         if (reporter->has_errors()) {
             reporter->print();
             return;
         }
 
+        if (bytecode_optimize) {
+            emerald::Optimizer::optimize(*code);
+        }
+
         if (bytecode_save) {
             code->write_to_file_pretty(path.replace_extension(".emb"));
         } else {
@@ -101,6 +115,12 @@ int main(int argc, char** argv) {
     std::filesystem::path compile_output;
     compile->add_option("-o,--output", compile_output, "specifies the output directory");
 
+    bool compile_optimize = false;
+    compile->add_flag("-O,--optimize", compile_optimize, "indicates whether the bytecode should be optimized");
+
+    bool compile_stack_only = false;
+    compile->add_flag("--stack-only", compile_stack_only, "indicates whether register instructions should be left out");
+
     compile->callback([&]() {
         std::shared_ptr<emerald::Reporter> reporter = std::make_shared<emerald::Reporter>();
         for (const std::filesystem::path& path : compile_source_files) {
@@ -114,12 +134,17 @@ int main(int argc, char** argv) {
 
             std::shared_ptr<emerald::Code> code = emerald::Compiler::compile(
                 statements,
-                reporter);
+                reporter,
+                compile_stack_only);
             if (reporter->has_errors()) {
                 reporter->print();
                 return;
             }
 
+            if (compile_optimize) {
+                emerald::Optimizer::optimize(*code);
+            }
+
             std::filesystem::path output_path;
             if (compile_output.empty()) {
                 output_path = std::filesystem::path(path).replace_extension(".emc");
@@ -151,13 +176,36 @@ int main(int argc, char** argv) {
     std::string run_module_name;
     run->add_option("module_name", run_module_name, "specifies the emerald module to execute")->required();
 
+    std::string run_profile_path;
+    run->add_option("-p,--profile", run_profile_path, "writes a folded stack CPU profile of the main process to the file");
+
+    bool run_jit = false;
+    run->add_flag("--jit", run_jit, "indicates whether hot code should be compiled to machine code");
+
+    size_t run_workers = 0;
+    run->add_option("-w,--workers", run_workers, "specifies the number of threads that run processes, defaults to the number of cores");
+
     run->callback([&]() {
         emerald::modules::add_module_inits_to_registry();
+        emerald::Jit::set_enabled(run_jit);
+        emerald::Scheduler::set_num_workers(run_workers);
         emerald::Process* main_process = emerald::ProcessManager::create();
+        if (!run_profile_path.empty()) {
+            main_process->get_profiler().start();
+        }
+
         emerald::ProcessManager::execute(main_process->get_id(), [=](emerald::Process*) {
             emerald::Interpreter::execute_module(run_module_name, main_process);
         });
         emerald::ProcessManager::join(main_process->get_id());
+
+        if (!run_profile_path.empty()) {
+            emerald::Profiler& profiler = main_process->get_profiler();
+            profiler.stop();
+            if (!profiler.write_folded_stacks(run_profile_path)) {
+                std::cerr << "unable to write profile to " << run_profile_path << std::endl;
+            }
+        }
     });
 
     CLI11_PARSE(app, argc, argv);
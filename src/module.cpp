@@ -32,12 +32,12 @@
 namespace emerald {
 
     Module::Module(Process* process, const std::string& name, std::shared_ptr<Code> code)
-        : Object(process, OBJECT_PROTOTYPE), 
+        : Object(process, OBJECT_PROTOTYPE, TYPE), 
         _name(name),
         _code(code) {}
 
     Module::Module(Process* process, Object* parent, const std::string& name, std::shared_ptr<Code> code)
-        : Object(process, parent), 
+        : Object(process, parent, TYPE), 
         _name(name),
         _code(code) {}
 
@@ -26,12 +26,12 @@ namespace emerald {
 namespace modules {
 
     BytecodeIterator::BytecodeIterator(Process* process)
-        : Object(process, OBJECT_PROTOTYPE),
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
         _code(nullptr),
         _i(0) {}
 
     BytecodeIterator::BytecodeIterator(Process* process, Object* parent)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _code(nullptr),
         _i(0) {}
 
@@ -52,20 +52,20 @@ namespace modules {
 
         const Code::Instruction& instr = (*_code)[i];
         Local<Object> obj = ALLOC_OBJECT();
-        obj->set_property("op", ALLOC_NUMBER(instr.get_op()));
+        obj->set_property("op", NUMBER(instr.get_op()));
         obj->set_property("opname", ALLOC_STRING(OpCode::get_string(instr.get_op())));
 
         Local<Array> args = ALLOC_EMPTY_ARRAY();
         for (uint64_t arg : instr.get_args()) {
-            args->push(ALLOC_NUMBER(arg));
+            args->push(NUMBER(arg));
         }
         obj->set_property("args", args.val());
 
         return obj.val();
     }
 
-    Boolean* BytecodeIterator::done() const {
-        return BOOLEAN_IN_CTX(_i >= _code->get_num_instructions(), get_process());
+    bool BytecodeIterator::done() const {
+        return _i >= _code->get_num_instructions();
     }
 
     Object* BytecodeIterator::next() {
@@ -80,6 +80,17 @@ namespace modules {
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> BytecodeIterator::pack(std::vector<Value>&) const {
+        std::shared_ptr<const Code> code = _code;
+        size_t i = _i;
+        return std::make_unique<Parcel::Native>([code, i](Process* process, Object* parent) {
+            BytecodeIterator* iter = process->get_heap().allocate<BytecodeIterator>(process, parent);
+            iter->_code = code;
+            iter->_i = i;
+            return iter;
+        });
+    }
+
     NATIVE_FUNCTION(bytecode_bytecode) {
         EXPECT_NUM_ARGS(1);
 
@@ -123,7 +134,7 @@ namespace modules {
 
         CONVERT_RECV_TO(BytecodeIterator, self);
 
-        return self->done();
+        return BOOLEAN(self->done());
     }
 
     NATIVE_FUNCTION(bytecode_iterator_next) {
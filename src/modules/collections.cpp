@@ -30,10 +30,10 @@ namespace emerald {
 namespace modules {
 
     Queue::Queue(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE) {}
 
     Queue::Queue(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     std::string Queue::as_str() const {
         return "queue(" +
@@ -41,44 +41,59 @@ namespace modules {
         + ")";
     }
 
-    Object* Queue::peek() {
+    Value Queue::peek() {
         return _value.front();
     }
 
-    Object* Queue::dequeue() {
-        Object* obj = _value.front();
+    Value Queue::dequeue() {
+        Value obj = _value.front();
         _value.pop_front();
         return obj;
     }
 
-    void Queue::enqueue(Object* obj) {
+    void Queue::enqueue(Value obj) {
+        write_barrier(obj);
         _value.push_back(obj);
     }
 
-    Boolean* Queue::empty() const {
-        return BOOLEAN_IN_CTX(_value.empty(), get_process());
+    bool Queue::empty() const {
+        return _value.empty();
     }
 
-    Number* Queue::size() const {
-        return ALLOC_NUMBER_IN_CTX(_value.size(), get_process());
+    size_t Queue::size() const {
+        return _value.size();
     }
 
-    Boolean* Queue::eq(Queue* other) const {
-        return BOOLEAN_IN_CTX(_eq(other), get_process());
+    bool Queue::eq(Queue* other) const {
+        return _eq(other);
     }
 
-    Boolean* Queue::neq(Queue* other) const {
-        return BOOLEAN_IN_CTX(!_eq(other), get_process());
+    bool Queue::neq(Queue* other) const {
+        return !_eq(other);
     }
 
     Queue* Queue::clone(Process* process, CloneCache& cache) {
         Queue* clone = clone_impl<Queue>(process, cache);
-        for (Object* obj : _value) {
-            clone->_value.push_back(obj->clone(process, cache));
+        for (Value val : _value) {
+            clone->enqueue(val.clone(process, cache));
         }
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> Queue::pack(std::vector<Value>& values) const {
+        values.assign(_value.begin(), _value.end());
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<Queue>(process, parent);
+            },
+            [](Object* obj, const std::vector<Value>& values) {
+                Queue* queue = static_cast<Queue*>(obj);
+                for (Value val : values) {
+                    queue->enqueue(val);
+                }
+            });
+    }
+
     bool Queue::_eq(Queue* other) const {
         return objectutils::compare_range(
             _value.begin(),
@@ -87,11 +102,21 @@ namespace modules {
             get_process());
     }
 
+    void Queue::reach(MarkStack& stack) {
+        Object::reach(stack);
+
+        for (Value val : _value) {
+            val.mark(stack);
+        }
+    }
+
     Set::Set(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE),
+        _value(0, hash{process}, key_eq{process}) {}
     
     Set::Set(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE),
+        _value(0, hash{process}, key_eq{process}) {}
 
     std::string Set::as_str() const {
         return "set(" +
@@ -99,64 +124,87 @@ namespace modules {
         + ")";
     }
 
-    void Set::add(Object* obj) {
+    void Set::add(Value obj) {
+        write_barrier(obj);
         _value.insert(obj);
     }
 
-    Boolean* Set::contains(Object* obj) const {
-        return BOOLEAN_IN_CTX(_value.find(obj) != _value.end(), get_process());
+    bool Set::contains(Value obj) const {
+        return _value.find(obj) != _value.end();
     }
 
-    void Set::remove(Object* obj) {
+    void Set::remove(Value obj) {
         _value.erase(obj);
     }
 
-    Boolean* Set::empty() const {
-        return BOOLEAN_IN_CTX(_value.empty(), get_process());
+    bool Set::empty() const {
+        return _value.empty();
     }
 
-    Number* Set::size() const {
-        return ALLOC_NUMBER_IN_CTX(_value.size(), get_process());
+    size_t Set::size() const {
+        return _value.size();
     }
 
-    Boolean* Set::eq(Set* other) const {
-        return BOOLEAN_IN_CTX(_value == other->_value, get_process());
+    bool Set::eq(Set* other) const {
+        return _value == other->_value;
     }
 
-    Boolean* Set::neq(Set* other) const {
-        return BOOLEAN_IN_CTX(_value != other->_value, get_process());
+    bool Set::neq(Set* other) const {
+        return _value != other->_value;
     }
 
     Set* Set::clone(Process* process, CloneCache& cache) {
         Set* clone = clone_impl<Set>(process, cache);
-        for (Object* obj : _value) {
-            clone->_value.insert(obj->clone(process, cache));
+        for (Value val : _value) {
+            clone->add(val.clone(process, cache));
         }
         return clone;
     }
 
-    size_t Set::hash::operator()(Object* val) const {
+    std::unique_ptr<Parcel::Native> Set::pack(std::vector<Value>& values) const {
+        values.assign(_value.begin(), _value.end());
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<Set>(process, parent);
+            },
+            [](Object* obj, const std::vector<Value>& values) {
+                Set* set = static_cast<Set*>(obj);
+                for (Value val : values) {
+                    set->add(val);
+                }
+            });
+    }
+
+    void Set::reach(MarkStack& stack) {
+        Object::reach(stack);
+
+        for (Value val : _value) {
+            val.mark(stack);
+        }
+    }
+
+    size_t Set::hash::operator()(Value val) const {
         return std::hash<std::string>{}(
-            Interpreter::execute_method<String>(
+            Interpreter::execute_method<String*>(
                 val,
                 magic_methods::str,
                 {},
-                val->get_process())->get_native_value());
+                process)->get_native_value());
     }
 
-    bool Set::key_eq::operator()(Object* lhs, Object* rhs) const {
-        return Interpreter::execute_method<Boolean>(
+    bool Set::key_eq::operator()(Value lhs, Value rhs) const {
+        return Interpreter::execute_method<bool>(
             lhs,
             magic_methods::eq,
             { rhs },
-            lhs->get_process())->get_native_value();
+            process);
     }
 
     Stack::Stack(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE) {}
 
     Stack::Stack(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     std::string Stack::as_str() const {
         return "stack(" +
@@ -164,44 +212,59 @@ namespace modules {
         + ")";
     }
 
-    Object* Stack::peek() const {
+    Value Stack::peek() const {
         return _value.back();
     }
 
-    Object* Stack::pop() {
-        Object* top = _value.back();
+    Value Stack::pop() {
+        Value top = _value.back();
         _value.pop_back();
         return top;
     }
 
-    void Stack::push(Object* obj) {
+    void Stack::push(Value obj) {
+        write_barrier(obj);
         _value.push_back(obj);
     }
 
-    Boolean* Stack::empty() const {
-        return BOOLEAN_IN_CTX(_value.empty(), get_process());
+    bool Stack::empty() const {
+        return _value.empty();
     }
 
-    Number* Stack::size() const {
-        return ALLOC_NUMBER_IN_CTX(_value.size(), get_process());
+    size_t Stack::size() const {
+        return _value.size();
     }
 
-    Boolean* Stack::eq(Stack* other) const {
-        return BOOLEAN_IN_CTX(_eq(other), get_process());
+    bool Stack::eq(Stack* other) const {
+        return _eq(other);
     }
 
-    Boolean* Stack::neq(Stack* other) const {
-        return BOOLEAN_IN_CTX(!_eq(other), get_process());
+    bool Stack::neq(Stack* other) const {
+        return !_eq(other);
     }
 
     Stack* Stack::clone(Process* process, CloneCache& cache) {
         Stack* clone = clone_impl<Stack>(process, cache);
-        for (Object* obj : _value) {
-            clone->_value.push_back(obj->clone(process, cache));
+        for (Value val : _value) {
+            clone->push(val.clone(process, cache));
         }
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> Stack::pack(std::vector<Value>& values) const {
+        values.assign(_value.begin(), _value.end());
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<Stack>(process, parent);
+            },
+            [](Object* obj, const std::vector<Value>& values) {
+                Stack* stack = static_cast<Stack*>(obj);
+                for (Value val : values) {
+                    stack->push(val);
+                }
+            });
+    }
+
     bool Stack::_eq(Stack* other) const {
         return objectutils::compare_range(
             _value.begin(),
@@ -210,13 +273,21 @@ namespace modules {
             get_process());
     }
 
+    void Stack::reach(MarkStack& stack) {
+        Object::reach(stack);
+
+        for (Value val : _value) {
+            val.mark(stack);
+        }
+    }
+
     NATIVE_FUNCTION(queue_eq) {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Queue, self);
 
         if (TRY_CONVERT_ARG_TO(0, Queue, other)) {
-            return self->eq(other);
+            return BOOLEAN(self->eq(other));
         }
 
         return BOOLEAN(false);
@@ -228,7 +299,7 @@ namespace modules {
         CONVERT_RECV_TO(Queue, self);
 
         if (TRY_CONVERT_ARG_TO(0, Queue, other)) {
-            return self->neq(other);
+            return BOOLEAN(self->neq(other));
         }
 
         return BOOLEAN(true);
@@ -268,7 +339,7 @@ namespace modules {
             self->enqueue(frame->get_arg(i));
         }
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(queue_empty) {
@@ -276,7 +347,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Queue, self);
 
-        return self->empty();
+        return BOOLEAN(self->empty());
     }
 
     NATIVE_FUNCTION(queue_size) {
@@ -284,7 +355,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Queue, self);
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(set_eq) {
@@ -293,7 +364,7 @@ namespace modules {
         CONVERT_RECV_TO(Set, self);
 
         if (TRY_CONVERT_ARG_TO(0, Set, other)) {
-            return self->eq(other);
+            return BOOLEAN(self->eq(other));
         }
 
         return BOOLEAN(false);
@@ -305,7 +376,7 @@ namespace modules {
         CONVERT_RECV_TO(Set, self);
 
         if (TRY_CONVERT_ARG_TO(0, Set, other)) {
-            return self->neq(other);
+            return BOOLEAN(self->neq(other));
         }
 
         return BOOLEAN(true);
@@ -329,7 +400,7 @@ namespace modules {
             self->add(frame->get_arg(i));
         }
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(set_contains) {
@@ -337,7 +408,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Set, self);
 
-        return self->contains(frame->get_arg(0));
+        return BOOLEAN(self->contains(frame->get_arg(0)));
     }
 
     NATIVE_FUNCTION(set_remove) {
@@ -355,7 +426,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Set, self);
 
-        return self->empty();
+        return BOOLEAN(self->empty());
     }
 
     NATIVE_FUNCTION(set_size) {
@@ -363,7 +434,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Set, self);
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(stack_eq) {
@@ -372,7 +443,7 @@ namespace modules {
         CONVERT_RECV_TO(Stack, self);
 
         if (TRY_CONVERT_ARG_TO(0, Stack, other)) {
-            return self->eq(other);
+            return BOOLEAN(self->eq(other));
         }
 
         return BOOLEAN(false);
@@ -384,7 +455,7 @@ namespace modules {
         CONVERT_RECV_TO(Stack, self);
 
         if (TRY_CONVERT_ARG_TO(0, Stack, other)) {
-            return self->neq(other);
+            return BOOLEAN(self->neq(other));
         }
 
         return BOOLEAN(true);
@@ -424,7 +495,7 @@ namespace modules {
             self->push(frame->get_arg(i));
         }
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(stack_empty) {
@@ -432,7 +503,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Stack, self);
 
-        return self->empty();
+        return BOOLEAN(self->empty());
     }
 
     NATIVE_FUNCTION(stack_size) {
@@ -440,7 +511,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Stack, self);
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     MODULE_INITIALIZATION_FUNC(init_collections_module) {
@@ -31,11 +31,12 @@ namespace modules {
     NATIVE_FUNCTION(core_extend) {
         EXPECT_ATLEAST_NUM_ARGS(1);
 
-        Object* target = frame->get_arg(0);
+        Object* target = frame->get_arg(0).to_object(process);
         size_t n = frame->num_args();
         for (size_t i = 1; i < n; i++) {
-            for (const auto& pair : frame->get_arg(i)->get_properties()) {
-                target->set_property(pair.first, pair.second);
+            Object* source = frame->get_arg(i).to_object(process);
+            for (Atom key : source->get_property_keys()) {
+                target->set_property(key, source->get_own_property(key));
             }
         }
 
@@ -45,22 +46,22 @@ namespace modules {
     NATIVE_FUNCTION(core_str) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<String>(frame->get_arg(0), magic_methods::str, {}, process);
+        return Interpreter::execute_method<String*>(frame->get_arg(0), magic_methods::str, {}, process);
     }
 
     NATIVE_FUNCTION(core_bool) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<Boolean>(frame->get_arg(0), magic_methods::boolean, {}, process);
+        return BOOLEAN(Interpreter::execute_method<bool>(frame->get_arg(0), magic_methods::boolean, {}, process));
     }
 
     NATIVE_FUNCTION(core_range) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_ARG_TO(0, Number, n);
+        CONVERT_ARG_TO_NUMBER(0, n);
         Local<Array> res = ALLOC_EMPTY_ARRAY();
-        for (size_t i = 0; i < n->get_native_value(); i++) {
-            res->push(ALLOC_NUMBER(i));
+        for (size_t i = 0; i < n; i++) {
+            res->push(NUMBER(i));
         }
 
         return res.val();
@@ -69,7 +70,7 @@ namespace modules {
     NATIVE_FUNCTION(core_super) {
         EXPECT_NUM_ARGS(1);
 
-        if (Object* parent = frame->get_arg(0)->get_parent()) {
+        if (Object* parent = frame->get_arg(0).to_object(process)->get_parent()) {
             return parent;
         }
 
@@ -79,31 +80,31 @@ namespace modules {
     NATIVE_FUNCTION(core_iter) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<Object>(frame->get_arg(0), magic_methods::iter, {}, process);
+        return Interpreter::execute_method<Value>(frame->get_arg(0), magic_methods::iter, {}, process);
     }
 
     NATIVE_FUNCTION(core_cur) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<Object>(frame->get_arg(0), magic_methods::cur, {}, process);
+        return Interpreter::execute_method<Value>(frame->get_arg(0), magic_methods::cur, {}, process);
     }
 
     NATIVE_FUNCTION(core_done) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<Boolean>(frame->get_arg(0), magic_methods::done, {}, process);
+        return BOOLEAN(Interpreter::execute_method<bool>(frame->get_arg(0), magic_methods::done, {}, process));
     }
 
     NATIVE_FUNCTION(core_next) {
         EXPECT_NUM_ARGS(1);
 
-        return Interpreter::execute_method<Object>(frame->get_arg(0), magic_methods::next, {}, process);
+        return Interpreter::execute_method<Value>(frame->get_arg(0), magic_methods::next, {}, process);
     }
 
     NATIVE_FUNCTION(core_print) {
         size_t n = frame->num_args();
         for (size_t i = 0; i < n; i++) {
-            std::cout << Interpreter::execute_method<String>(frame->get_arg(i), magic_methods::str, {}, process)->get_native_value() << std::endl;
+            std::cout << Interpreter::execute_method<String*>(frame->get_arg(i), magic_methods::str, {}, process)->get_native_value() << std::endl;
         }
 
         return NONE;
@@ -30,10 +30,10 @@ namespace emerald {
 namespace modules {
 
     Date::Date(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE) {}
 
     Date::Date(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     Date* Date::from_native_date(
             Process* process,
@@ -48,40 +48,37 @@ namespace modules {
         return boost::gregorian::to_simple_string(_date);
     }
 
-    void Date::init(Number* year, Number* month, Number* day) {
-        _date = boost::gregorian::date(
-            year->get_native_value(),
-            month->get_native_value(),
-            day->get_native_value());
+    void Date::init(double year, double month, double day) {
+        _date = boost::gregorian::date(year, month, day);
     }
 
-    Number* Date::year() const {
-        return ALLOC_NUMBER_IN_CTX(_date.year(), get_process());
+    double Date::year() const {
+        return _date.year();
     }
 
-    Number* Date::month() const {
-        return ALLOC_NUMBER_IN_CTX(_date.month(), get_process());
+    double Date::month() const {
+        return _date.month();
     }
 
-    Number* Date::day() const {
-        return ALLOC_NUMBER_IN_CTX(_date.day(), get_process());
+    double Date::day() const {
+        return _date.day();
     }
 
     String* Date::day_of_week() const {
         return ALLOC_STRING_IN_CTX(boost::lexical_cast<std::string>(_date.day_of_week()), get_process());
     }
 
-    Number* Date::day_of_year() const {
-        return ALLOC_NUMBER_IN_CTX(_date.day_of_year(), get_process());
+    double Date::day_of_year() const {
+        return _date.day_of_year();
     }
 
-    void Date::add(Number* days) {
-        boost::gregorian::date_duration dd(days->get_native_value());
+    void Date::add(double days) {
+        boost::gregorian::date_duration dd(days);
         _date = _date + dd;
     }
 
-    void Date::sub(Number* days) {
-        boost::gregorian::date_duration dd(days->get_native_value());
+    void Date::sub(double days) {
+        boost::gregorian::date_duration dd(days);
         _date = _date - dd;
     }
 
@@ -91,11 +88,18 @@ namespace modules {
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> Date::pack(std::vector<Value>&) const {
+        boost::gregorian::date date = _date;
+        return std::make_unique<Parcel::Native>([date](Process* process, Object* parent) {
+            return from_native_date(process, parent, date);
+        });
+    }
+
     TimeDuration::TimeDuration(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE) {}
 
     TimeDuration::TimeDuration(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     TimeDuration* TimeDuration::from_native_duration(
             Process* process,
@@ -114,39 +118,39 @@ namespace modules {
     }
 
     void TimeDuration::init(
-            Number* hours,
-            Number* minutes,
-            Number* seconds,
-            Number* milliseconds) {
+            double hours,
+            double minutes,
+            double seconds,
+            double milliseconds) {
         _duration = boost::posix_time::time_duration(
-            hours->get_native_value(),
-            minutes->get_native_value(),
-            seconds->get_native_value(),
-            milliseconds->get_native_value() * 1000);
+            hours,
+            minutes,
+            seconds,
+            milliseconds * 1000);
     }
 
-    Number* TimeDuration::hours() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.hours(), get_process());
+    double TimeDuration::hours() const {
+        return _duration.hours();
     }
 
-    Number* TimeDuration::minutes() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.minutes(), get_process());
+    double TimeDuration::minutes() const {
+        return _duration.minutes();
     }
 
-    Number* TimeDuration::seconds() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.seconds(), get_process());
+    double TimeDuration::seconds() const {
+        return _duration.seconds();
     }
 
-    Number* TimeDuration::milliseconds() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.fractional_seconds() / 1000, get_process());
+    double TimeDuration::milliseconds() const {
+        return _duration.fractional_seconds() / 1000;
     }
 
-    Number* TimeDuration::total_seconds() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.total_seconds(), get_process());
+    double TimeDuration::total_seconds() const {
+        return _duration.total_seconds();
     }
 
-    Number* TimeDuration::total_milliseconds() const {
-        return ALLOC_NUMBER_IN_CTX(_duration.total_milliseconds(), get_process());
+    double TimeDuration::total_milliseconds() const {
+        return _duration.total_milliseconds();
     }
 
     void TimeDuration::add(TimeDuration* other) {
@@ -167,11 +171,18 @@ namespace modules {
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> TimeDuration::pack(std::vector<Value>&) const {
+        boost::posix_time::time_duration duration = _duration;
+        return std::make_unique<Parcel::Native>([duration](Process* process, Object* parent) {
+            return from_native_duration(process, parent, duration);
+        });
+    }
+
     Time::Time(Process* process)
-        : Object(process) {}
+        : Object(process, TYPE) {}
 
     Time::Time(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     Time* Time::from_native_time(
             Process* process,
@@ -212,7 +223,21 @@ namespace modules {
         return time;
     }
 
-    void Time::add(Number* days) {
+    std::unique_ptr<Parcel::Native> Time::pack(std::vector<Value>& values) const {
+        values.push_back(_date);
+        values.push_back(_time_of_day);
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<Time>(process, parent);
+            },
+            [](Object* obj, const std::vector<Value>& values) {
+                static_cast<Time*>(obj)->init(
+                    values[0].get_object_as<Date>(),
+                    values[1].get_object_as<TimeDuration>());
+            });
+    }
+
+    void Time::add(double days) {
         _date->add(days);
     }
 
@@ -220,7 +245,7 @@ namespace modules {
         _time_of_day->sub(time);
     }
 
-    void Time::sub(Number* days) {
+    void Time::sub(double days) {
         _date->sub(days);
     }
 
@@ -232,7 +257,7 @@ namespace modules {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Date, self);
-        CONVERT_ARG_TO(0, Number, days);
+        CONVERT_ARG_TO_NUMBER(0, days);
 
         self->add(days);
 
@@ -243,7 +268,7 @@ namespace modules {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Date, self);
-        CONVERT_ARG_TO(0, Number, days);
+        CONVERT_ARG_TO_NUMBER(0, days);
 
         self->sub(days);
 
@@ -262,9 +287,9 @@ namespace modules {
         EXPECT_NUM_ARGS(3);
 
         CONVERT_RECV_TO(Date, self);
-        CONVERT_ARG_TO(0, Number, year);
-        CONVERT_ARG_TO(1, Number, month);
-        CONVERT_ARG_TO(2, Number, day);
+        CONVERT_ARG_TO_NUMBER(0, year);
+        CONVERT_ARG_TO_NUMBER(1, month);
+        CONVERT_ARG_TO_NUMBER(2, day);
 
         self->init(year, month, day);
 
@@ -276,7 +301,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Date, self);
 
-        return self->year();
+        return NUMBER(self->year());
     }
 
     NATIVE_FUNCTION(date_month) {
@@ -284,7 +309,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Date, self);
 
-        return self->month();
+        return NUMBER(self->month());
     }
 
     NATIVE_FUNCTION(date_day) {
@@ -292,7 +317,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Date, self);
 
-        return self->day();
+        return NUMBER(self->day());
     }
 
     NATIVE_FUNCTION(date_day_of_week) {
@@ -308,7 +333,7 @@ namespace modules {
 
         CONVERT_RECV_TO(Date, self);
 
-        return self->day_of_year();
+        return NUMBER(self->day_of_year());
     }
 
     NATIVE_FUNCTION(time_duration_add) {
@@ -319,7 +344,7 @@ namespace modules {
 
         return TimeDuration::from_native_duration(
             process,
-            frame->get_global("TimeDuration"),
+            frame->get_global("TimeDuration").get_object(),
             self->get_native_value() + other->get_native_value());
     }
 
@@ -331,7 +356,7 @@ namespace modules {
 
         return TimeDuration::from_native_duration(
             process,
-            frame->get_global("TimeDuration"),
+            frame->get_global("TimeDuration").get_object(),
             self->get_native_value() - other->get_native_value());
     }
 
@@ -369,10 +394,10 @@ namespace modules {
         EXPECT_NUM_ARGS(4);
 
         CONVERT_RECV_TO(TimeDuration, self);
-        CONVERT_ARG_TO(0, Number, hours);
-        CONVERT_ARG_TO(1, Number, minutes);
-        CONVERT_ARG_TO(2, Number, seconds);
-        CONVERT_ARG_TO(3, Number, milliseconds);
+        CONVERT_ARG_TO_NUMBER(0, hours);
+        CONVERT_ARG_TO_NUMBER(1, minutes);
+        CONVERT_ARG_TO_NUMBER(2, seconds);
+        CONVERT_ARG_TO_NUMBER(3, milliseconds);
 
         self->init(hours, minutes, seconds, milliseconds);
 
@@ -384,7 +409,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->hours();
+        return NUMBER(self->hours());
     }
 
     NATIVE_FUNCTION(time_duration_minutes) {
@@ -392,7 +417,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->minutes();
+        return NUMBER(self->minutes());
     }
 
     NATIVE_FUNCTION(time_duration_seconds) {
@@ -400,7 +425,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->seconds();
+        return NUMBER(self->seconds());
     }
 
     NATIVE_FUNCTION(time_duration_milliseconds) {
@@ -408,7 +433,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->milliseconds();
+        return NUMBER(self->milliseconds());
     }
 
     NATIVE_FUNCTION(time_duration_total_seconds) {
@@ -416,7 +441,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->total_seconds();
+        return NUMBER(self->total_seconds());
     }
 
     NATIVE_FUNCTION(time_duration_total_milliseconds) {
@@ -424,7 +449,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TimeDuration, self);
 
-        return self->total_milliseconds();
+        return NUMBER(self->total_milliseconds());
     }
 
     NATIVE_FUNCTION(time_iadd) {
@@ -432,8 +457,8 @@ namespace modules {
 
         CONVERT_RECV_TO(Time, self);
 
-        if (TRY_CONVERT_ARG_TO(0, Number, days)) {
-            self->add(days);
+        if (TRY_CONVERT_ARG_TO_NUMBER(0, days)) {
+            self->add(*days);
         } else if (TRY_CONVERT_ARG_TO(0, TimeDuration, time)) {
             self->add(time);
         } else {
@@ -448,8 +473,8 @@ namespace modules {
 
         CONVERT_RECV_TO(Time, self);
 
-        if (TRY_CONVERT_ARG_TO(0, Number, days)) {
-            self->sub(days);
+        if (TRY_CONVERT_ARG_TO_NUMBER(0, days)) {
+            self->sub(*days);
         } else if (TRY_CONVERT_ARG_TO(0, TimeDuration, time)) {
             self->sub(time);
         } else {
@@ -500,9 +525,9 @@ namespace modules {
 
         return Time::from_native_time(
             process,
-            frame->get_global("Date"),
-            frame->get_global("TimeDuration"),
-            frame->get_global("Time"),
+            frame->get_global("Date").get_object(),
+            frame->get_global("TimeDuration").get_object(),
+            frame->get_global("Time").get_object(),
             boost::posix_time::second_clock::universal_time());
     }
 
@@ -511,9 +536,9 @@ namespace modules {
 
         return Time::from_native_time(
             process,
-            frame->get_global("Date"),
-            frame->get_global("TimeDuration"),
-            frame->get_global("Time"),
+            frame->get_global("Date").get_object(),
+            frame->get_global("TimeDuration").get_object(),
+            frame->get_global("Time").get_object(),
             boost::posix_time::second_clock::local_time());
     }
 
@@ -552,8 +577,8 @@ namespace modules {
         time->set_property(magic_methods::isub, ALLOC_NATIVE_FUNCTION(time_isub));
         time->set_property(magic_methods::clone, ALLOC_NATIVE_FUNCTION(time_clone));
         time->set_property(magic_methods::init, ALLOC_NATIVE_FUNCTION(time_init));
-        time->set_property("date", ALLOC_PROP_ACC_DESC(ALLOC_NATIVE_FUNCTION(time_date), nullptr));
-        time->set_property("time_of_day", ALLOC_PROP_ACC_DESC(ALLOC_NATIVE_FUNCTION(time_time_of_day), nullptr));
+        time->define_property("date", ALLOC_PROP_ACC_DESC(ALLOC_NATIVE_FUNCTION(time_date), nullptr));
+        time->define_property("time_of_day", ALLOC_PROP_ACC_DESC(ALLOC_NATIVE_FUNCTION(time_time_of_day), nullptr));
         module->set_property("Time", time.val());
 
         module->set_property("universal_time", ALLOC_NATIVE_FUNCTION(datetime_universal_time));
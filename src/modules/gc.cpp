@@ -15,8 +15,12 @@
 **  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <chrono>
+#include <fstream>
+
 #include "emerald/module.h"
 #include "emerald/modules/gc.h"
+#include "emerald/native_variables.h"
 #include "emerald/objectutils.h"
 #include "emerald/process.h"
 
@@ -29,18 +33,161 @@ namespace modules {
     }
 
     NATIVE_FUNCTION(gc_total_allocated_objects) {
-        return ALLOC_NUMBER(process->get_heap().get_managed_count());
+        return NUMBER(process->get_heap().get_managed_count());
     }
 
     NATIVE_FUNCTION(gc_threshold) {
-        return ALLOC_NUMBER(process->get_heap().threshold());
+        return NUMBER(process->get_heap().threshold());
     }
 
     NATIVE_FUNCTION(gc_set_threshold) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_ARG_TO(0, Number, threshold);
-        process->get_heap().set_threshold(threshold->get_native_value());
+        CONVERT_ARG_TO_NUMBER(0, threshold);
+        process->get_heap().set_threshold(threshold);
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(gc_pause_budget) {
+        std::chrono::duration<double, std::milli> budget = process->get_heap().pause_budget();
+        return NUMBER(budget.count());
+    }
+
+    NATIVE_FUNCTION(gc_set_pause_budget) {
+        EXPECT_NUM_ARGS(1);
+
+        CONVERT_ARG_TO_NUMBER(0, budget);
+        process->get_heap().set_pause_budget(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::duration<double, std::milli>(budget)));
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(gc_stats) {
+        EXPECT_NUM_ARGS(0);
+
+        HeapStats stats = process->get_heap().get_stats();
+        std::chrono::duration<double, std::milli> total_pause = stats.get_total_pause();
+        std::chrono::duration<double, std::milli> max_pause = stats.get_max_pause();
+
+        Object* obj = ALLOC_OBJECT();
+        obj->set_property("objects", NUMBER(stats.get_live_count()));
+        obj->set_property("bytes", NUMBER(stats.get_live_bytes()));
+        obj->set_property("allocations", NUMBER(stats.get_num_allocations()));
+        obj->set_property("allocated_bytes", NUMBER(stats.get_allocated_bytes()));
+        obj->set_property("allocation_rate", NUMBER(stats.get_allocation_rate()));
+        obj->set_property("young_collections", NUMBER(stats.get_num_collections(CollectionStats::Kind::YOUNG)));
+        obj->set_property("old_collections", NUMBER(stats.get_num_old_collections()));
+        obj->set_property("full_collections", NUMBER(stats.get_num_collections(CollectionStats::Kind::FULL)));
+        obj->set_property("total_pause", NUMBER(total_pause.count()));
+        obj->set_property("max_pause", NUMBER(max_pause.count()));
+        obj->set_property("young_survivor_ratio", NUMBER(stats.get_young_survivor_ratio()));
+        obj->set_property("old_survivor_ratio", NUMBER(stats.get_old_survivor_ratio()));
+
+        return obj;
+    }
+
+    NATIVE_FUNCTION(gc_type_stats) {
+        EXPECT_NUM_ARGS(0);
+
+        HeapStats stats = process->get_heap().get_stats();
+
+        Local<Object> types = ALLOC_OBJECT();
+        for (uint16_t type_id = 0; type_id < stats.get_num_types(); type_id++) {
+            if (stats.get_live_count(type_id) == 0) continue;
+
+            Object* type = ALLOC_OBJECT();
+            type->set_property("objects", NUMBER(stats.get_live_count(type_id)));
+            type->set_property("bytes", NUMBER(stats.get_live_bytes(type_id)));
+            types->set_property(HeapTypes::get_name(type_id), type);
+        }
+
+        return types.val();
+    }
+
+    NATIVE_FUNCTION(gc_collections) {
+        EXPECT_NUM_ARGS(0);
+
+        HeapStats stats = process->get_heap().get_stats();
+
+        Local<Array> collections = ALLOC_EMPTY_ARRAY();
+        for (const CollectionStats& collection : stats.get_recent_collections()) {
+            std::chrono::duration<double, std::milli> pause = collection.pause;
+
+            Local<Object> obj = ALLOC_OBJECT();
+            obj->set_property("kind", ALLOC_STRING(
+                collection.kind == CollectionStats::Kind::YOUNG ? "young" : "full"));
+            obj->set_property("pause", NUMBER(pause.count()));
+            obj->set_property("objects", NUMBER(collection.objects));
+            obj->set_property("survivors", NUMBER(collection.survivors));
+            collections->push(obj.val());
+        }
+
+        return collections.val();
+    }
+
+    NATIVE_FUNCTION(gc_start_profiling) {
+        TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(0, sample_interval);
+
+        process->get_heap().start_profiling(
+            sample_interval.value_or(512),
+            [process]() {
+                Stack& stack = process->get_stack();
+                if (stack.empty()) {
+                    return AllocationSite{ "", 0 };
+                }
+
+                const Stack::Frame& top = stack.peek();
+                return AllocationSite{
+                    top.get_label(),
+                    top.get_current_instruction()
+                };
+            });
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(gc_stop_profiling) {
+        EXPECT_NUM_ARGS(0);
+
+        process->get_heap().stop_profiling();
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(gc_profile) {
+        EXPECT_NUM_ARGS(0);
+
+        Local<Array> samples = ALLOC_EMPTY_ARRAY();
+        for (const AllocationSample& sample : process->get_heap().get_stats().get_profile()) {
+            Local<Object> obj = ALLOC_OBJECT();
+            obj->set_property("label", ALLOC_STRING(sample.site.label));
+            obj->set_property("instruction", NUMBER(sample.site.instruction));
+            obj->set_property("type", ALLOC_STRING(HeapTypes::get_name(sample.type_id)));
+            obj->set_property("samples", NUMBER(sample.count));
+            samples->push(obj.val());
+        }
+
+        return samples.val();
+    }
+
+    NATIVE_FUNCTION(gc_dump_profile) {
+        EXPECT_NUM_ARGS(1);
+
+        CONVERT_ARG_TO(0, String, path);
+
+        std::ofstream ofs(path->get_native_value());
+        if (!ofs) {
+            throw ALLOC_EXCEPTION("unable to open " + path->get_native_value());
+        }
+
+        for (const AllocationSample& sample : process->get_heap().get_stats().get_profile()) {
+            ofs << sample.count << "\t"
+                << HeapTypes::get_name(sample.type_id) << "\t"
+                << sample.site.label << ":" << sample.site.instruction << std::endl;
+        }
 
         return NONE;
     }
@@ -52,6 +199,15 @@ namespace modules {
         module->set_property("total_allocated_objects", ALLOC_NATIVE_FUNCTION(gc_total_allocated_objects));
         module->set_property("threshold", ALLOC_NATIVE_FUNCTION(gc_threshold));
         module->set_property("set_threshold", ALLOC_NATIVE_FUNCTION(gc_set_threshold));
+        module->set_property("pause_budget", ALLOC_NATIVE_FUNCTION(gc_pause_budget));
+        module->set_property("set_pause_budget", ALLOC_NATIVE_FUNCTION(gc_set_pause_budget));
+        module->set_property("stats", ALLOC_NATIVE_FUNCTION(gc_stats));
+        module->set_property("type_stats", ALLOC_NATIVE_FUNCTION(gc_type_stats));
+        module->set_property("collections", ALLOC_NATIVE_FUNCTION(gc_collections));
+        module->set_property("start_profiling", ALLOC_NATIVE_FUNCTION(gc_start_profiling));
+        module->set_property("stop_profiling", ALLOC_NATIVE_FUNCTION(gc_stop_profiling));
+        module->set_property("profile", ALLOC_NATIVE_FUNCTION(gc_profile));
+        module->set_property("dump_profile", ALLOC_NATIVE_FUNCTION(gc_dump_profile));
     }
 
 } // namespace modules
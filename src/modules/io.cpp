@@ -28,10 +28,10 @@ namespace emerald {
 namespace modules {
 
     FileStream::FileStream(Process* process)
-        : Object(process, OBJECT_PROTOTYPE) {}
+        : Object(process, OBJECT_PROTOTYPE, TYPE) {}
 
     FileStream::FileStream(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     std::string FileStream::as_str() const {
         return "<file_stream>";
@@ -54,8 +54,8 @@ namespace modules {
         _stream.open(filename->get_native_value(), openmode);
     }
 
-    Boolean* FileStream::is_open() const {
-        return BOOLEAN_IN_CTX(_stream.is_open(), get_process());
+    bool FileStream::is_open() const {
+        return _stream.is_open();
     }
 
     String* FileStream::read() {
@@ -70,8 +70,8 @@ namespace modules {
         return ALLOC_STRING_IN_CTX(std::string(s), get_process());
     }
 
-    String* FileStream::read(Number* n) {
-        size_t size = n->get_native_value(); 
+    String* FileStream::read(double n) {
+        size_t size = n;
         char s[size];
         _stream.read(s, size);
         return ALLOC_STRING_IN_CTX(std::string(s), get_process());
@@ -92,18 +92,25 @@ namespace modules {
         return clone_impl<FileStream>(process, cache);
     }
 
+    // Like a clone, the receiver gets a stream that isn't open.
+    std::unique_ptr<Parcel::Native> FileStream::pack(std::vector<Value>&) const {
+        return std::make_unique<Parcel::Native>([](Process* process, Object* parent) {
+            return process->get_heap().allocate<FileStream>(process, parent);
+        });
+    }
+
     StringStream::StringStream(Process* process)
-        : Object(process, OBJECT_PROTOTYPE) {}
+        : Object(process, OBJECT_PROTOTYPE, TYPE) {}
 
     StringStream::StringStream(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     std::string StringStream::as_str() const {
         return "<string_stream>";
     }
 
-    String* StringStream::read(Number* n) {
-        size_t size = n->get_native_value();
+    String* StringStream::read(double n) {
+        size_t size = n;
         char s[size];
         _stream.read(s, size);
         return ALLOC_STRING_IN_CTX(std::string(s), get_process());
@@ -124,6 +131,13 @@ namespace modules {
         return clone_impl<StringStream>(process, cache);
     }
 
+    // Like a clone, the receiver gets an empty stream.
+    std::unique_ptr<Parcel::Native> StringStream::pack(std::vector<Value>&) const {
+        return std::make_unique<Parcel::Native>([](Process* process, Object* parent) {
+            return process->get_heap().allocate<StringStream>(process, parent);
+        });
+    }
+
     NATIVE_FUNCTION(file_stream_clone) {
         EXPECT_NUM_ARGS(0);
 
@@ -140,7 +154,7 @@ namespace modules {
 
         self->open(filename, access);
 
-        return self->is_open();
+        return BOOLEAN(self->is_open());
     }
     
     NATIVE_FUNCTION(file_stream_is_open) {
@@ -148,15 +162,15 @@ namespace modules {
 
         CONVERT_RECV_TO(FileStream, self);
 
-        return self->is_open();
+        return BOOLEAN(self->is_open());
     }
 
     NATIVE_FUNCTION(file_stream_read) {
         CONVERT_RECV_TO(FileStream, self);
 
-        TRY_CONVERT_OPTIONAL_ARG_TO(0, Number, count);
+        TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(0, count);
         if (count) {
-            return self->read(count);
+            return self->read(*count);
         }
 
         return self->read();
@@ -193,7 +207,7 @@ namespace modules {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(StringStream, self);
-        CONVERT_ARG_TO(0, Number, count);
+        CONVERT_ARG_TO_NUMBER(0, count);
 
         return self->read(count);
     }
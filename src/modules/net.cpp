@@ -28,10 +28,10 @@ namespace emerald {
 namespace modules {
 
     IPAddress::IPAddress(Process* process)
-        : Object(process, OBJECT_PROTOTYPE) {}
+        : Object(process, OBJECT_PROTOTYPE, TYPE) {}
 
     IPAddress::IPAddress(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     IPAddress* IPAddress::from_native_address(
             Process* process,
@@ -56,24 +56,24 @@ namespace modules {
             address->get_native_value());
     }
 
-    Boolean* IPAddress::is_loopback() const {
-        return BOOLEAN_IN_CTX(_address.is_loopback(), get_process());
+    bool IPAddress::is_loopback() const {
+        return _address.is_loopback();
     }
 
-    Boolean* IPAddress::is_multicast() const {
-        return BOOLEAN_IN_CTX(_address.is_multicast(), get_process());
+    bool IPAddress::is_multicast() const {
+        return _address.is_multicast();
     }
 
-    Boolean* IPAddress::is_unspecified() const {
-        return BOOLEAN_IN_CTX(_address.is_unspecified(), get_process());
+    bool IPAddress::is_unspecified() const {
+        return _address.is_unspecified();
     }
 
-    Boolean* IPAddress::is_ipv4() const {
-        return BOOLEAN_IN_CTX(_address.is_v4(), get_process());
+    bool IPAddress::is_ipv4() const {
+        return _address.is_v4();
     }
 
-    Boolean* IPAddress::is_ipv6() const {
-        return BOOLEAN_IN_CTX(_address.is_v6(), get_process());
+    bool IPAddress::is_ipv6() const {
+        return _address.is_v6();
     }
 
     IPAddress* IPAddress::clone(Process* process, CloneCache& cache) {
@@ -82,15 +82,20 @@ namespace modules {
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> IPAddress::pack(std::vector<Value>&) const {
+        boost::asio::ip::address address = _address;
+        return std::make_unique<Parcel::Native>([address](Process* process, Object* parent) {
+            return from_native_address(process, parent, address);
+        });
+    }
+
     IPEndpoint::IPEndpoint(Process* process)
-        : Object(process, OBJECT_PROTOTYPE),
-        _address(nullptr),
-        _port(nullptr) {}
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
+        _address(nullptr) {}
 
     IPEndpoint::IPEndpoint(Process* process, Object* parent)
-        : Object(process, parent),
-        _address(nullptr),
-        _port(nullptr) {}
+        : Object(process, parent, TYPE),
+        _address(nullptr) {}
 
     IPEndpoint* IPEndpoint::from_native_endpoint(
             Process* process,
@@ -103,11 +108,9 @@ namespace modules {
             address_parent,
             { ALLOC_STRING(endpoint.address().to_string()) },
             process);
-        Local<Number> port = ALLOC_NUMBER(endpoint.port());
         Local<IPEndpoint> ip_endpoint = process->get_heap().allocate<IPEndpoint>(
             process, endpoint_parent);
         ip_endpoint->_address = address.val();
-        ip_endpoint->_port = port.val();
         ip_endpoint->_endpoint = endpoint;
 
         return ip_endpoint.val();
@@ -121,50 +124,62 @@ namespace modules {
         return _endpoint;
     }
 
-    void IPEndpoint::init(IPAddress* address, Number* port) {
+    void IPEndpoint::init(IPAddress* address, double port) {
         _address = address;
-        _port = port;
         _endpoint.address(address->get_native_address());
-        _endpoint.port(port->get_native_value());
+        _endpoint.port(port);
     }
 
     IPAddress* IPEndpoint::get_address() const {
         return _address;
     }
 
-    Number* IPEndpoint::get_port() const {
-        return _port;
+    double IPEndpoint::get_port() const {
+        return _endpoint.port();
     }
 
     IPEndpoint* IPEndpoint::clone(Process* process, CloneCache& cache) {
         IPEndpoint* clone = clone_impl<IPEndpoint>(process, cache);
         clone->_address = _address->clone(process, cache);
-        clone->_port = _port->clone(process, cache);
         clone->_endpoint = _endpoint;
         return clone;
     }
 
+    // The address is made before the endpoint is filled in, so the port is
+    // all that needs carrying.
+    std::unique_ptr<Parcel::Native> IPEndpoint::pack(std::vector<Value>& values) const {
+        values.push_back(_address);
+        double port = _endpoint.port();
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<IPEndpoint>(process, parent);
+            },
+            [port](Object* obj, const std::vector<Value>& values) {
+                static_cast<IPEndpoint*>(obj)->init(values[0].get_object_as<IPAddress>(), port);
+            });
+    }
+
     TcpClient::TcpClient(Process* process)
-        : Object(process, OBJECT_PROTOTYPE),
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
         _socket(_service) {}
 
     TcpClient::TcpClient(Process* process, Object* parent)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _socket(_service) {}
 
-    Boolean* TcpClient::connect(IPEndpoint* endpoint) {
+    bool TcpClient::connect(IPEndpoint* endpoint) {
         boost::system::error_code error;
         _socket.connect(endpoint->get_native_endpoint(), error);
         if (error) {
-            return BOOLEAN_IN_CTX(false, get_process());
+            return false;
         }
 
-        return BOOLEAN_IN_CTX(true, get_process());
+        return true;
     }
 
-    String* TcpClient::read(Number* bytes) {
+    String* TcpClient::read(double bytes) {
         boost::asio::streambuf buffer;
-        boost::asio::read(_socket, buffer, boost::asio::transfer_exactly(bytes->get_native_value()));
+        boost::asio::read(_socket, buffer, boost::asio::transfer_exactly(bytes));
         return ALLOC_STRING_IN_CTX(
             std::string(boost::asio::buffer_cast<const char*>(buffer.data())),
             get_process());
@@ -178,14 +193,21 @@ namespace modules {
         return clone_impl<TcpClient>(process, cache);
     }
 
+    // Like a clone, the receiver gets a client that isn't connected.
+    std::unique_ptr<Parcel::Native> TcpClient::pack(std::vector<Value>&) const {
+        return std::make_unique<Parcel::Native>([](Process* process, Object* parent) {
+            return process->get_heap().allocate<TcpClient>(process, parent);
+        });
+    }
+
     TcpListener::TcpListener(Process* process)
-        : Object(process, OBJECT_PROTOTYPE),
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
         _listening(false),
         _endpoint(nullptr),
         _acceptor(_service) {}
 
     TcpListener::TcpListener(Process* process, Object* parent)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _listening(false),
         _endpoint(nullptr),
         _acceptor(_service) {}
@@ -206,8 +228,8 @@ namespace modules {
         _acceptor.close();
     }
 
-    Boolean* TcpListener::is_listening() const {
-        return BOOLEAN_IN_CTX(_listening, get_process());
+    bool TcpListener::is_listening() const {
+        return _listening;
     }
 
     void TcpListener::accept(TcpClient* client) {
@@ -224,6 +246,17 @@ namespace modules {
         return clone;
     }
 
+    std::unique_ptr<Parcel::Native> TcpListener::pack(std::vector<Value>& values) const {
+        values.push_back(_endpoint ? Value(_endpoint) : Value::null());
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<TcpListener>(process, parent);
+            },
+            [](Object* obj, const std::vector<Value>& values) {
+                static_cast<TcpListener*>(obj)->init(values[0].get_object_as<IPEndpoint>());
+            });
+    }
+
     NATIVE_FUNCTION(ip_address_clone) {
         EXPECT_NUM_ARGS(0);
 
@@ -248,7 +281,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPAddress, self);
 
-        return self->is_loopback();
+        return BOOLEAN(self->is_loopback());
     }
 
     NATIVE_FUNCTION(ip_address_is_multicast) {
@@ -256,7 +289,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPAddress, self);
 
-        return self->is_multicast();
+        return BOOLEAN(self->is_multicast());
     }
 
     NATIVE_FUNCTION(ip_address_is_unspecified) {
@@ -264,7 +297,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPAddress, self);
 
-        return self->is_unspecified();
+        return BOOLEAN(self->is_unspecified());
     }
 
     NATIVE_FUNCTION(ip_address_is_ipv4) {
@@ -272,7 +305,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPAddress, self);
 
-        return self->is_ipv4();
+        return BOOLEAN(self->is_ipv4());
     }
 
     NATIVE_FUNCTION(ip_address_is_ipv6) {
@@ -280,7 +313,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPAddress, self);
 
-        return self->is_ipv6();
+        return BOOLEAN(self->is_ipv6());
     }
 
     NATIVE_FUNCTION(ip_endpoint_clone) {
@@ -296,7 +329,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPEndpoint, self);
         CONVERT_ARG_TO(0, IPAddress, address);
-        CONVERT_ARG_TO(1, Number, port);
+        CONVERT_ARG_TO_NUMBER(1, port);
         self->init(address, port);
 
         return NONE;
@@ -315,7 +348,7 @@ namespace modules {
 
         CONVERT_RECV_TO(IPEndpoint, self);
 
-        return self->get_port();
+        return NUMBER(self->get_port());
     }
 
     NATIVE_FUNCTION(tcp_client_clone) {
@@ -341,7 +374,7 @@ namespace modules {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(TcpClient, self);
-        CONVERT_ARG_TO(0, Number, bytes);
+        CONVERT_ARG_TO_NUMBER(0, bytes);
 
         return self->read(bytes);
     }
@@ -406,7 +439,7 @@ namespace modules {
 
         CONVERT_RECV_TO(TcpListener, self);
         TcpClient* client = Interpreter::create_obj<TcpClient>(
-            frame->get_global("TcpClient"),
+            frame->get_global("TcpClient").get_object(),
             {},
             process);
         self->accept(client);
@@ -436,7 +469,7 @@ namespace modules {
             const boost::asio::ip::tcp::endpoint& endpoint = *iter;
             res->push(IPAddress::from_native_address(
                 process,
-                frame->get_global("IPAddress"),
+                frame->get_global("IPAddress").get_object(),
                 endpoint.address()));
             iter++;
         }
@@ -16,86 +16,249 @@
 */
 
 #include <chrono>
-#include <thread>
+#include <memory>
+#include <vector>
 
+#include "emerald/frozen.h"
 #include "emerald/interpreter.h"
 #include "emerald/module.h"
 #include "emerald/modules/process.h"
 #include "emerald/native_variables.h"
 #include "emerald/objectutils.h"
+#include "emerald/parcel.h"
 #include "emerald/process.h"
 
 namespace emerald {
 namespace modules {
 
+    static Scheduler::Clock::time_point deadline_after(double seconds) {
+        return Scheduler::Clock::now() + std::chrono::duration_cast<Scheduler::Clock::duration>(
+            std::chrono::duration<double>(seconds));
+    }
+
+    // Packs the argument at callable_index, the receiver and the rest of
+    // the arguments, for new processes to unpack once they run.
+    static ParcelRef pack_entry(NativeStack::NativeFrame* frame, size_t callable_index, Process* process) {
+        std::vector<Value> values = { frame->get_arg(callable_index), frame->get_receiver() };
+        for (size_t i = callable_index + 1; i < frame->num_args(); i++) {
+            values.push_back(frame->get_arg(i));
+        }
+
+        return Parcel::pack(values, process);
+    }
+
+    static void start_process(Process* new_process, const ParcelRef& entry) {
+        Scheduler::spawn(new_process, [=](emerald::Process*) {
+            std::vector<Value> values = entry->unpack_all(new_process);
+            Interpreter::call_obj<Value>(
+                values[0],
+                values[1],
+                std::vector<Value>(values.begin() + 2, values.end()),
+                new_process);
+        });
+    }
+
+    // Immediates are sent as they are, anything else is packed here and
+    // unpacked by the receiver when it takes the message.
+    static void send_msg(Process* receiver, Value message, const ParcelRef& parcel) {
+        if (parcel) {
+            receiver->get_mailbox().push_msg(parcel);
+        } else {
+            receiver->get_mailbox().push_msg(message);
+        }
+    }
+
+    static ParcelRef pack_msg(Value message, Process* process) {
+        return message.is_object() ? Parcel::pack(message, process) : nullptr;
+    }
+
     NATIVE_FUNCTION(process_create) {
         EXPECT_ATLEAST_NUM_ARGS(1);
 
+        ParcelRef entry = pack_entry(frame, 0, process);
         Process* new_process = ProcessManager::create();
-        CloneCache cache;
-        new_process->get_heap().add_root_source(&cache);
-        Object* callable = frame->get_arg(0)->clone(new_process, cache);
-        std::vector<Object*> args;
-        for (size_t i = 1; i < frame->num_args(); i++) {
-            args.push_back(frame->get_arg(i)->clone(new_process, cache));
+        start_process(new_process, entry);
+
+        return NUMBER(new_process->get_id());
+    }
+
+    NATIVE_FUNCTION(process_dump_profile) {
+        EXPECT_NUM_ARGS(1);
+
+        CONVERT_ARG_TO(0, String, path);
+
+        if (!process->get_profiler().write_folded_stacks(path->get_native_value())) {
+            throw ALLOC_EXCEPTION("unable to write " + path->get_native_value());
         }
-        Object* receiver = frame->get_receiver()->clone(new_process, cache);
-        new_process->get_heap().remove_root_source(&cache);
-        ProcessManager::execute(new_process->get_id(), [=](emerald::Process*) {
-            Interpreter::call_obj<Object>(
-                callable,
-                receiver,
-                args,
-                new_process);
-        });
 
-        return ALLOC_NUMBER(new_process->get_id());
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(process_freeze) {
+        EXPECT_NUM_ARGS(1);
+
+        return Frozen::freeze(frame->get_arg(0), process);
+    }
+
+    NATIVE_FUNCTION(process_frozen) {
+        EXPECT_NUM_ARGS(1);
+
+        Object* obj = frame->get_arg(0).get_object();
+        return BOOLEAN(!obj || obj->is_frozen());
     }
 
     NATIVE_FUNCTION(process_id) {
-        return ALLOC_NUMBER(process->get_id());
+        return NUMBER(process->get_id());
     }
 
     NATIVE_FUNCTION(process_join) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_ARG_TO(0, Number, pid);
+        CONVERT_ARG_TO_NUMBER(0, pid);
 
-        ProcessManager::join(pid->get_native_value());
+        ProcessManager::join(pid);
 
         return NONE;
     }
 
-    NATIVE_FUNCTION(process_receive) {
+    NATIVE_FUNCTION(process_profile) {
         EXPECT_NUM_ARGS(0);
 
-        return process->get_mailbox().pop_msg();
+        return ALLOC_STRING(process->get_profiler().get_folded_stacks());
+    }
+
+    NATIVE_FUNCTION(process_receive) {
+        TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(0, timeout);
+
+        if (!timeout) {
+            return process->get_mailbox().pop_msg();
+        }
+
+        // Gives up after timeout seconds, returning the default, if given,
+        // so that a timeout can be told apart from a None message.
+        Value message = process->get_mailbox().pop_msg(deadline_after(*timeout));
+        if (message) return message;
+
+        return frame->num_args() > 1 ? frame->get_arg(1) : NONE;
+    }
+
+    NATIVE_FUNCTION(process_receive_many) {
+        EXPECT_ATLEAST_NUM_ARGS(1);
+
+        CONVERT_ARG_TO_NUMBER(0, max_messages);
+        TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(1, timeout);
+
+        // Waits for the first message only, then takes whatever else is
+        // already queued, up to max_messages.
+        Mailbox& mailbox = process->get_mailbox();
+        Local<Array> messages = ALLOC_EMPTY_ARRAY();
+        if (max_messages < 1) return messages.val();
+
+        Value message = timeout
+            ? mailbox.pop_msg(deadline_after(*timeout))
+            : mailbox.pop_msg();
+        while (message) {
+            messages->push(message);
+            if (messages->size() >= max_messages) break;
+            message = mailbox.try_pop_msg();
+        }
+
+        return messages.val();
     }
 
     NATIVE_FUNCTION(process_send) {
         EXPECT_NUM_ARGS(2);
 
-        CONVERT_ARG_TO(0, Number, pid);
+        CONVERT_ARG_TO_NUMBER(0, pid);
 
-        if (Process* receiver = ProcessManager::get(pid->get_native_value())) {
-            CloneCache cache;
-            receiver->get_heap().add_root_source(&cache);
-            Object* copy = frame->get_arg(1)->clone(receiver, cache);
-            receiver->get_heap().remove_root_source(&cache);
-            receiver->get_mailbox().push_msg(copy);
+        if (Process* receiver = process->get_peer(pid)) {
+            Value message = frame->get_arg(1);
+            send_msg(receiver, message, pack_msg(message, process));
             return BOOLEAN(true);
         }
 
         return BOOLEAN(false);
     }
 
+    NATIVE_FUNCTION(process_scheduler_stats) {
+        EXPECT_NUM_ARGS(0);
+
+        SchedulerStats stats = Scheduler::get_stats();
+
+        Local<Array> workers = ALLOC_EMPTY_ARRAY();
+        for (const WorkerStats& worker_stats : stats.workers) {
+            Local<Object> worker = ALLOC_OBJECT();
+            worker->set_property("queue_depth", NUMBER(worker_stats.queue_depth));
+            worker->set_property("runs", NUMBER(worker_stats.runs));
+            worker->set_property("steals", NUMBER(worker_stats.steals));
+            workers->push(worker.val());
+        }
+
+        Local<Object> obj = ALLOC_OBJECT();
+        obj->set_property("workers", workers.val());
+        obj->set_property("injected_depth", NUMBER(stats.injected_depth));
+        obj->set_property("runnable", NUMBER(stats.runnable));
+
+        return obj.val();
+    }
+
+    NATIVE_FUNCTION(process_send_many) {
+        EXPECT_NUM_ARGS(2);
+
+        CONVERT_ARG_TO(0, Array, pids);
+        Value message = frame->get_arg(1);
+
+        std::vector<Process*> receivers;
+        receivers.reserve(pids->size());
+        for (size_t i = 0; i < pids->size(); i++) {
+            CONVERT_VAL_TO_PRIMITIVE(pids->at(i), number, double, pid);
+            if (Process* receiver = process->get_peer(pid)) {
+                receivers.push_back(receiver);
+            }
+        }
+
+        // The message is packed once and each receiver unpacks its own
+        // copy from the same parcel.
+        ParcelRef parcel = pack_msg(message, process);
+        for (Process* receiver : receivers) {
+            send_msg(receiver, message, parcel);
+        }
+
+        return NUMBER(receivers.size());
+    }
+
     NATIVE_FUNCTION(process_sleep) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_ARG_TO(0, Number, time);
+        CONVERT_ARG_TO_NUMBER(0, time);
+
+        Scheduler::sleep(process, std::chrono::duration<double>(time));
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(process_spawn_pool) {
+        EXPECT_ATLEAST_NUM_ARGS(2);
+
+        CONVERT_ARG_TO_NUMBER(0, count);
+
+        ParcelRef entry = pack_entry(frame, 1, process);
+        Local<Array> pids = ALLOC_EMPTY_ARRAY();
+        for (Process* new_process : ProcessManager::create(count > 0 ? static_cast<size_t>(count) : 0)) {
+            start_process(new_process, entry);
+            pids->push(NUMBER(new_process->get_id()));
+        }
+
+        return pids.val();
+    }
 
-        std::this_thread::sleep_for(
-            std::chrono::duration<double>(time->get_native_value()));
+    NATIVE_FUNCTION(process_start_profiling) {
+        TRY_CONVERT_OPTIONAL_ARG_TO_NUMBER(0, interval);
+
+        process->get_profiler().start(interval
+            ? std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::duration<double, std::milli>(*interval))
+            : Profiler::DEFAULT_INTERVAL);
 
         return NONE;
     }
@@ -103,14 +266,16 @@ namespace modules {
     NATIVE_FUNCTION(process_state) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_ARG_TO(0, Number, pid);
+        CONVERT_ARG_TO_NUMBER(0, pid);
 
-        if (Process* process = ProcessManager::get(pid->get_native_value())) {
+        if (Process* process = ProcessManager::get(pid)) {
             switch (process->get_state()) {
             case Process::State::PENDING:
                 return ALLOC_STRING("pending");
             case Process::State::RUNNING:
                 return ALLOC_STRING("running");
+            case Process::State::WAITING:
+                return ALLOC_STRING("waiting");
             case Process::State::COMPLETED:
                 return ALLOC_STRING("completed");
             }
@@ -119,20 +284,73 @@ namespace modules {
         return ALLOC_STRING("unknown");
     }
 
+    NATIVE_FUNCTION(process_stats) {
+        EXPECT_NUM_ARGS(1);
+
+        CONVERT_ARG_TO_NUMBER(0, pid);
+
+        if (Process* target = ProcessManager::get(pid)) {
+            const Scheduler::Task& task = target->get_task();
+            std::chrono::duration<double, std::milli> run_time = Scheduler::get_run_time(target);
+
+            Local<Object> obj = ALLOC_OBJECT();
+            obj->set_property("run_time", NUMBER(run_time.count()));
+            obj->set_property("runs", NUMBER(task.runs.load()));
+            obj->set_property("migrations", NUMBER(task.migrations.load()));
+
+            const Mailbox& mailbox = target->get_mailbox();
+            obj->set_property("mailbox_depth", NUMBER(mailbox.size()));
+            obj->set_property("mailbox_max_depth", NUMBER(mailbox.get_max_size()));
+            obj->set_property("messages_received", NUMBER(mailbox.get_num_received()));
+            return obj.val();
+        }
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(process_stop_profiling) {
+        EXPECT_NUM_ARGS(0);
+
+        process->get_profiler().stop();
+
+        return NONE;
+    }
+
+    NATIVE_FUNCTION(process_try_receive) {
+        if (Value message = process->get_mailbox().try_pop_msg()) {
+            return message;
+        }
+
+        return frame->num_args() > 0 ? frame->get_arg(0) : NONE;
+    }
+
     MODULE_INITIALIZATION_FUNC(init_process_module) {
         Process* process = module->get_process();
 
         module->set_property("create", ALLOC_NATIVE_FUNCTION(process_create));
+        module->set_property("dump_profile", ALLOC_NATIVE_FUNCTION(process_dump_profile));
+        module->set_property("freeze", ALLOC_NATIVE_FUNCTION(process_freeze));
+        module->set_property("frozen", ALLOC_NATIVE_FUNCTION(process_frozen));
         module->set_property("id", ALLOC_NATIVE_FUNCTION(process_id));
         module->set_property("join", ALLOC_NATIVE_FUNCTION(process_join));
+        module->set_property("profile", ALLOC_NATIVE_FUNCTION(process_profile));
         module->set_property("receive", ALLOC_NATIVE_FUNCTION(process_receive));
+        module->set_property("receive_many", ALLOC_NATIVE_FUNCTION(process_receive_many));
+        module->set_property("scheduler_stats", ALLOC_NATIVE_FUNCTION(process_scheduler_stats));
         module->set_property("send", ALLOC_NATIVE_FUNCTION(process_send));
+        module->set_property("send_many", ALLOC_NATIVE_FUNCTION(process_send_many));
         module->set_property("sleep", ALLOC_NATIVE_FUNCTION(process_sleep));
+        module->set_property("spawn_pool", ALLOC_NATIVE_FUNCTION(process_spawn_pool));
+        module->set_property("start_profiling", ALLOC_NATIVE_FUNCTION(process_start_profiling));
         module->set_property("state", ALLOC_NATIVE_FUNCTION(process_state));
+        module->set_property("stats", ALLOC_NATIVE_FUNCTION(process_stats));
+        module->set_property("stop_profiling", ALLOC_NATIVE_FUNCTION(process_stop_profiling));
+        module->set_property("try_receive", ALLOC_NATIVE_FUNCTION(process_try_receive));
 
         Local<Object> states = ALLOC_OBJECT();
         states->set_property("pending", ALLOC_STRING("pending"));
         states->set_property("running", ALLOC_STRING("running"));
+        states->set_property("waiting", ALLOC_STRING("waiting"));
         states->set_property("completed", ALLOC_STRING("completed"));
         module->set_property("States", states.val());
     }
@@ -15,6 +15,8 @@
 **  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <unordered_set>
+
 #include "emerald/native_objects.h"
 #include "emerald/magic_methods.h"
 #include "emerald/natives/array.h"
@@ -29,7 +31,10 @@
 
 namespace emerald {
 
-    NativeObjects::NativeObjects(Process* process) {
+    NativeObjects::NativeObjects(Process* process)
+        : _builtin_number_ops(true),
+        _builtin_string_ops(true),
+        _builtin_boolean_ops(true) {
         initialize_object(process);
         initialize_array(process);
         initialize_booleans(process);
@@ -38,6 +43,15 @@ namespace emerald {
         initialize_string(process);
 
         _null = process->get_heap().allocate<Null>(process);
+
+        _number->set_watched(true);
+        _string->set_watched(true);
+
+        // Booleans are converted by the __boolean__ they find through these.
+        _object->set_watched(true);
+        _boolean->set_watched(true);
+        _true->set_watched(true);
+        _false->set_watched(true);
     }
 
     const Object* NativeObjects::get_object_prototype() const {
@@ -112,6 +126,40 @@ namespace emerald {
         return _null;
     }
 
+    bool NativeObjects::has_builtin_number_ops() const {
+        return _builtin_number_ops;
+    }
+
+    bool NativeObjects::has_builtin_string_ops() const {
+        return _builtin_string_ops;
+    }
+
+    bool NativeObjects::has_builtin_boolean_ops() const {
+        return _builtin_boolean_ops;
+    }
+
+    void NativeObjects::property_changed(Object* obj, Atom key) {
+        static const std::unordered_set<Atom> number_ops = {
+            magic_methods::add, magic_methods::sub, magic_methods::mul, magic_methods::div, magic_methods::mod,
+            magic_methods::iadd, magic_methods::isub, magic_methods::imul, magic_methods::idiv, magic_methods::imod,
+            magic_methods::eq, magic_methods::neq, magic_methods::lt, magic_methods::gt, magic_methods::lte, magic_methods::gte,
+            magic_methods::bit_or, magic_methods::bit_xor, magic_methods::bit_and, magic_methods::bit_shl, magic_methods::bit_shr
+        };
+        static const std::unordered_set<Atom> string_ops = {
+            magic_methods::add, magic_methods::eq, magic_methods::neq
+        };
+
+        if (obj == _number && number_ops.count(key)) {
+            _builtin_number_ops = false;
+        } else if (obj == _string && string_ops.count(key)) {
+            _builtin_string_ops = false;
+        }
+
+        if ((obj == _object || obj == _boolean || obj == _true || obj == _false) && key == magic_methods::boolean) {
+            _builtin_boolean_ops = false;
+        }
+    }
+
     std::vector<HeapManaged*> NativeObjects::get_roots() {
         return std::vector<HeapManaged*>({
             _object,
@@ -41,8 +41,16 @@ namespace emerald {
         return _stack.back();
     }
 
-    NativeStack::NativeFrame& NativeStack::push_frame(Object* receiver, const std::vector<Object*>& args, Module* globals) {
-        NativeFrame frame(*this, receiver, args, globals);
+    NativeStack::NativeFrame& NativeStack::push_frame(Value receiver, const std::vector<Value>& args, Module* globals) {
+        NativeFrame frame(*this, receiver, args, 0, args.size(), false, globals);
+        _stack.push_back(std::move(frame));
+        return _stack.back();
+    }
+
+    NativeStack::NativeFrame& NativeStack::push_frame(Value receiver, const std::vector<Value>& values, size_t num_args, Module* globals) {
+        CHECK_THROW_LOGIC_ERROR(num_args <= values.size(), "cannot pass more arguments than are on the stack");
+
+        NativeFrame frame(*this, receiver, values, values.size() - num_args, num_args, true, globals);
         _stack.push_back(std::move(frame));
         return _stack.back();
     }
@@ -50,9 +58,15 @@ namespace emerald {
     std::vector<HeapManaged*> NativeStack::get_roots() {
         std::vector<HeapManaged*> roots;
         for (NativeFrame& frame : _stack) {
-            if (Object* receiver = frame.get_receiver()) {
+            if (Object* receiver = frame.get_receiver().get_object()) {
                 roots.push_back(receiver);
             }
+
+            for (size_t i = 0; i < frame.num_args(); i++) {
+                if (Object* obj = frame.get_arg(i).get_object()) {
+                    roots.push_back(obj);
+                }
+            }
             
             if (Module* globals = frame.get_globals()) {
                 roots.push_back(globals);
@@ -67,12 +81,27 @@ namespace emerald {
     }
 
     NativeStack::NativeFrame::NativeFrame(NativeStack& stack)
-        : _stack(stack) {}
-
-    NativeStack::NativeFrame::NativeFrame(NativeStack& stack, Object* receiver, const std::vector<Object*>& args, Module* globals)
+        : _stack(stack),
+        _args(nullptr),
+        _args_begin(0),
+        _num_args(0),
+        _args_reversed(false),
+        _globals(nullptr) {}
+
+    NativeStack::NativeFrame::NativeFrame(
+            NativeStack& stack,
+            Value receiver,
+            const std::vector<Value>& args,
+            size_t args_begin,
+            size_t num_args,
+            bool args_reversed,
+            Module* globals)
         : _stack(stack), 
         _receiver(receiver),
-        _args(args),
+        _args(&args),
+        _args_begin(args_begin),
+        _num_args(num_args),
+        _args_reversed(args_reversed),
         _globals(globals) {}
 
     NativeStack& NativeStack::NativeFrame::get_stack() {
@@ -83,28 +112,22 @@ namespace emerald {
         return _stack;
     }
 
-    Object* NativeStack::NativeFrame::get_receiver() {
+    Value NativeStack::NativeFrame::get_receiver() const {
         return _receiver;
     }
 
-    const Object* NativeStack::NativeFrame::get_receiver() const {
-        return _receiver;
-    }
-
-    const std::vector<Object*>& NativeStack::NativeFrame::get_args() const {
-        return _args;
-    }
-
     size_t NativeStack::NativeFrame::num_args() const {
-        return _args.size();
+        return _num_args;
     }
 
-    Object* NativeStack::NativeFrame::get_arg(size_t i) {
-        return _args.at(i);
-    }
+    Value NativeStack::NativeFrame::get_arg(size_t i) const {
+        CHECK_THROW_LOGIC_ERROR(i < _num_args, "arg index out of range");
 
-    const Object* NativeStack::NativeFrame::get_arg(size_t i) const {
-        return _args.at(i);
+        if (_args_reversed) {
+            return (*_args)[_args_begin + _num_args - i - 1];
+        }
+
+        return (*_args)[_args_begin + i];
     }
 
     const Module* NativeStack::NativeFrame::get_globals() const {
@@ -115,17 +138,12 @@ namespace emerald {
         return _globals;
     }
 
-    const Object* NativeStack::NativeFrame::get_global(const std::string& name) const {
-        if (_globals) return _globals->get_property(name);
-        return nullptr;
-    }
-
-    Object* NativeStack::NativeFrame::get_global(const std::string& name) {
+    Value NativeStack::NativeFrame::get_global(Atom name) const {
         if (_globals) return _globals->get_property(name);
-        return nullptr;
+        return Value();
     }
 
-    void NativeStack::NativeFrame::set_global(const std::string& name, Object* val) {
+    void NativeStack::NativeFrame::set_global(Atom name, Value val) {
         if (_globals) _globals->set_property(name, val);
     }
 
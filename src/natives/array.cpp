@@ -30,7 +30,7 @@ namespace natives {
         CONVERT_RECV_TO(Array, self);
 
         if (TRY_CONVERT_ARG_TO(0, Array, other)) {
-            return self->eq(other);
+            return BOOLEAN(self->eq(other));
         }
 
         return BOOLEAN(false);
@@ -42,7 +42,7 @@ namespace natives {
         CONVERT_RECV_TO(Array, self);
 
         if (TRY_CONVERT_ARG_TO(0, Array, other)) {
-            return self->neq(other);
+            return BOOLEAN(self->neq(other));
         }
 
         return BOOLEAN(true);
@@ -80,9 +80,13 @@ namespace natives {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Array, self);
-        CONVERT_ARG_TO(0, Number, index);
+        CONVERT_ARG_TO_NUMBER(0, index);
 
-        return self->at(index);
+        if (Value val = self->at(index)) {
+            return val;
+        }
+
+        return NONE;
     }
 
     NATIVE_FUNCTION(array_front) {
@@ -106,7 +110,7 @@ namespace natives {
 
         CONVERT_RECV_TO(Array, self);
 
-        return self->empty();
+        return BOOLEAN(self->empty());
     }
 
     NATIVE_FUNCTION(array_size) {
@@ -114,7 +118,7 @@ namespace natives {
 
         CONVERT_RECV_TO(Array, self);
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(array_clear) {
@@ -137,7 +141,7 @@ namespace natives {
             self->push(frame->get_arg(i));
         }
 
-        return self->size();
+        return NUMBER(self->size());
     }
 
     NATIVE_FUNCTION(array_pop) {
@@ -162,15 +166,15 @@ namespace natives {
 
         CONVERT_RECV_TO(Array, self);
 
-        Object* elem = frame->get_arg(0);
-        for (size_t i = 0; i < self->size()->get_native_value(); i++) {
-            Boolean* eq = Interpreter::execute_method<Boolean>(self->at(ALLOC_NUMBER(i)), magic_methods::eq, { elem }, process);
-            if (eq->get_native_value()) {
-                return ALLOC_NUMBER(i);
+        Value elem = frame->get_arg(0);
+        for (size_t i = 0; i < self->size(); i++) {
+            bool eq = Interpreter::execute_method<bool>(self->at(i), magic_methods::eq, { elem }, process);
+            if (eq) {
+                return NUMBER(i);
             } 
         }
 
-        return ALLOC_NUMBER(-1);
+        return NUMBER(-1);
     }
 
     NATIVE_FUNCTION(array_iterator_cur) {
@@ -186,7 +190,7 @@ namespace natives {
 
         CONVERT_RECV_TO(ArrayIterator, self);
 
-        return self->done();
+        return BOOLEAN(self->done());
     }
 
     NATIVE_FUNCTION(array_iterator_next) {
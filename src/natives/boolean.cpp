@@ -29,9 +29,9 @@ namespace natives {
     NATIVE_FUNCTION(boolean_eq) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Boolean, self);
-        if (TRY_CONVERT_ARG_TO(0, Boolean, other)) {
-            return self->eq(other);
+        CONVERT_RECV_TO_BOOLEAN(self);
+        if (TRY_CONVERT_ARG_TO_BOOLEAN(0, other)) {
+            return BOOLEAN(self == *other);
         }
 
         return BOOLEAN(false);
@@ -40,9 +40,9 @@ namespace natives {
     NATIVE_FUNCTION(boolean_neq) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Boolean, self);
-        if (TRY_CONVERT_ARG_TO(0, Boolean, other)) {
-            return self->neq(other);
+        CONVERT_RECV_TO_BOOLEAN(self);
+        if (TRY_CONVERT_ARG_TO_BOOLEAN(0, other)) {
+            return BOOLEAN(self != *other);
         }
 
         return BOOLEAN(true);
@@ -51,16 +51,19 @@ namespace natives {
     NATIVE_FUNCTION(boolean_clone) {
         EXPECT_NUM_ARGS(0);
 
-        CONVERT_RECV_TO(Boolean, self);
+        CONVERT_RECV_TO_BOOLEAN(self);
 
-        return process->get_heap().allocate<Boolean>(process, self);
+        return process->get_heap().allocate<Boolean>(
+            process,
+            frame->get_receiver().to_object(process),
+            self);
     }
 
     NATIVE_FUNCTION(boolean_init) {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Boolean, self);
-        Boolean* val = Interpreter::execute_method<Boolean>(
+        bool val = Interpreter::execute_method<bool>(
             frame->get_arg(0),
             magic_methods::boolean,
             {},
@@ -25,223 +25,216 @@ namespace natives {
     NATIVE_FUNCTION(number_neg) {
         EXPECT_NUM_ARGS(0);
 
-        CONVERT_RECV_TO(Number, val);
+        CONVERT_RECV_TO_NUMBER(val);
 
-        return ALLOC_NUMBER(-val->get_native_value());
+        return NUMBER(-val);
     }
 
     NATIVE_FUNCTION(number_add) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER(lhs->get_native_value() + rhs->get_native_value());
+        return NUMBER(lhs + rhs);
     }
 
     NATIVE_FUNCTION(number_sub) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER(lhs->get_native_value() - rhs->get_native_value());
+        return NUMBER(lhs - rhs);
     }
 
     NATIVE_FUNCTION(number_mul) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER(lhs->get_native_value() * rhs->get_native_value());
+        return NUMBER(lhs * rhs);
     }
 
     NATIVE_FUNCTION(number_div) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER(lhs->get_native_value() / rhs->get_native_value());
+        return NUMBER(lhs / rhs);
     }
 
     NATIVE_FUNCTION(number_mod) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() % (long)rhs->get_native_value());
+        return NUMBER((long)lhs % (long)rhs);
     }
 
     NATIVE_FUNCTION(number_iadd) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        lhs->set_native_value(lhs->get_native_value() + rhs->get_native_value());
-
-        return lhs;
+        return NUMBER(lhs + rhs);
     }
 
     NATIVE_FUNCTION(number_isub) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
-
-        lhs->set_native_value(lhs->get_native_value() - rhs->get_native_value());
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return lhs;
+        return NUMBER(lhs - rhs);
     }
 
     NATIVE_FUNCTION(number_imul) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
-
-        lhs->set_native_value(lhs->get_native_value() * rhs->get_native_value());
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return lhs;
+        return NUMBER(lhs * rhs);
     }
 
     NATIVE_FUNCTION(number_idiv) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        lhs->set_native_value(lhs->get_native_value() / rhs->get_native_value());
-
-        return lhs;
+        return NUMBER(lhs / rhs);
     }
 
     NATIVE_FUNCTION(number_imod) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
-
-        lhs->set_native_value((long)lhs->get_native_value() % (long)rhs->get_native_value());
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return lhs;
+        return NUMBER((long)lhs % (long)rhs);
     }
 
     NATIVE_FUNCTION(number_eq) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() == rhs->get_native_value());
+        return BOOLEAN(lhs == rhs);
     }
 
     NATIVE_FUNCTION(number_neq) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() != rhs->get_native_value());
+        return BOOLEAN(lhs != rhs);
     }
 
     NATIVE_FUNCTION(number_lt) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() < rhs->get_native_value());
+        return BOOLEAN(lhs < rhs);
     }
 
     NATIVE_FUNCTION(number_gt) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() > rhs->get_native_value());
+        return BOOLEAN(lhs > rhs);
     }
 
     NATIVE_FUNCTION(number_lte) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() <= rhs->get_native_value());
+        return BOOLEAN(lhs <= rhs);
     }
 
     NATIVE_FUNCTION(number_gte) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return BOOLEAN(lhs->get_native_value() >= rhs->get_native_value());
+        return BOOLEAN(lhs >= rhs);
     }
 
     NATIVE_FUNCTION(number_bit_or) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() | (long)rhs->get_native_value());
+        return NUMBER((long)lhs | (long)rhs);
     }
 
     NATIVE_FUNCTION(number_bit_xor) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() ^ (long)rhs->get_native_value());
+        return NUMBER((long)lhs ^ (long)rhs);
     }
 
     NATIVE_FUNCTION(number_bit_and) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() & (long)rhs->get_native_value());
+        return NUMBER((long)lhs & (long)rhs);
     }
 
     NATIVE_FUNCTION(number_bit_shl) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() << (long)rhs->get_native_value());
+        return NUMBER((long)lhs << (long)rhs);
     }
 
     NATIVE_FUNCTION(number_bit_shr) {
         EXPECT_NUM_ARGS(1);
 
-        CONVERT_RECV_TO(Number, lhs);
-        CONVERT_ARG_TO(0, Number, rhs);
+        CONVERT_RECV_TO_NUMBER(lhs);
+        CONVERT_ARG_TO_NUMBER(0, rhs);
 
-        return ALLOC_NUMBER((long)lhs->get_native_value() >> (long)rhs->get_native_value());
+        return NUMBER((long)lhs >> (long)rhs);
     }
 
     NATIVE_FUNCTION(number_clone) {
         EXPECT_NUM_ARGS(0);
 
-        CONVERT_RECV_TO(Number, self);
+        CONVERT_RECV_TO_NUMBER(self);
 
-        return process->get_heap().allocate<Number>(process, self);
+        return process->get_heap().allocate<Number>(
+            process,
+            frame->get_receiver().to_object(process),
+            self);
     }
 
     NATIVE_FUNCTION(number_init) {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(Number, self);
-        CONVERT_ARG_TO(0, Number, val);
+        CONVERT_ARG_TO_NUMBER(0, val);
         self->init(val);
 
         return NONE;
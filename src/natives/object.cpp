@@ -38,19 +38,19 @@ namespace natives {
     NATIVE_FUNCTION(object_str) {
         EXPECT_NUM_ARGS(0);
 
-        return ALLOC_STRING(frame->get_receiver()->as_str());
+        return ALLOC_STRING(frame->get_receiver().as_str());
     }
 
     NATIVE_FUNCTION(object_boolean) {
         EXPECT_NUM_ARGS(0);
 
-        return BOOLEAN(frame->get_receiver()->as_bool());
+        return BOOLEAN(frame->get_receiver().as_bool());
     }
 
     NATIVE_FUNCTION(object_clone) {
         EXPECT_NUM_ARGS(0);
 
-        CONVERT_RECV_TO(Object, self);
+        Object* self = frame->get_receiver().to_object(process);
 
         return process->get_heap().allocate<Object>(process, self);
     }
@@ -63,8 +63,8 @@ namespace natives {
         EXPECT_NUM_ARGS(0);
 
         Local<Array> keys = ALLOC_EMPTY_ARRAY();
-        for (const auto& pair : frame->get_receiver()->get_properties()) {
-            keys->push(ALLOC_STRING(pair.first));
+        for (Atom key : frame->get_receiver().to_object(process)->get_property_keys()) {
+            keys->push(ALLOC_STRING(key.get_str()));
         }
 
         return keys.val();
@@ -75,7 +75,7 @@ namespace natives {
 
         CONVERT_ARG_TO(0, String, name);
 
-        if (Object* property = frame->get_receiver()->get_property(name->get_native_value())) {
+        if (Value property = Interpreter::get_property(frame->get_receiver(), name->get_native_value(), process)) {
             return property;
         }
 
@@ -86,7 +86,7 @@ namespace natives {
         EXPECT_NUM_ARGS(2);
 
         CONVERT_ARG_TO(0, String, name);
-        frame->get_receiver()->set_property(name->get_native_value(), frame->get_arg(1));
+        frame->get_receiver().to_object(process)->set_property(name->get_native_value(), frame->get_arg(1));
 
         return NONE;
     }
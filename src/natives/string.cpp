@@ -95,7 +95,7 @@ namespace natives {
         CONVERT_RECV_TO(String, self);
         CONVERT_ARG_TO(0, String, str);
 
-        self->get_native_value().append(str->get_native_value());
+        self->append(str->get_native_value());
 
         return self;
     }
@@ -121,16 +121,16 @@ namespace natives {
 
         CONVERT_RECV_TO(String, self);
 
-        return ALLOC_NUMBER(self->get_native_value().size());
+        return NUMBER(self->get_native_value().size());
     }
 
     NATIVE_FUNCTION(string_at) {
         EXPECT_NUM_ARGS(1);
 
         CONVERT_RECV_TO(String, self);
-        CONVERT_ARG_TO(0, Number, index);
+        CONVERT_ARG_TO_NUMBER(0, index);
 
-        return ALLOC_STRING(std::string(1, self->get_native_value()[(long)index->get_native_value()]));
+        return ALLOC_STRING(std::string(1, self->get_native_value()[(long)index]));
     }
 
     NATIVE_FUNCTION(string_back) {
@@ -155,7 +155,7 @@ namespace natives {
         CONVERT_RECV_TO(String, self);
         CONVERT_ARG_TO(0, String, other);
 
-        return ALLOC_NUMBER(self->get_native_value().compare(other->get_native_value()));
+        return NUMBER(self->get_native_value().compare(other->get_native_value()));
     }
 
     NATIVE_FUNCTION(string_find) {
@@ -164,17 +164,17 @@ namespace natives {
         CONVERT_RECV_TO(String, self);
         CONVERT_ARG_TO(0, String, other);
 
-        return ALLOC_NUMBER(self->get_native_value().find(other->get_native_value()));
+        return NUMBER(self->get_native_value().find(other->get_native_value()));
     }
 
     NATIVE_FUNCTION(string_substr) {
         EXPECT_NUM_ARGS(2);
 
         CONVERT_RECV_TO(String, self);
-        CONVERT_ARG_TO(0, Number, pos);
-        CONVERT_ARG_TO(1, Number, len);
+        CONVERT_ARG_TO_NUMBER(0, pos);
+        CONVERT_ARG_TO_NUMBER(1, len);
 
-        return ALLOC_STRING(self->get_native_value().substr(pos->get_native_value(), len->get_native_value()));
+        return ALLOC_STRING(self->get_native_value().substr(pos, len));
     }
 
     NATIVE_FUNCTION(string_format) {
@@ -183,7 +183,7 @@ namespace natives {
         std::vector<fmt::format_args::format_arg> fmt_args;
         size_t n = frame->num_args();
         for (size_t i = 0; i < n; i++) {
-            String* arg = Interpreter::execute_method<String>(frame->get_arg(i), magic_methods::str, {}, process);
+            String* arg = Interpreter::execute_method<String*>(frame->get_arg(i), magic_methods::str, {}, process);
             fmt_args.push_back(fmt::internal::make_arg<fmt::format_context>(arg->get_native_value()));
         }
 
@@ -213,7 +213,7 @@ namespace natives {
         CONVERT_RECV_TO(String, self);
         CONVERT_ARG_TO(0, String, str);
 
-        self->get_native_value().append(str->get_native_value());
+        self->append(str->get_native_value());
 
         return self;
     }
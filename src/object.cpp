@@ -28,13 +28,25 @@
 
 namespace emerald {
 
-    Object::Object(Process* process)
+    Object::Object(Process* process, Type type)
         : _process(process), 
-        _parent(nullptr) {}
+        _parent(nullptr),
+        _type(type),
+        _shape(process->get_shape_tree().get_root()),
+        _watched(false),
+        _prototype(false) {}
 
-    Object::Object(Process* process, Object* parent)
+    Object::Object(Process* process, Object* parent, Type type)
         : _process(process), 
-        _parent(parent) {}
+        _parent(parent),
+        _type(type),
+        _shape(process->get_shape_tree().get_root()),
+        _watched(false),
+        _prototype(false) {
+        if (_parent) {
+            _parent->make_prototype();
+        }
+    }
 
     Object::~Object() {}
 
@@ -54,230 +66,428 @@ namespace emerald {
         return _parent;
     }
 
-    const std::unordered_map<std::string, PropertyDescriptor*>& Object::get_properties() const {
-        return _properties;
+    Shape* Object::get_shape() const {
+        return _shape;
     }
 
-    Object* Object::get_property(const std::string& key) const {
-        if (PropertyDescriptor* descriptor = get_property_descriptor(key)) {
-            return get_property_value(descriptor);
-        }
+    size_t Object::num_properties() const {
+        return _slots.size();
+    }
 
-        return nullptr;
+    std::vector<Atom> Object::get_property_keys() const {
+        return _shape->get_keys();
+    }
+
+    Value Object::get_slot(size_t slot) const {
+        return _slots[slot];
+    }
+
+    void Object::set_slot(size_t slot, Value value) {
+        write_barrier(value);
+        _slots[slot] = value;
     }
 
-    Object* Object::get_own_property(const std::string& key) const {
-        if (PropertyDescriptor* descriptor = get_own_property_descriptor(key)) {
-            return get_property_value(descriptor);
+    Object* Object::find_property_holder(Atom key, Shape::Property& property) const {
+        for (const Object* obj = this; obj; obj = obj->_parent) {
+            if (obj->_shape->lookup(key, property)) {
+                return const_cast<Object*>(obj);
+            }
         }
 
         return nullptr;
     }
 
-    PropertyDescriptor* Object::get_property_descriptor(const std::string& key) const {
-        if (PropertyDescriptor* descriptor = get_own_property_descriptor(key)) {
-            return descriptor;
+    Value Object::get_property(Atom key) const {
+        Shape::Property property;
+        if (Object* holder = find_property_holder(key, property)) {
+            return get_property_value(holder, property);
         }
 
-        if (_parent) {
-            return _parent->get_property_descriptor(key);
+        return Value();
+    }
+
+    Value Object::get_own_property(Atom key) const {
+        Shape::Property property;
+        if (_shape->lookup(key, property)) {
+            return get_property_value(this, property);
         }
 
-        return nullptr;
+        return Value();
     }
 
-    PropertyDescriptor* Object::get_own_property_descriptor(const std::string& key) const {
-        if (has_own_property(key)) {
-            return _properties.at(key);
-        }
+    bool Object::has_property(Atom key) const {
+        Shape::Property property;
+        return find_property_holder(key, property) != nullptr;
+    }
 
-        return nullptr;
+    bool Object::has_own_property(Atom key) const {
+        Shape::Property property;
+        return _shape->lookup(key, property);
     }
 
-    bool Object::has_property(const std::string& key) const {
-        if (has_own_property(key)) {
-            return true;
-        }
+    bool Object::is_watched() const {
+        return _watched;
+    }
 
-        if (_parent != nullptr) {
-            return _parent->has_property(key);
-        }
+    void Object::set_watched(bool watched) {
+        _watched = watched;
+    }
 
-        return false;
+    bool Object::is_prototype() const {
+        return _prototype;
     }
 
-    bool Object::has_own_property(const std::string& key) const {
-        return _properties.find(key) != _properties.end();
+    bool Object::is_frozen() const {
+        return _frozen != nullptr;
     }
 
-    void Object::define_property(const std::string& key, PropertyDescriptor* descriptor) {
-        _properties[key] = descriptor;
+    const FrozenRef& Object::get_frozen() const {
+        return _frozen;
     }
 
-    void Object::set_property(const std::string& key, Object* value) {
-        if (PropertyDescriptor* descriptor = get_own_property_descriptor(key)) {
-            if (descriptor->get_type() == PropertyDescriptor::DATA) {
-                descriptor->set_value(value);
-            } else if (Object* setter = descriptor->get_setter()) {
-                Interpreter::call_obj<Object>(
-                    setter,
-                    this,
-                    { value },
-                    _process);
-            }
-        } else if (PropertyDescriptor* descriptor = get_property_descriptor(key);
-                descriptor && descriptor->get_type() == PropertyDescriptor::ACCESSOR) {
+    void Object::define_property(Atom key, Value value) {
+        ensure_mutable();
+
+        if (_watched) {
+            _process->get_native_objects().property_changed(this, key);
+        }
+
+        Shape::Property property;
+        if (_shape->lookup(key, property)) {
+            replace_slot(key, property, value, false);
+        } else {
+            add_slot(key, value, false);
+        }
+    }
+
+    void Object::define_property(Atom key, PropertyDescriptor* descriptor) {
+        ensure_mutable();
+
+        if (_watched) {
+            _process->get_native_objects().property_changed(this, key);
+        }
+
+        Shape::Property property;
+        if (_shape->lookup(key, property)) {
+            replace_slot(key, property, descriptor, true);
+        } else {
+            add_slot(key, descriptor, true);
+        }
+    }
+
+    void Object::set_property(Atom key, Value value) {
+        ensure_mutable();
+
+        if (_watched) {
+            _process->get_native_objects().property_changed(this, key);
+        }
+
+        Shape::Property property;
+        Object* holder = find_property_holder(key, property);
+        if (holder && property.accessor) {
+            PropertyDescriptor* descriptor = static_cast<PropertyDescriptor*>(holder->_slots[property.slot].get_object());
             if (Object* setter = descriptor->get_setter()) {
-                Interpreter::call_obj<Object>(
+                Interpreter::call_obj<Value>(
                     setter,
                     this,
                     { value },
                     _process);
             }
+        } else if (holder == this) {
+            write_barrier(value);
+            _slots[property.slot] = value;
         } else {
-            _properties[key] = _process->get_heap().allocate<PropertyDescriptor>(_process, value);
+            add_slot(key, value, false);
         }
     }
 
+    void Object::add_property(Shape* transition, Value value) {
+        if (_prototype) {
+            _process->get_shape_tree().invalidate_prototypes();
+        }
+
+        _shape = transition;
+        write_barrier(value);
+        _slots.push_back(value);
+    }
+
     Object* Object::clone(Process* process, CloneCache& cache) {
+        if (_frozen) {
+            return clone_frozen(process, cache);
+        }
+
         return clone_impl<Object>(process, cache);
     } 
 
-    void Object::reach() {
+    std::unique_ptr<Parcel::Native> Object::pack(std::vector<Value>&) const {
+        return nullptr;
+    }
+
+    void Object::reach(MarkStack& stack) {
         if (_parent != nullptr) {
-            _parent->mark();
+            _parent->mark(stack);
         }
 
-        for (std::pair<std::string, PropertyDescriptor*> pair : get_properties()) {
-            pair.second->mark();
+        for (Value val : _slots) {
+            val.mark(stack);
         }
     }
 
-    Object* Object::get_property_value(PropertyDescriptor* descriptor) const {
-        if (descriptor->get_type() == PropertyDescriptor::DATA) {
-            return descriptor->get_value();
+    Value Object::get_property_value(const Object* holder, const Shape::Property& property) const {
+        Value val = holder->_slots[property.slot];
+        if (!property.accessor) {
+            return val;
         }
 
-        return Interpreter::call_obj<Object>(
-            descriptor->get_getter(),
+        return Interpreter::call_obj<Value>(
+            static_cast<PropertyDescriptor*>(val.get_object())->get_getter(),
             const_cast<Object*>(this),
             {},
             _process);
     }
 
-    Array::Array(Process* process, const std::vector<Object*>& value)
-        : Object(process, ARRAY_PROTOTYPE),
+    void Object::ensure_mutable() const {
+        if (_frozen) {
+            throw ALLOC_EXCEPTION_IN_CTX("cannot modify a frozen object", _process);
+        }
+    }
+
+    Object* Object::clone_frozen(Process* process, CloneCache& cache) {
+        if (Object* obj = cache.get_clone(this)) {
+            return obj;
+        }
+
+        Object* obj = Frozen::thaw(_frozen, process);
+        cache.add_clone(this, obj);
+        return obj;
+    }
+
+    void Object::write_barrier(Value val) {
+        if (val.is_object()) {
+            write_barrier(val.get_object());
+        }
+    }
+
+    void Object::write_barrier(HeapManaged* managed) {
+        if (!managed || !is_old()) return;
+
+        if (!managed->is_old()) {
+            if (!is_remembered()) {
+                _process->get_heap().remember(this);
+            }
+        } else if (_process->get_heap().is_marking() && is_marked() && !managed->is_marked()) {
+            // A marked object won't be traced again, so the incremental
+            // marker has to be told about the new reference.
+            _process->get_heap().shade(managed);
+        }
+    }
+
+    void Object::make_prototype() {
+        if (!_prototype) {
+            _prototype = true;
+            _process->get_shape_tree().invalidate_prototypes();
+        }
+    }
+
+    void Object::add_slot(Atom key, Value value, bool accessor) {
+        if (_prototype) {
+            _process->get_shape_tree().invalidate_prototypes();
+        }
+
+        if (_shape->is_dictionary()) {
+            _shape->add_dictionary_key(key, accessor);
+        } else if (_shape->get_num_slots() < Shape::MAX_TREE_SLOTS) {
+            _shape = _shape->get_transition(key, accessor);
+        } else {
+            _dictionary_shape = _shape->to_dictionary();
+            _shape = _dictionary_shape.get();
+            _shape->add_dictionary_key(key, accessor);
+        }
+
+        write_barrier(value);
+        _slots.push_back(value);
+    }
+
+    void Object::replace_slot(Atom key, const Shape::Property& property, Value value, bool accessor) {
+        if (property.accessor != accessor) {
+            // Changing the kind of a property changes how objects
+            // inheriting it are written to.
+            if (_prototype) {
+                _process->get_shape_tree().invalidate_prototypes();
+            }
+
+            // The transition tree only describes properties in the order
+            // they were added, so the kind is changed on a private shape.
+            if (!_shape->is_dictionary()) {
+                _dictionary_shape = _shape->to_dictionary();
+                _shape = _dictionary_shape.get();
+            }
+            _shape->set_dictionary_accessor(key, accessor);
+        }
+
+        write_barrier(value);
+        _slots[property.slot] = value;
+    }
+
+    Array::Array(Process* process, const std::vector<Value>& value)
+        : Object(process, ARRAY_PROTOTYPE, TYPE),
         _value(value) {}
 
-    Array::Array(Process* process, Object* parent, const std::vector<Object*>& value)
-        : Object(process, parent),
+    Array::Array(Process* process, Object* parent, const std::vector<Value>& value)
+        : Object(process, parent, TYPE),
         _value(value) {}
 
     bool Array::as_bool() const {
-        return _value.size() > 0;
+        return size() > 0;
     }
     
     std::string Array::as_str() const {
+        const std::vector<Value>& values = get_values();
         return "[" +
-            objectutils::join_range(_value.begin(), _value.end(), ",", get_process())
+            objectutils::join_range(values.begin(), values.end(), ",", get_process())
         + "]";
     }
 
-    void Array::init(Object* iterator) {
+    void Array::init(Value iterator) {
+        ensure_mutable();
+
         objectutils::ObjectIterator iter = objectutils::ObjectIterator(get_process(), iterator);
         while (!iter.done()) {
-            _value.push_back(iter.cur());
+            push(iter.cur());
             iter.next();
         }
     }
 
-    Object* Array::at(Number* n) const {
-        size_t i = n->get_native_value();
-        if (i >= _value.size()) {
-            return nullptr;
+    Value Array::at(size_t i) const {
+        if (i >= size()) {
+            return Value();
+        }
+
+        if (is_frozen()) {
+            // Immediates are read straight from the frozen array.
+            const Frozen::Element& element = get_frozen()->get_elements()[i];
+            if (!element.frozen) {
+                return element.immediate;
+            }
         }
 
-        return _value[i];
+        return get_values()[i];
     }
 
-    Object* Array::front() const {
-        return _value.front();
+    Value Array::front() const {
+        return get_values().front();
     }
 
-    Object* Array::back() const {
-        return _value.back();
+    Value Array::back() const {
+        return get_values().back();
     }
 
-    Boolean* Array::empty() const {
-        return BOOLEAN_IN_CTX(_value.empty(), get_process());
+    bool Array::empty() const {
+        return size() == 0;
     }
 
-    Number* Array::size() {
-        return ALLOC_NUMBER_IN_CTX(_value.size(), get_process());
+    size_t Array::size() const {
+        return is_frozen() ? get_frozen()->get_elements().size() : _value.size();
     }
 
     void Array::clear() {
+        ensure_mutable();
+
         _value.clear();
     }
 
-    void Array::push(Object* obj) {
-        _value.push_back(obj);
+    void Array::push(Value val) {
+        ensure_mutable();
+
+        write_barrier(val);
+        _value.push_back(val);
     }
 
-    Object* Array::pop() {
-        Object* obj = _value.back();
+    Value Array::pop() {
+        ensure_mutable();
+
+        Value val = _value.back();
         _value.pop_back();
-        return obj;
+        return val;
     }
 
     String* Array::join(String* seperator) const {
         Process* process = get_process();
+        const std::vector<Value>& values = get_values();
         return ALLOC_STRING(objectutils::join_range(
-            _value.begin(),
-            _value.end(),
+            values.begin(),
+            values.end(),
             seperator->get_native_value(),
             process));
     }
 
-    Boolean* Array::eq(Array* other) const {
-        return BOOLEAN_IN_CTX(_eq(other), get_process());
+    bool Array::eq(Array* other) const {
+        return _eq(other);
     }
 
-    Boolean* Array::neq(Array* other) const {
-        return BOOLEAN_IN_CTX(!_eq(other), get_process());
+    bool Array::neq(Array* other) const {
+        return !_eq(other);
     }
 
     Array* Array::clone(Process* process, CloneCache& cache) {
-        Array* clone = clone_impl<Array>(process, cache, _value);
-        for (Object* obj : _value) {
-            clone->_value.push_back(obj->clone(process, cache));
+        if (is_frozen()) {
+            return static_cast<Array*>(clone_frozen(process, cache));
+        }
+
+        // The elements of an array that was already cloned have been
+        // pushed, or are being pushed further up if it contains itself.
+        if (Object* obj = cache.get_clone(this)) {
+            return static_cast<Array*>(obj);
+        }
+
+        Array* clone = clone_impl<Array>(process, cache);
+        for (Value val : _value) {
+            clone->push(val.clone(process, cache));
         }
         return clone;
     }
 
+    const std::vector<Value>& Array::get_values() const {
+        if (is_frozen() && _value.size() < size()) {
+            // Only the cache of wrappers changes, the array's contents
+            // stay the same.
+            Array* self = const_cast<Array*>(this);
+            const std::vector<Frozen::Element>& elements = get_frozen()->get_elements();
+            for (size_t i = _value.size(); i < elements.size(); i++) {
+                Value val = Frozen::thaw(elements[i], get_process());
+                self->write_barrier(val);
+                self->_value.push_back(val);
+            }
+        }
+
+        return _value;
+    }
+
     bool Array::_eq(Array* other) const {
+        const std::vector<Value>& values = get_values();
+        const std::vector<Value>& other_values = other->get_values();
         return objectutils::compare_range(
-            _value.begin(),
-            _value.end(),
-            other->_value.begin(),
+            values.begin(),
+            values.end(),
+            other_values.begin(),
             get_process());
     }
 
-    void Array::reach() {
-        Object::reach();
+    void Array::reach(MarkStack& stack) {
+        Object::reach(stack);
 
-        for (Object* obj : _value) {
-            obj->mark();
+        for (Value val : _value) {
+            val.mark(stack);
         }
     }
 
     ArrayIterator::ArrayIterator(Process* process)
-        : Object(process, ARRAY_ITERATOR_PROTOTYPE),
+        : Object(process, ARRAY_ITERATOR_PROTOTYPE, TYPE),
         _arr(nullptr),
         _i(0) {}
 
     ArrayIterator::ArrayIterator(Process* process, Object* parent)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _arr(nullptr),
         _i(0) {}
 
@@ -286,47 +496,62 @@ namespace emerald {
     }
 
     void ArrayIterator::init(Array* arr) {
+        write_barrier(arr);
         _arr = arr;
     }
 
-    Object* ArrayIterator::cur() const {
-        if (_i >= _arr->_value.size()) {
+    Value ArrayIterator::cur() const {
+        if (_i >= _arr->size()) {
             return _arr->back();
         }
 
-        return _arr->_value[_i];
+        return _arr->at(_i);
     }
 
-    Boolean* ArrayIterator::done() const {
-        return BOOLEAN_IN_CTX(_i == _arr->_value.size(), get_process());
+    bool ArrayIterator::done() const {
+        return _i == _arr->size();
     }
 
-    Object* ArrayIterator::next() {
+    Value ArrayIterator::next() {
         _i++;
         return cur();
     }
 
     ArrayIterator* ArrayIterator::clone(Process* process, CloneCache& cache) {
         ArrayIterator* clone = clone_impl<ArrayIterator>(process, cache);
-        clone->_arr = _arr->clone(process, cache);
+        clone->init(_arr->clone(process, cache));
         clone->_i = _i;
         return clone;
     }
 
-    void ArrayIterator::reach() {
-        Object::reach();
+    std::unique_ptr<Parcel::Native> ArrayIterator::pack(std::vector<Value>& values) const {
+        values.push_back(_arr ? Value(_arr) : Value::null());
+        size_t i = _i;
+        return std::make_unique<Parcel::Native>(
+            [](Process* process, Object* parent) {
+                return process->get_heap().allocate<ArrayIterator>(process, parent);
+            },
+            [i](Object* obj, const std::vector<Value>& values) {
+                ArrayIterator* iter = static_cast<ArrayIterator*>(obj);
+                iter->init(values[0].get_object_as<Array>());
+                iter->_i = i;
+            });
+    }
+
+    void ArrayIterator::reach(MarkStack& stack) {
+        Object::reach(stack);
 
         if (_arr) {
-            _arr->mark();
+            _arr->mark(stack);
         }
     }
 
     Boolean::Boolean(Process* process, bool value)
-        : Object(process, BOOLEAN_PROTOTYPE),
+        : Object(process, BOOLEAN_PROTOTYPE, TYPE),
         _value(value) {}
 
     Boolean::Boolean(Process* process, Object* parent, bool value)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _value(value) {}
 
     bool Boolean::as_bool() const {
@@ -337,32 +562,24 @@ namespace emerald {
         return (_value) ? "True" : "False";
     }
 
-    void Boolean::init(Boolean* val) {
-        _value = val->get_native_value();
+    void Boolean::init(bool val) {
+        _value = val;
     }
 
     bool Boolean::get_native_value() const {
         return _value;
     }
 
-    Boolean* Boolean::eq(Boolean* other) const {
-        return BOOLEAN_IN_CTX(_value == other->_value, get_process());
-    }
-
-    Boolean* Boolean::neq(Boolean* other) const {
-        return BOOLEAN_IN_CTX(_value != other->_value, get_process());
-    }
-
     Boolean* Boolean::clone(Process* process, CloneCache& cache) {
         return clone_impl<Boolean>(process, cache, _value);
     }
 
     Exception::Exception(Process* process, const std::string& message)
-        : Object(process, EXCEPTION_PROTOTYPE),
+        : Object(process, EXCEPTION_PROTOTYPE, TYPE),
         _message(message) {}
 
     Exception::Exception(Process* process, Object* parent, const std::string& message)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _message(message) {}
 
     std::string Exception::as_str() const {
@@ -382,12 +599,12 @@ namespace emerald {
     }
 
     Function::Function(Process* process, std::shared_ptr<const Code> code, Module* globals)
-        : Object(process, OBJECT_PROTOTYPE),
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
         _code(code),
         _globals(globals) {}
 
     Function::Function(Process* process, Object* parent, std::shared_ptr<const Code> code, Module* globals)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _code(code),
         _globals(globals) {}
 
@@ -403,10 +620,10 @@ namespace emerald {
         return _globals;
     }
 
-    void Function::reach() {
-        Object::reach();
+    void Function::reach(MarkStack& stack) {
+        Object::reach(stack);
 
-        _globals->mark();
+        _globals->mark(stack);
     }
 
     Function* Function::clone(Process* process, CloneCache& cache) {
@@ -414,12 +631,12 @@ namespace emerald {
     }
 
     NativeFunction::NativeFunction(Process* process, Callable callable, Module* globals)
-        : Object(process, OBJECT_PROTOTYPE),
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
         _callable(callable),
         _globals(globals) {}
 
     NativeFunction::NativeFunction(Process* process, Object* parent, Callable callable, Module* globals)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _callable(callable),
         _globals(globals) {}
     
@@ -434,16 +651,23 @@ namespace emerald {
         return _globals;
     }
 
-    Object* NativeFunction::invoke(Object* receiver, const std::vector<Object*>& args, Module* globals) {
+    Value NativeFunction::invoke(Value receiver, const std::vector<Value>& args, Module* globals) {
+        Process* process = get_process();
+        NativeStack::ScopedNativeFrame scoped_frame(process->get_native_stack().push_frame(receiver, args, globals));
+        return _callable(process, &scoped_frame.frame());
+    }
+
+    Value NativeFunction::invoke_from_stack(Value receiver, size_t num_args, Module* globals) {
         Process* process = get_process();
-        NativeStack& native_stack = process->get_native_stack();
-        NativeStack::NativeFrame frame = native_stack.push_frame(receiver, args, globals);
-        Object* res = _callable(process, &frame);
-        native_stack.pop_frame();
-        return res;
+        NativeStack::ScopedNativeFrame scoped_frame(process->get_native_stack().push_frame(
+            receiver,
+            process->get_stack().get_values(),
+            num_args,
+            globals));
+        return _callable(process, &scoped_frame.frame());
     }
 
-    Object* NativeFunction::operator()(Object* receiver, const std::vector<Object*>& args, Module* globals) {
+    Value NativeFunction::operator()(Value receiver, const std::vector<Value>& args, Module* globals) {
         return invoke(receiver, args, globals);
     }
 
@@ -456,10 +680,10 @@ namespace emerald {
     }
 
     Null::Null(Process* process)
-        : Object(process, OBJECT_PROTOTYPE) {}
+        : Object(process, OBJECT_PROTOTYPE, TYPE) {}
 
     Null::Null(Process* process, Object* parent)
-        : Object(process, parent) {}
+        : Object(process, parent, TYPE) {}
 
     bool Null::as_bool() const {
         return false;
@@ -474,11 +698,11 @@ namespace emerald {
     }
 
     Number::Number(Process* process, double value)
-        : Object(process, NUMBER_PROTOTYPE),
+        : Object(process, NUMBER_PROTOTYPE, TYPE),
         _value(value) {}
 
     Number::Number(Process* process, Object* parent, double value)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _value(value) {}
 
     bool Number::as_bool() const {
@@ -486,14 +710,11 @@ namespace emerald {
     }
 
     std::string Number::as_str() const {
-        std::string str = fmt::format("{0:f}", _value);
-        str.erase(str.find_last_not_of('0') + 1);
-        str.erase(str.find_last_not_of('.') + 1);
-        return str;
+        return format(_value);
     }
 
-    void Number::init(Number* val) {
-        _value = val->get_native_value();
+    void Number::init(double val) {
+        _value = val;
     }
 
     double Number::get_native_value() const {
@@ -504,114 +725,104 @@ namespace emerald {
         _value = val;
     }
 
-    void Number::increment() {
-        _value++;
-    }
-
-    void Number::decrement() {
-        _value--;
+    std::string Number::format(double val) {
+        std::string str = fmt::format("{0:f}", val);
+        str.erase(str.find_last_not_of('0') + 1);
+        str.erase(str.find_last_not_of('.') + 1);
+        return str;
     }
 
     Number* Number::clone(Process* process, CloneCache& cache) {
         return clone_impl<Number>(process, cache, _value);
     }
 
-    PropertyDescriptor::PropertyDescriptor(Process* process, Object* value)
-        : Object(process, OBJECT_PROTOTYPE),
-        _type(DATA),
-        _value(value) {}
-
     PropertyDescriptor::PropertyDescriptor(Process* process, Object* getter, Object* setter)
-        : Object(process, OBJECT_PROTOTYPE),
-        _type(ACCESSOR),
-        _accessor(Accessor{.getter=getter, .setter=setter}) {}
-
-    PropertyDescriptor::Type PropertyDescriptor::get_type() const {
-        return _type;
-    }
-
-    Object* PropertyDescriptor::get_value() const {
-        if (_type == DATA) {
-            return _value;
-        }
-
-        return nullptr;
-    }
+        : Object(process, OBJECT_PROTOTYPE, TYPE),
+        _getter(getter),
+        _setter(setter) {}
 
-    void PropertyDescriptor::set_value(Object* value) {
-        if (_type == DATA) {
-            _value = value;
-        }
-    }
+    PropertyDescriptor::PropertyDescriptor(Process* process, Object* parent)
+        : Object(process, parent, TYPE),
+        _getter(nullptr),
+        _setter(nullptr) {}
 
     Object* PropertyDescriptor::get_getter() const {
-        if (_type == ACCESSOR) {
-            return _accessor.getter;
-        }
-
-        return nullptr;
+        return _getter;
     }
 
     Object* PropertyDescriptor::get_setter() const {
-        if (_type == ACCESSOR) {
-            return _accessor.setter;
-        }
-
-        return nullptr;
+        return _setter;
     }
 
     PropertyDescriptor* PropertyDescriptor::clone(Process* process, CloneCache& cache) {
         PropertyDescriptor* clone = clone_impl<PropertyDescriptor>(process, cache);
-        if (_type == ACCESSOR) {
-            clone->_accessor.getter = _accessor.getter->clone(process, cache);
-            clone->_accessor.setter = _accessor.setter->clone(process, cache);
-        } else {
-            clone->_value = _value->clone(process, cache);
-        }
+        clone->_getter = _getter ? _getter->clone(process, cache) : nullptr;
+        clone->_setter = _setter ? _setter->clone(process, cache) : nullptr;
+        clone->write_barrier(clone->_getter);
+        clone->write_barrier(clone->_setter);
 
         return clone;
     }
 
-    void PropertyDescriptor::reach() {
-        Object::reach();
+    void PropertyDescriptor::reach(MarkStack& stack) {
+        Object::reach(stack);
 
-        if (_type == ACCESSOR) {
-            _accessor.getter->mark();
-            _accessor.setter->mark();
-        } else {
-            _value->mark();
-        }
+        if (_getter) _getter->mark(stack);
+        if (_setter) _setter->mark(stack);
     }
 
     String::String(Process* process, const std::string& value)
-        : Object(process, STRING_PROTOTYPE),
+        : Object(process, STRING_PROTOTYPE, TYPE),
         _value(value) {}
 
     String::String(Process* process, Object* parent, const std::string& value)
-        : Object(process, parent),
+        : Object(process, parent, TYPE),
         _value(value) {}
 
+    String::String(Process* process, Object* parent, Atom value)
+        : Object(process, parent, TYPE),
+        _value(value.get_str()),
+        _atom(value) {}
+
     bool String::as_bool() const {
-        return _value.size() > 0;
+        return get_native_value().size() > 0;
     }
 
     std::string String::as_str() const {
-        return _value;
+        return get_native_value();
     }
 
     void String::init(String* val) {
+        ensure_mutable();
+
         _value = val->get_native_value();
+        _atom = val->_atom;
     }
 
-    std::string& String::get_native_value() {
-        return _value;
+    void String::append(const std::string& str) {
+        ensure_mutable();
+
+        _atom = Atom();
+        _value.append(str);
     }
 
     const std::string& String::get_native_value() const {
-        return _value;
+        return is_frozen() ? get_frozen()->get_string() : _value;
+    }
+
+    Atom String::get_atom() const {
+        if (!_atom) {
+            _atom = get_native_value();
+        }
+
+        return _atom;
     }
 
     String* String::clone(Process* process, CloneCache& cache) {
+        if (is_frozen()) {
+            return static_cast<String*>(clone_frozen(process, cache));
+        }
+
         return clone_impl<String>(process, cache, _value);
     }
 
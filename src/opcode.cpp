@@ -27,6 +27,10 @@ namespace emerald {
         return _arg_counts[op];
     }
 
+    bool OpCode::is_register_op(Value op) {
+        return op >= mov && op <= rbit_shr;
+    }
+
 #define X(name, arg_count) #name,
     const std::string OpCode::_strings[] = { _OPCODES };
 #undef X
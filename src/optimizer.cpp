@@ -0,0 +1,505 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "emerald/optimizer.h"
+
+namespace emerald {
+
+    void Optimizer::optimize(Code& code) {
+        Optimizer(code).run();
+        for (const std::shared_ptr<Code>& func : code._functions) {
+            optimize(*func);
+        }
+    }
+
+    Optimizer::Optimizer(Code& code)
+        : _code(code),
+        _instructions(code._instructions),
+        _has_ldlocs(false) {}
+
+    void Optimizer::run() {
+        // Removed instructions are replaced with nops until the end of each
+        // round, so jump targets stay valid while the passes run.
+        bool changed;
+        do {
+            analyze();
+            changed = remove_unreachable();
+            changed |= thread_jumps();
+            changed |= remove_dead_stores();
+            changed |= remove_dead_pushes();
+            compact();
+        } while (changed);
+
+        analyze();
+        if (fuse_prop_keys()) {
+            compact();
+        }
+
+        analyze();
+        if (fuse_superinstructions()) {
+            compact();
+        }
+    }
+
+    bool Optimizer::remove_unreachable() {
+        bool changed = false;
+        bool reachable = true;
+        for (size_t i = 0; i < _instructions.size(); i++) {
+            if (_jump_targets[i]) {
+                reachable = true;
+            }
+
+            OpCode::Value op = _instructions[i].get_op();
+            if (!reachable) {
+                if (op != OpCode::nop) {
+                    remove(i);
+                    changed = true;
+                }
+                continue;
+            }
+
+            switch (op) {
+            case OpCode::jmp:
+            case OpCode::exit_try:
+            case OpCode::ret:
+            case OpCode::throw_exc:
+                reachable = false;
+                break;
+            default:
+                break;
+            }
+        }
+
+        return changed;
+    }
+
+    bool Optimizer::thread_jumps() {
+        bool changed = false;
+        size_t size = _instructions.size();
+        for (size_t i = 0; i < size; i++) {
+            const Code::Instruction& instr = _instructions[i];
+            OpCode::Value op = instr.get_op();
+            if (!is_jump(op)) {
+                continue;
+            }
+
+            size_t target = instr.get_arg(0);
+            for (size_t hops = 0; target < size && hops < size; hops++) {
+                const Code::Instruction& next = _instructions[target];
+                OpCode::Value next_op = next.get_op();
+                if (next_op == OpCode::jmp) {
+                    target = next.get_arg(0);
+                } else if ((op == OpCode::jmp_true_or_pop || op == OpCode::jmp_false_or_pop) && next_op == op) {
+                    // The value is tested again with the same outcome.
+                    target = next.get_arg(0);
+                } else if ((op == OpCode::jmp_true_or_pop && next_op == OpCode::jmp_true)
+                        || (op == OpCode::jmp_false_or_pop && next_op == OpCode::jmp_false)) {
+                    // The value is popped on both paths.
+                    op = next_op;
+                    target = next.get_arg(0);
+                } else {
+                    break;
+                }
+            }
+
+            if (op == OpCode::jmp && target == i + 1) {
+                remove(i);
+                changed = true;
+            } else if (op != instr.get_op() || target != instr.get_arg(0)) {
+                _instructions[i] = Code::Instruction(op, { target });
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    bool Optimizer::remove_dead_stores() {
+        // ldlocs exposes every local by name, so nothing can be proven dead.
+        if (_has_ldlocs) {
+            return false;
+        }
+
+        bool changed = false;
+        for (size_t i = 0; i < _instructions.size(); i++) {
+            const Code::Instruction& instr = _instructions[i];
+            if (instr.get_op() == OpCode::stloc && !_read_locals[instr.get_arg(0)]) {
+                _instructions[i] = Code::Instruction(OpCode::pop, { 1 });
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    bool Optimizer::remove_dead_pushes() {
+        bool changed = false;
+        for (size_t i = 0; i + 1 < _instructions.size(); i++) {
+            const Code::Instruction& next = _instructions[i + 1];
+            if (!is_pure_push(_instructions[i].get_op())
+                    || next.get_op() != OpCode::pop
+                    || _jump_targets[i + 1]) {
+                continue;
+            }
+
+            size_t n = next.get_arg(0);
+            if (n == 1) {
+                remove(i + 1);
+            } else {
+                _instructions[i + 1] = Code::Instruction(OpCode::pop, { n - 1 });
+            }
+            remove(i);
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    bool Optimizer::fuse_prop_keys() {
+        bool changed = false;
+        for (size_t i = 0; i < _instructions.size(); i++) {
+            OpCode::Value op = _instructions[i].get_op();
+            if (op != OpCode::get_prop && op != OpCode::set_prop) {
+                continue;
+            }
+
+            // The key sits below the object being accessed.
+            size_t producer;
+            if (!find_producer(i, 1, producer) || _instructions[producer].get_op() != OpCode::new_str) {
+                continue;
+            }
+
+            uint64_t str_id = _instructions[producer].get_arg(0);
+            uint64_t push_self_back = _instructions[i].get_arg(0);
+            _instructions[i] = Code::Instruction(
+                op == OpCode::get_prop ? OpCode::get_prop_str : OpCode::set_prop_str,
+                { str_id, push_self_back });
+            remove(producer);
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    bool Optimizer::fuse_superinstructions() {
+        bool changed = false;
+        size_t size = _instructions.size();
+        for (size_t i = 0; i + 1 < size; i++) {
+            if (_jump_targets[i + 1]) {
+                continue;
+            }
+
+            const Code::Instruction& instr = _instructions[i];
+            const Code::Instruction& next = _instructions[i + 1];
+            uint64_t arg = instr.get_arg_count() ? instr.get_arg(0) : 0;
+            switch (instr.get_op()) {
+            case OpCode::get_prop_str:
+                if (instr.get_arg(1) && next.get_op() == OpCode::call && next.get_arg(0)) {
+                    _instructions[i + 1] = Code::Instruction(OpCode::call_method, { arg, next.get_arg(1) });
+                    remove(i);
+                    changed = true;
+                }
+                break;
+            case OpCode::ldloc:
+                if (next.get_op() == OpCode::get_prop_str && !next.get_arg(1)) {
+                    _instructions[i + 1] = Code::Instruction(OpCode::ldloc_get_prop, { arg, next.get_arg(0) });
+                    remove(i);
+                    changed = true;
+                }
+                break;
+            case OpCode::new_num:
+                // x += c
+                if (i + 3 < size
+                        && !_jump_targets[i + 2]
+                        && !_jump_targets[i + 3]
+                        && next.get_op() == OpCode::ldloc
+                        && _instructions[i + 2].get_op() == OpCode::iadd
+                        && _instructions[i + 3].get_op() == OpCode::stloc
+                        && _instructions[i + 3].get_arg(0) == next.get_arg(0)) {
+                    _instructions[i + 3] = Code::Instruction(OpCode::inc_local, { next.get_arg(0), arg });
+                    remove(i);
+                    remove(i + 1);
+                    remove(i + 2);
+                    changed = true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        return changed;
+    }
+
+    void Optimizer::analyze() {
+        size_t size = _instructions.size();
+        _jump_targets.assign(size + 1, false);
+        _read_locals.assign(_code._locals.size(), false);
+        _has_ldlocs = false;
+        for (const Code::Instruction& instr : _instructions) {
+            OpCode::Value op = instr.get_op();
+            if (is_jump(op)) {
+                _jump_targets[std::min<size_t>(instr.get_arg(0), size)] = true;
+            }
+
+            switch (op) {
+            case OpCode::ldloc:
+            case OpCode::ldloc_get_prop:
+            case OpCode::inc_local:
+                _read_locals[instr.get_arg(0)] = true;
+                break;
+            case OpCode::ldlocs:
+                _has_ldlocs = true;
+                break;
+            default:
+                if (OpCode::is_register_op(op)) {
+                    for (size_t i = 1; i < instr.get_arg_count(); i++) {
+                        uint32_t operand = instr.get_arg(i);
+                        if (!Code::Operand::is_constant(operand) && !Code::Operand::is_data_stack(operand)) {
+                            _read_locals[Code::Operand::get_id(operand)] = true;
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    void Optimizer::compact() {
+        size_t size = _instructions.size();
+        std::vector<size_t> new_index(size + 1);
+        size_t n = 0;
+        for (size_t i = 0; i < size; i++) {
+            new_index[i] = n;
+            if (_instructions[i].get_op() != OpCode::nop) {
+                n++;
+            }
+        }
+        new_index[size] = n;
+
+        // A jump to a removed instruction lands on the next one kept.
+        std::vector<Code::Instruction> instructions;
+        instructions.reserve(n);
+        for (Code::Instruction& instr : _instructions) {
+            if (instr.get_op() == OpCode::nop) {
+                continue;
+            }
+
+            if (is_jump(instr.get_op())) {
+                instr.set_arg(0, new_index[std::min<size_t>(instr.get_arg(0), size)]);
+            }
+            instructions.push_back(instr);
+        }
+        _instructions.swap(instructions);
+
+        for (Code::LabelEntry& entry : _code._labels) {
+            entry.pos = new_index[std::min(entry.pos, size)];
+            for (size_t& rewrite : entry.unbound_rewrites) {
+                rewrite = new_index[std::min(rewrite, size)];
+            }
+        }
+    }
+
+    void Optimizer::remove(size_t i) {
+        _instructions[i] = Code::Instruction(OpCode::nop);
+    }
+
+    // Walks back from instruction i to the one that pushed the value at
+    // the given depth of the stack i starts with. Fails if control can
+    // enter in between or an instruction's effect on the stack is unknown.
+    bool Optimizer::find_producer(size_t i, size_t depth, size_t& producer) const {
+        for (size_t j = i; j-- > 0;) {
+            if (_jump_targets[j + 1]) {
+                return false;
+            }
+
+            size_t pops, pushes;
+            if (!get_stack_effect(_instructions[j], pops, pushes)) {
+                return false;
+            }
+
+            if (depth < pushes) {
+                producer = j;
+                return pushes == 1;
+            }
+            depth = depth - pushes + pops;
+        }
+
+        return false;
+    }
+
+    bool Optimizer::is_jump(OpCode::Value op) {
+        switch (op) {
+        case OpCode::jmp:
+        case OpCode::jmp_true:
+        case OpCode::jmp_true_or_pop:
+        case OpCode::jmp_false:
+        case OpCode::jmp_false_or_pop:
+        case OpCode::jmp_data:
+        case OpCode::enter_try:
+        case OpCode::exit_try:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Optimizer::is_pure_push(OpCode::Value op) {
+        switch (op) {
+        case OpCode::new_func:
+        case OpCode::new_num:
+        case OpCode::new_str:
+        case OpCode::new_boolean:
+        case OpCode::null:
+        case OpCode::self:
+        case OpCode::ldloc:
+        case OpCode::ldgbls:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Optimizer::get_stack_effect(const Code::Instruction& instr, size_t& pops, size_t& pushes) {
+        switch (instr.get_op()) {
+        case OpCode::nop:
+            pops = 0;
+            pushes = 0;
+            return true;
+        case OpCode::pop:
+            pops = instr.get_arg(0);
+            pushes = 0;
+            return true;
+        case OpCode::neg:
+        case OpCode::log_neg:
+        case OpCode::bit_not:
+        case OpCode::str:
+        case OpCode::boolean:
+        case OpCode::get_iter:
+            pops = 1;
+            pushes = 1;
+            return true;
+        case OpCode::add:
+        case OpCode::sub:
+        case OpCode::mul:
+        case OpCode::div:
+        case OpCode::mod:
+        case OpCode::iadd:
+        case OpCode::isub:
+        case OpCode::imul:
+        case OpCode::idiv:
+        case OpCode::imod:
+        case OpCode::eq:
+        case OpCode::neq:
+        case OpCode::lt:
+        case OpCode::gt:
+        case OpCode::lte:
+        case OpCode::gte:
+        case OpCode::bit_or:
+        case OpCode::bit_xor:
+        case OpCode::bit_and:
+        case OpCode::bit_shl:
+        case OpCode::bit_shr:
+            pops = 2;
+            pushes = 1;
+            return true;
+        case OpCode::call:
+            pops = 1 + instr.get_arg(0) + instr.get_arg(1);
+            pushes = 1;
+            return true;
+        case OpCode::new_obj:
+            pops = instr.get_arg(0) + 2 * instr.get_arg(1);
+            pushes = 1;
+            return true;
+        case OpCode::init:
+            pops = instr.get_arg(0) + 1;
+            pushes = 1;
+            return true;
+        case OpCode::new_func:
+        case OpCode::new_num:
+        case OpCode::new_str:
+        case OpCode::new_boolean:
+        case OpCode::null:
+        case OpCode::self:
+        case OpCode::ldgbl:
+        case OpCode::ldloc:
+        case OpCode::ldlocs:
+        case OpCode::ldgbls:
+        case OpCode::import:
+        case OpCode::ldloc_get_prop:
+            pops = 0;
+            pushes = 1;
+            return true;
+        case OpCode::new_arr:
+            pops = instr.get_arg(0);
+            pushes = 1;
+            return true;
+        case OpCode::def_accessor_prop:
+            pops = instr.get_arg(0) ? 4 : 3;
+            pushes = instr.get_arg(1) ? 1 : 0;
+            return true;
+        case OpCode::def_data_prop:
+        case OpCode::set_prop:
+            pops = 3;
+            pushes = instr.get_arg(0) ? 1 : 0;
+            return true;
+        case OpCode::get_prop:
+            pops = 2;
+            pushes = instr.get_arg(0) ? 2 : 1;
+            return true;
+        case OpCode::iter_cur:
+        case OpCode::iter_next:
+            pops = 1;
+            pushes = 2;
+            return true;
+        case OpCode::stgbl:
+        case OpCode::stloc:
+            pops = 1;
+            pushes = 0;
+            return true;
+        case OpCode::get_prop_str:
+            pops = 1;
+            pushes = instr.get_arg(1) ? 2 : 1;
+            return true;
+        case OpCode::set_prop_str:
+            pops = 2;
+            pushes = instr.get_arg(1) ? 1 : 0;
+            return true;
+        case OpCode::call_method:
+            pops = 1 + instr.get_arg(1);
+            pushes = 1;
+            return true;
+        case OpCode::inc_local:
+            pops = 0;
+            pushes = 0;
+            return true;
+        default:
+            if (OpCode::is_register_op(instr.get_op())) {
+                pops = 0;
+                for (size_t i = 1; i < instr.get_arg_count(); i++) {
+                    pops += Code::Operand::is_data_stack(instr.get_arg(i));
+                }
+                pushes = Code::Operand::is_data_stack(instr.get_arg(0));
+                return true;
+            }
+            return false;
+        }
+    }
+
+} // namespace emerald
@@ -0,0 +1,424 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <unordered_map>
+
+#include "emerald/heap_root_source.h"
+#include "emerald/module.h"
+#include "emerald/object.h"
+#include "emerald/objectutils.h"
+#include "emerald/parcel.h"
+#include "emerald/process.h"
+
+namespace emerald {
+
+    struct Parcel::Node {
+        enum class Kind {
+            BUILTIN_PROTOTYPE,
+            FROZEN,
+            OBJECT,
+            ARRAY,
+            STRING,
+            EXCEPTION,
+            FUNCTION,
+            NATIVE_FUNCTION,
+            MODULE,
+            NATIVE
+        };
+
+        struct Property {
+            Atom key;
+            Ref value;
+            // Accessor properties keep their getter in value.
+            Ref setter;
+            bool accessor;
+        };
+
+        Kind kind;
+        Object::Type type;
+        size_t parent = NO_NODE;
+        std::vector<Property> properties;
+        std::vector<Ref> elements;
+
+        // The value of a string, message of an exception or name of a
+        // module.
+        std::string str;
+        std::shared_ptr<const Code> code;
+        std::shared_ptr<Code> module_code;
+        NativeFunction::Callable callable = nullptr;
+        size_t globals = NO_NODE;
+        FrozenRef frozen;
+
+        // Packed by the object itself, its values kept in elements.
+        std::unique_ptr<const Native> native;
+    };
+
+    // Each builtin prototype is the only object of its type that isn't
+    // made from it, so the type is enough to find the receiver's.
+    static Object* get_builtin_prototype(Object::Type type, Process* process) {
+        NativeObjects& native_objects = process->get_native_objects();
+        switch (type) {
+        case Object::oObject:
+            return native_objects.get_object_prototype();
+        case Object::oArray:
+            return native_objects.get_array_prototype();
+        case Object::oArrayIterator:
+            return native_objects.get_array_iterator_prototype();
+        case Object::oBoolean:
+            return native_objects.get_boolean_prototype();
+        case Object::oException:
+            return native_objects.get_exception_prototype();
+        case Object::oNumber:
+            return native_objects.get_number_prototype();
+        case Object::oString:
+            return native_objects.get_string_prototype();
+        default:
+            return nullptr;
+        }
+    }
+
+    // Reads the values out of the sender's heap. An object reached more
+    // than once, including through a cycle, is packed once.
+    class Parcel::Packer {
+    public:
+        Packer(Parcel& parcel, Process* process)
+            : _parcel(parcel),
+            _process(process) {}
+
+        Ref pack(Value value) {
+            Object* obj = value.get_object();
+            if (!obj) {
+                return { value, NO_NODE };
+            }
+
+            if (obj != get_builtin_prototype(obj->get_type(), _process)) {
+                if (Number* num = object_cast<Number>(obj)) {
+                    return { Value::number(num->get_native_value()), NO_NODE };
+                } else if (Boolean* boolean = object_cast<Boolean>(obj)) {
+                    return { Value::boolean(boolean->get_native_value()), NO_NODE };
+                } else if (object_cast<Null>(obj)) {
+                    return { Value::null(), NO_NODE };
+                }
+            }
+
+            return { Value(), pack_object(obj) };
+        }
+
+    private:
+        Parcel& _parcel;
+        Process* _process;
+        std::unordered_map<Object*, size_t> _nodes;
+
+        size_t pack_object(Object* obj) {
+            auto it = _nodes.find(obj);
+            if (it != _nodes.end()) {
+                return it->second;
+            }
+
+            // Added before anything it refers to is packed, which may add
+            // nodes of its own, so the node is filled in at the end.
+            size_t i = _parcel._nodes.size();
+            _parcel._nodes.emplace_back();
+            _nodes.emplace(obj, i);
+
+            Node node;
+            node.type = obj->get_type();
+            if (obj->is_frozen()) {
+                node.kind = Node::Kind::FROZEN;
+                node.frozen = obj->get_frozen();
+            } else if (obj == get_builtin_prototype(obj->get_type(), _process)) {
+                node.kind = Node::Kind::BUILTIN_PROTOTYPE;
+            } else {
+                pack_contents(obj, node);
+            }
+
+            _parcel._nodes[i] = std::move(node);
+            return i;
+        }
+
+        void pack_contents(Object* obj, Node& node) {
+            if (obj->get_type() == Object::oObject) {
+                node.kind = Node::Kind::OBJECT;
+            } else if (Array* arr = object_cast<Array>(obj)) {
+                node.kind = Node::Kind::ARRAY;
+                node.elements.reserve(arr->size());
+                for (size_t i = 0; i < arr->size(); i++) {
+                    node.elements.push_back(pack(arr->at(i)));
+                }
+            } else if (String* str = object_cast<String>(obj)) {
+                node.kind = Node::Kind::STRING;
+                node.str = str->get_native_value();
+            } else if (Exception* exc = object_cast<Exception>(obj)) {
+                node.kind = Node::Kind::EXCEPTION;
+                node.str = exc->get_message();
+            } else if (Function* func = object_cast<Function>(obj)) {
+                node.kind = Node::Kind::FUNCTION;
+                node.code = func->get_code();
+                if (Module* globals = func->get_globals()) {
+                    node.globals = pack_object(globals);
+                }
+            } else if (NativeFunction* func = object_cast<NativeFunction>(obj)) {
+                node.kind = Node::Kind::NATIVE_FUNCTION;
+                node.callable = func->get_callable();
+                if (Module* globals = func->get_globals()) {
+                    node.globals = pack_object(globals);
+                }
+            } else if (Module* module = object_cast<Module>(obj)) {
+                node.kind = Node::Kind::MODULE;
+                node.str = module->get_name();
+                node.module_code = module->get_code();
+            } else {
+                std::vector<Value> values;
+                node.native = obj->pack(values);
+                if (!node.native) {
+                    throw ALLOC_EXCEPTION_IN_CTX(
+                        "objects of this type can't be sent to another process",
+                        _process);
+                }
+
+                node.kind = Node::Kind::NATIVE;
+                node.elements.reserve(values.size());
+                for (Value val : values) {
+                    node.elements.push_back(pack(val));
+                }
+            }
+
+            if (Object* parent = obj->get_parent()) {
+                node.parent = pack_object(parent);
+            }
+
+            for (Atom key : obj->get_property_keys()) {
+                Shape::Property property;
+                obj->get_shape()->lookup(key, property);
+                Value val = obj->get_slot(property.slot);
+                if (property.accessor) {
+                    PropertyDescriptor* descriptor = static_cast<PropertyDescriptor*>(val.get_object());
+                    Ref getter = pack(descriptor->get_getter());
+                    Ref setter = pack(descriptor->get_setter());
+                    node.properties.push_back({ key, getter, setter, true });
+                } else {
+                    node.properties.push_back({ key, pack(val), { Value(), NO_NODE }, false });
+                }
+            }
+        }
+    };
+
+    // Makes the objects in the receiver's heap, keeping them alive until
+    // they're returned.
+    class Parcel::Unpacker final : public HeapRootSource {
+    public:
+        Unpacker(const Parcel& parcel, Process* process)
+            : _parcel(parcel),
+            _process(process),
+            _objects(parcel._nodes.size(), nullptr) {
+            _process->get_heap().add_root_source(this);
+        }
+
+        ~Unpacker() {
+            _process->get_heap().remove_root_source(this);
+        }
+
+        NO_COPY(Unpacker);
+
+        // Every object is made before any is filled in, so that references
+        // between them, cycles included, are to objects that exist. Native
+        // objects get their values last, as a set may hash what it holds,
+        // and in reverse so that those packed inside others come first.
+        void run() {
+            for (size_t i = 0; i < _objects.size(); i++) {
+                make(i);
+            }
+
+            for (size_t i = 0; i < _objects.size(); i++) {
+                fill(i);
+            }
+
+            for (size_t i = _objects.size(); i-- > 0;) {
+                fill_native(i);
+            }
+        }
+
+        Value unpack(const Ref& ref) const {
+            if (ref.node == NO_NODE) {
+                return ref.immediate;
+            }
+
+            return _objects[ref.node];
+        }
+
+        std::vector<HeapManaged*> get_roots() override {
+            std::vector<HeapManaged*> roots;
+            for (Object* obj : _objects) {
+                if (obj) roots.push_back(obj);
+            }
+
+            return roots;
+        }
+
+    private:
+        const Parcel& _parcel;
+        Process* _process;
+        std::vector<Object*> _objects;
+
+        // An object's parent, and a function's globals, are made first as
+        // they're given to its constructor.
+        Object* make(size_t i) {
+            if (_objects[i]) {
+                return _objects[i];
+            }
+
+            const Node& node = _parcel._nodes[i];
+            Process* process = _process;
+            Heap& heap = process->get_heap();
+            Object* parent = node.parent == NO_NODE ? nullptr : make(node.parent);
+            Module* globals = node.globals == NO_NODE ? nullptr : static_cast<Module*>(make(node.globals));
+
+            Object* obj = nullptr;
+            switch (node.kind) {
+            case Node::Kind::BUILTIN_PROTOTYPE:
+                obj = get_builtin_prototype(node.type, process);
+                break;
+            case Node::Kind::FROZEN:
+                obj = Frozen::thaw(node.frozen, process);
+                break;
+            case Node::Kind::OBJECT:
+                obj = heap.allocate<Object>(process, parent);
+                break;
+            case Node::Kind::ARRAY:
+                obj = heap.allocate<Array>(process, parent);
+                break;
+            case Node::Kind::STRING:
+                obj = heap.allocate<String>(process, parent, node.str);
+                break;
+            case Node::Kind::EXCEPTION:
+                obj = heap.allocate<Exception>(process, parent, node.str);
+                break;
+            case Node::Kind::FUNCTION:
+                obj = heap.allocate<Function>(process, parent, node.code, globals);
+                break;
+            case Node::Kind::NATIVE_FUNCTION:
+                obj = heap.allocate<NativeFunction>(process, parent, node.callable, globals);
+                break;
+            case Node::Kind::MODULE:
+                obj = heap.allocate<Module>(process, parent, node.str, node.module_code);
+                break;
+            case Node::Kind::NATIVE:
+                obj = node.native->make(process, parent);
+                break;
+            }
+
+            _objects[i] = obj;
+            return obj;
+        }
+
+        void fill(size_t i) {
+            const Node& node = _parcel._nodes[i];
+            if (node.kind == Node::Kind::BUILTIN_PROTOTYPE || node.kind == Node::Kind::FROZEN) {
+                return;
+            }
+
+            Process* process = _process;
+            Object* obj = _objects[i];
+            for (const Node::Property& property : node.properties) {
+                if (property.accessor) {
+                    obj->define_property(property.key, process->get_heap().allocate<PropertyDescriptor>(
+                        process,
+                        unpack(property.value).get_object(),
+                        unpack(property.setter).get_object()));
+                } else {
+                    obj->define_property(property.key, unpack(property.value));
+                }
+            }
+
+            if (node.kind == Node::Kind::ARRAY) {
+                Array* arr = static_cast<Array*>(obj);
+                for (const Ref& element : node.elements) {
+                    arr->push(unpack(element));
+                }
+            }
+        }
+
+        void fill_native(size_t i) {
+            const Node& node = _parcel._nodes[i];
+            if (node.kind != Node::Kind::NATIVE) {
+                return;
+            }
+
+            std::vector<Value> values;
+            values.reserve(node.elements.size());
+            for (const Ref& element : node.elements) {
+                values.push_back(unpack(element));
+            }
+
+            node.native->fill(_objects[i], values);
+        }
+    };
+
+    Parcel::Native::Native(Make make, Fill fill)
+        : _make(make),
+        _fill(fill) {}
+
+    Object* Parcel::Native::make(Process* process, Object* parent) const {
+        return _make(process, parent);
+    }
+
+    void Parcel::Native::fill(Object* obj, const std::vector<Value>& values) const {
+        if (_fill) {
+            _fill(obj, values);
+        }
+    }
+
+    Parcel::Parcel() {}
+
+    Parcel::~Parcel() {}
+
+    ParcelRef Parcel::pack(Value value, Process* process) {
+        return pack(std::vector<Value>{ value }, process);
+    }
+
+    ParcelRef Parcel::pack(const std::vector<Value>& values, Process* process) {
+        std::shared_ptr<Parcel> parcel(new Parcel());
+        Packer packer(*parcel, process);
+        parcel->_values.reserve(values.size());
+        for (Value value : values) {
+            parcel->_values.push_back(packer.pack(value));
+        }
+
+        return parcel;
+    }
+
+    Value Parcel::unpack(Process* process) const {
+        Unpacker unpacker(*this, process);
+        unpacker.run();
+        return unpacker.unpack(_values.front());
+    }
+
+    std::vector<Value> Parcel::unpack_all(Process* process) const {
+        Unpacker unpacker(*this, process);
+        unpacker.run();
+
+        std::vector<Value> values;
+        values.reserve(_values.size());
+        for (const Ref& ref : _values) {
+            values.push_back(unpacker.unpack(ref));
+        }
+
+        return values;
+    }
+
+} // namespace emerald
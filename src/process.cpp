@@ -23,18 +23,31 @@ namespace emerald {
     Process::Process(PID id)
         : _id(id),
         _state(State::PENDING),
+        _mailbox(this),
         _native_objects(this) {
-        _heap.add_root_source(&_mailbox);
         _heap.add_root_source(&_module_registry);
         _heap.add_root_source(&_native_objects);
         _heap.add_root_source(&_native_stack);
         _heap.add_root_source(&_stack);
     }
 
+    Process* Process::get_peer(PID id) {
+        auto it = _peers.find(id);
+        if (it != _peers.end()) {
+            return it->second;
+        }
+
+        Process* peer = ProcessManager::get(id);
+        if (peer) {
+            _peers.emplace(id, peer);
+        }
+
+        return peer;
+    }
+
     Process::PID ProcessManager::_curr_id = 0;
 
     std::unordered_map<Process::PID, Process> ProcessManager::_map;
-    std::unordered_map<Process::PID, std::thread> ProcessManager::_threads;
     std::mutex ProcessManager::_mutex;
 
     Process* ProcessManager::create() {
@@ -44,18 +57,23 @@ namespace emerald {
         return &_map.at(pid);
     }
 
-    void ProcessManager::execute(Process::PID id, std::function<void(Process*)> f) {
+    std::vector<Process*> ProcessManager::create(size_t count) {
         std::lock_guard<std::mutex> lock(_mutex);
-        if (_threads.find(id) != _threads.end()) {
-            return;
+        std::vector<Process*> processes;
+        processes.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            Process::PID pid = _curr_id++;
+            _map.emplace(pid, pid);
+            processes.push_back(&_map.at(pid));
         }
 
-        Process* process = &_map.at(id);
-        _threads.emplace(id, [=]() {
-            process->_state.store(Process::State::RUNNING);
-            f(process);
-            process->_state.store(Process::State::COMPLETED);
-        });
+        return processes;
+    }
+
+    void ProcessManager::execute(Process::PID id, std::function<void(Process*)> f) {
+        if (Process* process = get(id)) {
+            Scheduler::spawn(process, std::move(f));
+        }
     }
 
     Process* ProcessManager::get(Process::PID id) {
@@ -67,13 +85,8 @@ namespace emerald {
     }
 
     void ProcessManager::join(Process::PID id) {
-        _mutex.lock();
-        if (_threads.find(id) == _threads.end()) return;
-        std::thread& t = _threads.at(id);
-        _mutex.unlock();
-        // join after unlock to prevent deadlock
-        if (t.joinable()) {
-            t.join();
+        if (Process* process = get(id)) {
+            Scheduler::join(process);
         }
     }
 
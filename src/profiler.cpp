@@ -0,0 +1,116 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "emerald/profiler.h"
+#include "emerald/stack.h"
+
+namespace emerald {
+
+    Profiler::Profiler()
+        : _sample_requested(false),
+        _running(false),
+        _num_samples(0) {}
+
+    Profiler::~Profiler() {
+        stop();
+    }
+
+    void Profiler::start(std::chrono::microseconds interval) {
+        stop();
+
+        {
+            std::lock_guard<std::mutex> lock(_samples_mutex);
+            _num_samples = 0;
+            _samples.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        _running = true;
+        _timer = std::thread(
+            &Profiler::run_timer,
+            this,
+            std::max(interval, std::chrono::microseconds(1)));
+    }
+
+    void Profiler::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_timer_mutex);
+            if (!_running) return;
+            _running = false;
+        }
+
+        _timer_cv.notify_one();
+        _timer.join();
+        _sample_requested.store(false, std::memory_order_relaxed);
+    }
+
+    bool Profiler::is_running() const {
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        return _running;
+    }
+
+    void Profiler::take_sample(const Stack& stack) {
+        _sample_requested.store(false, std::memory_order_relaxed);
+
+        std::string folded;
+        for (const Stack::Frame& frame : stack.get_frames()) {
+            if (!folded.empty()) folded += ';';
+            folded += frame.get_label();
+            folded += ':';
+            folded += std::to_string(frame.get_current_instruction());
+        }
+
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        _num_samples++;
+        _samples[folded]++;
+    }
+
+    size_t Profiler::num_samples() const {
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        return _num_samples;
+    }
+
+    std::string Profiler::get_folded_stacks() const {
+        std::ostringstream oss;
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        for (const auto& [folded, count] : _samples) {
+            oss << folded << " " << count << std::endl;
+        }
+
+        return oss.str();
+    }
+
+    bool Profiler::write_folded_stacks(const std::filesystem::path& path) const {
+        std::ofstream ofs(path);
+        if (!ofs) return false;
+
+        ofs << get_folded_stacks();
+        return bool(ofs);
+    }
+
+    void Profiler::run_timer(std::chrono::microseconds interval) {
+        std::unique_lock<std::mutex> lock(_timer_mutex);
+        while (!_timer_cv.wait_for(lock, interval, [this]() { return !_running; })) {
+            _sample_requested.store(true, std::memory_order_relaxed);
+        }
+    }
+
+} // namespace emerald
@@ -0,0 +1,87 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "emerald/run_queue.h"
+
+namespace emerald {
+
+    RunQueue::Buffer::Buffer(size_t capacity)
+        : capacity(capacity),
+        slots(new std::atomic<Process*>[capacity]) {}
+
+    Process* RunQueue::Buffer::get(int64_t i) const {
+        return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void RunQueue::Buffer::put(int64_t i, Process* process) {
+        slots[i & (capacity - 1)].store(process, std::memory_order_relaxed);
+    }
+
+    RunQueue::RunQueue()
+        : _top(0),
+        _bottom(0) {
+        _buffers.push_back(std::make_unique<Buffer>(INITIAL_CAPACITY));
+        _buffer.store(_buffers.back().get());
+    }
+
+    void RunQueue::push(Process* process) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+        if (bottom - top >= static_cast<int64_t>(buffer->capacity)) {
+            buffer = grow(buffer, top, bottom);
+        }
+
+        buffer->put(bottom, process);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    Process* RunQueue::take() {
+        while (true) {
+            int64_t top = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = _bottom.load(std::memory_order_acquire);
+            if (top >= bottom) return nullptr;
+
+            Process* process = _buffer.load(std::memory_order_acquire)->get(top);
+            if (_top.compare_exchange_strong(top, top + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return process;
+            }
+        }
+    }
+
+    size_t RunQueue::size() const {
+        int64_t top = _top.load(std::memory_order_relaxed);
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        return bottom > top ? bottom - top : 0;
+    }
+
+    RunQueue::Buffer* RunQueue::grow(Buffer* buffer, int64_t top, int64_t bottom) {
+        _buffers.push_back(std::make_unique<Buffer>(buffer->capacity * 2));
+        Buffer* grown = _buffers.back().get();
+        for (int64_t i = top; i < bottom; i++) {
+            grown->put(i, buffer->get(i));
+        }
+
+        _buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+} // namespace emerald
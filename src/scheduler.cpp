@@ -0,0 +1,399 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+
+#include "emerald/process.h"
+#include "emerald/scheduler.h"
+
+namespace emerald {
+
+    namespace {
+
+        thread_local Process* current = nullptr;
+
+    } // namespace
+
+    std::atomic<size_t> Scheduler::_num_workers(0);
+
+    thread_local Scheduler::Worker* Scheduler::_current_worker = nullptr;
+
+    void Scheduler::set_num_workers(size_t num_workers) {
+        _num_workers.store(num_workers);
+    }
+
+    size_t Scheduler::get_num_workers() {
+        if (size_t num_workers = _num_workers.load()) {
+            return num_workers;
+        }
+
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    void Scheduler::spawn(Process* process, std::function<void(Process*)> entry) {
+        Task& task = process->get_task();
+        {
+            std::lock_guard<std::mutex> lock(task.mutex);
+            if (task.spawned) return;
+            task.spawned = true;
+            task.entry = std::move(entry);
+        }
+
+        get().push_runnable(process);
+    }
+
+    Process* Scheduler::get_current() {
+        return current;
+    }
+
+    void Scheduler::preempt(Process* process) {
+        Task& task = process->get_task();
+        task.reductions = REDUCTIONS;
+        if (!task.fiber || Fiber::get_current() != task.fiber.get()) return;
+
+        Scheduler& scheduler = get();
+        if (scheduler._num_runnable.load() > 0 || scheduler._stopping.load()) {
+            task.yield = Task::Yield::PREEMPTED;
+            task.fiber->yield();
+        }
+    }
+
+    void Scheduler::park(Process* process) {
+        Task& task = process->get_task();
+        if (task.fiber && Fiber::get_current() == task.fiber.get()) {
+            process->set_state(Process::State::WAITING);
+            task.yield = Task::Yield::PARKED;
+            task.fiber->yield();
+            process->set_state(Process::State::RUNNING);
+        } else {
+            std::unique_lock<std::mutex> lock(task.mutex);
+            while (!task.woken) task.cv.wait(lock);
+            task.woken = false;
+        }
+    }
+
+    void Scheduler::wake(Process* process) {
+        Task& task = process->get_task();
+        bool runnable = false;
+        {
+            std::lock_guard<std::mutex> lock(task.mutex);
+            if (task.parked) {
+                task.parked = false;
+                runnable = true;
+            } else {
+                task.woken = true;
+            }
+        }
+
+        task.cv.notify_all();
+        if (runnable) {
+            get().push_runnable(process);
+        }
+    }
+
+    void Scheduler::park_until(Process* process, Clock::time_point deadline) {
+        Scheduler& scheduler = get();
+        scheduler.add_timer(process, deadline);
+        park(process);
+
+        // Woken before the deadline, so the timer would only cause a
+        // spurious wakeup later on.
+        scheduler.cancel_timer(process, deadline);
+    }
+
+    void Scheduler::sleep(Process* process, std::chrono::duration<double> duration) {
+        Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(duration);
+        get().add_timer(process, deadline);
+        while (Clock::now() < deadline) {
+            park(process);
+        }
+    }
+
+    void Scheduler::join(Process* process) {
+        Task& task = process->get_task();
+        Process* waiter = get_current();
+        std::unique_lock<std::mutex> lock(task.mutex);
+        if (!task.spawned || waiter == process) return;
+
+        if (waiter) {
+            while (!task.finished) {
+                task.joiners.push_back(waiter);
+                lock.unlock();
+                park(waiter);
+                lock.lock();
+            }
+        } else {
+            while (!task.finished) task.cv.wait(lock);
+        }
+    }
+
+    SchedulerStats Scheduler::get_stats() {
+        Scheduler& scheduler = get();
+
+        SchedulerStats stats;
+        for (const std::unique_ptr<Worker>& worker : scheduler._workers) {
+            WorkerStats worker_stats;
+            worker_stats.queue_depth = worker->queue.size();
+            worker_stats.runs = worker->runs.load();
+            worker_stats.steals = worker->steals.load();
+            stats.workers.push_back(worker_stats);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(scheduler._injected_mutex);
+            stats.injected_depth = scheduler._injected.size();
+        }
+
+        stats.runnable = scheduler._num_runnable.load();
+        return stats;
+    }
+
+    std::chrono::nanoseconds Scheduler::get_run_time(const Process* process) {
+        return std::chrono::nanoseconds(process->get_task().run_time.load());
+    }
+
+    Scheduler::Scheduler()
+        : _stopping(false),
+        _num_runnable(0),
+        _num_idle(0) {
+        size_t num_workers = get_num_workers();
+        for (size_t i = 0; i < num_workers; i++) {
+            std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+            worker->index = i;
+            worker->seed = static_cast<uint32_t>(i * 2654435761u + 1);
+            _workers.push_back(std::move(worker));
+        }
+
+        // Started once every worker exists, since they steal from each other.
+        for (std::unique_ptr<Worker>& worker : _workers) {
+            worker->thread = std::thread(&Scheduler::run_worker, this, std::ref(*worker));
+        }
+
+        _timer = std::thread(&Scheduler::run_timer, this);
+    }
+
+    // Workers stop at the end of their current time slice, processes that
+    // are still runnable or parked are abandoned.
+    Scheduler::~Scheduler() {
+        {
+            std::lock_guard<std::mutex> idle_lock(_idle_mutex);
+            std::lock_guard<std::mutex> timer_lock(_timer_mutex);
+            _stopping = true;
+        }
+
+        _idle_cv.notify_all();
+        _timer_cv.notify_one();
+        for (std::unique_ptr<Worker>& worker : _workers) {
+            worker->thread.join();
+        }
+
+        _timer.join();
+    }
+
+    Scheduler& Scheduler::get() {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    void Scheduler::push_runnable(Process* process) {
+        if (Worker* worker = _current_worker) {
+            worker->queue.push(process);
+        } else {
+            std::lock_guard<std::mutex> lock(_injected_mutex);
+            _injected.push_back(process);
+        }
+
+        // Pairs with the check in pop_runnable, either the worker going to
+        // sleep sees the process or it's seen as idle here.
+        _num_runnable++;
+        if (_num_idle.load() > 0) {
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+            _idle_cv.notify_one();
+        }
+    }
+
+    Process* Scheduler::pop_runnable(Worker& worker) {
+        while (!_stopping) {
+            Process* process = worker.queue.take();
+            if (!process) process = take_injected();
+            if (!process) process = steal(worker);
+            if (process) {
+                _num_runnable--;
+                return process;
+            }
+
+            std::unique_lock<std::mutex> lock(_idle_mutex);
+            if (_stopping) break;
+
+            _num_idle++;
+            if (_num_runnable.load() == 0) _idle_cv.wait(lock);
+            _num_idle--;
+        }
+
+        return nullptr;
+    }
+
+    Process* Scheduler::take_injected() {
+        std::lock_guard<std::mutex> lock(_injected_mutex);
+        if (_injected.empty()) return nullptr;
+
+        Process* process = _injected.front();
+        _injected.pop_front();
+        return process;
+    }
+
+    // Tries every other worker once, starting from a random one so idle
+    // workers don't all descend on the same queue.
+    Process* Scheduler::steal(Worker& worker) {
+        size_t num_workers = _workers.size();
+        worker.seed ^= worker.seed << 13;
+        worker.seed ^= worker.seed >> 17;
+        worker.seed ^= worker.seed << 5;
+        size_t start = worker.seed % num_workers;
+        for (size_t i = 0; i < num_workers; i++) {
+            Worker& victim = *_workers[(start + i) % num_workers];
+            if (&victim == &worker) continue;
+
+            if (Process* process = victim.queue.take()) {
+                worker.steals++;
+                return process;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void Scheduler::run_worker(Worker& worker) {
+        _current_worker = &worker;
+        while (Process* process = pop_runnable(worker)) {
+            run(worker, process);
+        }
+
+        _current_worker = nullptr;
+    }
+
+    void Scheduler::add_timer(Process* process, Clock::time_point deadline) {
+        {
+            std::lock_guard<std::mutex> lock(_timer_mutex);
+            _timers.emplace(deadline, process);
+        }
+
+        _timer_cv.notify_one();
+    }
+
+    void Scheduler::cancel_timer(Process* process, Clock::time_point deadline) {
+        std::lock_guard<std::mutex> lock(_timer_mutex);
+        auto range = _timers.equal_range(deadline);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == process) {
+                _timers.erase(it);
+                break;
+            }
+        }
+    }
+
+    void Scheduler::run_timer() {
+        std::unique_lock<std::mutex> lock(_timer_mutex);
+        while (!_stopping) {
+            if (_timers.empty()) {
+                _timer_cv.wait(lock);
+                continue;
+            }
+
+            // Copied, as the timer may be cancelled while we wait.
+            auto it = _timers.begin();
+            Clock::time_point deadline = it->first;
+            if (deadline > Clock::now()) {
+                _timer_cv.wait_until(lock, deadline);
+                continue;
+            }
+
+            Process* process = it->second;
+            _timers.erase(it);
+            lock.unlock();
+            wake(process);
+            lock.lock();
+        }
+    }
+
+    void Scheduler::run(Worker& worker, Process* process) {
+        Task& task = process->get_task();
+        if (!task.fiber) {
+            task.fiber = std::make_unique<Fiber>([process]() {
+                process->set_state(Process::State::RUNNING);
+                process->get_task().entry(process);
+            });
+        }
+
+        if (task.last_worker != worker.index) {
+            if (task.last_worker != SIZE_MAX) task.migrations++;
+            task.last_worker = worker.index;
+        }
+
+        Clock::time_point start = Clock::now();
+        current = process;
+        task.reductions = REDUCTIONS;
+        task.fiber->resume();
+        current = nullptr;
+        task.run_time += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        task.runs++;
+        worker.runs++;
+
+        if (task.fiber->is_finished()) {
+            finish(process);
+        } else if (task.yield == Task::Yield::PREEMPTED) {
+            push_runnable(process);
+        } else {
+            // A wakeup may have arrived between the process deciding to
+            // park and it leaving the worker.
+            bool runnable = false;
+            {
+                std::lock_guard<std::mutex> lock(task.mutex);
+                if (task.woken) {
+                    task.woken = false;
+                    runnable = true;
+                } else {
+                    task.parked = true;
+                }
+            }
+
+            if (runnable) {
+                push_runnable(process);
+            }
+        }
+    }
+
+    void Scheduler::finish(Process* process) {
+        Task& task = process->get_task();
+        task.fiber.reset();
+
+        std::vector<Process*> joiners;
+        {
+            std::lock_guard<std::mutex> lock(task.mutex);
+            process->set_state(Process::State::COMPLETED);
+            task.finished = true;
+            joiners.swap(task.joiners);
+        }
+
+        task.cv.notify_all();
+        for (Process* joiner : joiners) {
+            wake(joiner);
+        }
+    }
+
+} // namespace emerald
@@ -0,0 +1,140 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "emerald/check.h"
+#include "emerald/shape.h"
+
+namespace emerald {
+
+    Shape::Shape()
+        : _parent(nullptr),
+        _accessor(false),
+        _num_slots(0),
+        _dictionary(false) {}
+
+    Shape::Shape(Shape* parent, Atom key, bool accessor)
+        : _parent(parent),
+        _key(key),
+        _accessor(accessor),
+        _num_slots(parent->_num_slots + 1),
+        _dictionary(false) {}
+
+    Shape* Shape::get_parent() const {
+        return _parent;
+    }
+
+    bool Shape::is_dictionary() const {
+        return _dictionary;
+    }
+
+    size_t Shape::get_num_slots() const {
+        return _num_slots;
+    }
+
+    bool Shape::lookup(Atom key, Property& property) const {
+        if (_num_slots == 0) {
+            return false;
+        }
+
+        if (!_table) {
+            build_table();
+        }
+
+        auto it = _table->find(key);
+        if (it == _table->end()) {
+            return false;
+        }
+
+        property = it->second;
+        return true;
+    }
+
+    std::vector<Atom> Shape::get_keys() const {
+        std::vector<Atom> keys(_num_slots);
+        if (_dictionary) {
+            for (const auto& pair : *_table) {
+                keys[pair.second.slot] = pair.first;
+            }
+        } else {
+            for (const Shape* shape = this; shape->_parent; shape = shape->_parent) {
+                keys[shape->_num_slots - 1] = shape->_key;
+            }
+        }
+
+        return keys;
+    }
+
+    Shape* Shape::get_transition(Atom key, bool accessor) {
+        CHECK_THROW_LOGIC_ERROR(!_dictionary, "dictionary shapes have no transitions");
+
+        std::unique_ptr<Shape>& transition = accessor
+            ? _accessor_transitions[key]
+            : _transitions[key];
+        if (!transition) {
+            transition.reset(new Shape(this, key, accessor));
+        }
+
+        return transition.get();
+    }
+
+    void Shape::add_dictionary_key(Atom key, bool accessor) {
+        CHECK_THROW_LOGIC_ERROR(_dictionary, "only dictionary shapes can be modified");
+
+        (*_table)[key] = Property{ _num_slots++, accessor };
+    }
+
+    void Shape::set_dictionary_accessor(Atom key, bool accessor) {
+        CHECK_THROW_LOGIC_ERROR(_dictionary, "only dictionary shapes can be modified");
+
+        _table->at(key).accessor = accessor;
+    }
+
+    std::unique_ptr<Shape> Shape::to_dictionary() const {
+        std::unique_ptr<Shape> dictionary(new Shape());
+        dictionary->_dictionary = true;
+        dictionary->_num_slots = _num_slots;
+        if (!_table) {
+            build_table();
+        }
+        dictionary->_table.reset(new std::unordered_map<Atom, Property>(*_table));
+
+        return dictionary;
+    }
+
+    void Shape::build_table() const {
+        _table.reset(new std::unordered_map<Atom, Property>());
+        for (const Shape* shape = this; shape->_parent; shape = shape->_parent) {
+            (*_table)[shape->_key] = Property{ shape->_num_slots - 1, shape->_accessor };
+        }
+    }
+
+    ShapeTree::ShapeTree()
+        : _prototype_epoch(0) {}
+
+    Shape* ShapeTree::get_root() {
+        return &_root;
+    }
+
+    size_t ShapeTree::get_prototype_epoch() const {
+        return _prototype_epoch;
+    }
+
+    void ShapeTree::invalidate_prototypes() {
+        _prototype_epoch++;
+    }
+
+} // namespace emerald
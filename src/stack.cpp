@@ -23,7 +23,9 @@
 namespace emerald {
 
     Stack::Stack(uint16_t max_size)
-        : _max_size(max_size) {}
+        : _max_size(max_size) {
+        _values.reserve(INITIAL_VALUES_CAPACITY);
+    }
 
     uint16_t Stack::max_size() const {
         return _max_size;
@@ -49,15 +51,38 @@ namespace emerald {
         return _stack.back();
     }
 
+    const std::deque<Stack::Frame>& Stack::get_frames() const {
+        return _stack;
+    }
+
+    const std::vector<Value>& Stack::get_values() const {
+        return _values;
+    }
+
     bool Stack::pop_frame() {
         if (_stack.empty()) return false;
 
+        Frame& frame = _stack.back();
+        _values.resize(frame._locals_base);
+        _catch_ips.resize(frame._catch_base);
         _stack.pop_back();
         return true;
     }
 
-    void Stack::push_frame(Object* receiver, std::shared_ptr<const Code> code, Module* globals, Object* locals) {
-        _stack.emplace_back(receiver, code, globals, locals);
+    void Stack::push_frame(Value receiver, std::shared_ptr<const Code> code, Module* globals, size_t num_args) {
+        CHECK_THROW_LOGIC_ERROR(num_args == 0 || (!_stack.empty() && num_args <= _stack.back().num_ds()),
+            "cannot pass more arguments than are on the stack");
+
+        InlineCaches& inline_caches = _inline_caches[code];
+        if (inline_caches.empty()) {
+            inline_caches.resize(code->get_num_instructions());
+        }
+
+        // The local slots are opened up below the arguments.
+        size_t locals_base = _values.size() - num_args;
+        _values.insert(_values.begin() + locals_base, code->get_num_locals(), Value());
+
+        _stack.emplace_back(this, receiver, code, globals, &inline_caches, locals_base, _catch_ips.size());
     }
 
     const Module* Stack::peek_globals() const {
@@ -75,11 +100,17 @@ namespace emerald {
     std::vector<HeapManaged*> Stack::get_roots() {
         std::vector<HeapManaged*> roots;
         for (Frame& frame : _stack) {
-            roots.push_back(frame.get_receiver());
+            if (Object* receiver = frame.get_receiver().get_object()) {
+                roots.push_back(receiver);
+            }
             roots.push_back(frame.get_globals());
-            roots.push_back(frame.get_locals());
+            if (Object* locals = frame.get_locals()) {
+                roots.push_back(locals);
+            }
+        }
 
-            for (Object* obj : frame.get_data_stack()) {
+        for (Value val : _values) {
+            if (Object* obj = val.get_object()) {
                 roots.push_back(obj);
             }
         }
@@ -87,14 +118,27 @@ namespace emerald {
         return roots;
     }
 
-    Stack::Frame::Frame(Object* receiver, std::shared_ptr<const Code> code, Module* globals, Object* locals)
-        : _receiver(receiver), 
+    Stack::Frame::Frame(
+            Stack* stack,
+            Value receiver,
+            std::shared_ptr<const Code> code,
+            Module* globals,
+            InlineCaches* inline_caches,
+            size_t locals_base,
+            size_t catch_base)
+        : _stack(stack),
+        _receiver(receiver), 
         _code(code), 
         _ip(0),
+        _current_instruction(nullptr),
+        _inline_caches(inline_caches),
         _globals(globals),
-        _locals(locals) {}
+        _locals(nullptr),
+        _locals_base(locals_base),
+        _ds_base(locals_base + code->get_num_locals()),
+        _catch_base(catch_base) {}
 
-    Object* Stack::Frame::get_receiver() const {
+    Value Stack::Frame::get_receiver() const {
         return _receiver;
     }
 
@@ -102,24 +146,31 @@ namespace emerald {
         return _code;
     }
 
-    size_t Stack::Frame::get_instruction_pointer() const {
-        return _ip;
+    std::string Stack::Frame::get_label() const {
+        const std::string& label = _code->get_label();
+        return label.empty() ? _globals->get_name() : label;
     }
 
-    void Stack::Frame::increment_instruction_pointer() {
-        _ip++;
+    size_t Stack::Frame::get_instruction_pointer() const {
+        return _ip;
     }
 
     void Stack::Frame::set_instruction_pointer(size_t ip) {
         _ip = ip;
     }
 
-    bool Stack::Frame::has_instructions_left() const {
-        return _ip < _code->get_num_instructions();
+    size_t Stack::Frame::get_current_instruction() const {
+        if (!_current_instruction) return _ip;
+        return _current_instruction - _code->get_packed_instructions();
     }
 
-    const Code::Instruction& Stack::Frame::get_next_instruction() const {
-        return (*_code)[_ip];
+    InlineCache& Stack::Frame::get_inline_cache(size_t ip) {
+        std::unique_ptr<InlineCache>& inline_cache = (*_inline_caches)[ip];
+        if (!inline_cache) {
+            inline_cache.reset(new InlineCache());
+        }
+
+        return *inline_cache;
     }
 
     const Module* Stack::Frame::get_globals() const {
@@ -130,15 +181,11 @@ namespace emerald {
         return _globals;
     }
 
-    const Object* Stack::Frame::get_global(const std::string& name) const {
-        return _globals->get_property(name);
-    }
-
-    Object* Stack::Frame::get_global(const std::string& name) {
+    Value Stack::Frame::get_global(Atom name) const {
         return _globals->get_property(name);
     }
 
-    void Stack::Frame::set_global(const std::string& name, Object* val) {
+    void Stack::Frame::set_global(Atom name, Value val) {
         _globals->set_property(name, val);
     }
 
@@ -150,77 +197,102 @@ namespace emerald {
         return _locals;
     }
 
-    const Object* Stack::Frame::get_local(const std::string& name) const {
-        return _locals->get_property(name);
+    void Stack::Frame::materialize_locals(Object* locals) {
+        CHECK_THROW_LOGIC_ERROR(_locals == nullptr, "locals have already been materialized");
+
+        _locals = locals;
+        for (size_t i = _locals_base; i < _ds_base; i++) {
+            Value& slot = _stack->_values[i];
+            if (slot) {
+                _locals->set_property(_code->get_local_atom(i - _locals_base), slot);
+                slot = Value();
+            }
+        }
     }
 
-    Object* Stack::Frame::get_local(const std::string& name) {
-        return _locals->get_property(name);
+    Value Stack::Frame::get_local(size_t id) const {
+        if (_locals) {
+            return _locals->get_property(_code->get_local_atom(id));
+        }
+
+        return _stack->_values[_locals_base + id];
     }
 
-    void Stack::Frame::set_local(const std::string& name, Object* val) {
-        _locals->set_property(name, val);
+    void Stack::Frame::set_local(size_t id, Value val) {
+        if (_locals) {
+            _locals->set_property(_code->get_local_atom(id), val);
+        } else {
+            _stack->_values[_locals_base + id] = val;
+        }
     }
 
     size_t Stack::Frame::num_locals() const {
-        return _locals->get_properties().size();
+        if (_locals) {
+            return _locals->num_properties();
+        }
+
+        return _code->get_num_locals();
     }
 
-    const std::deque<Object*> Stack::Frame::get_data_stack() const {
-        return _data_stack;
+    // Only the frame on top of the stack pushes and pops, so its data stack
+    // always ends at the top of the values.
+    size_t Stack::Frame::num_ds() const {
+        return _stack->_values.size() - _ds_base;
     }
 
-    const Object* Stack::Frame::peek_ds() const {
-        CHECK_THROW_LOGIC_ERROR(!_data_stack.empty(), "cannot peek an empty stack");
+    Value Stack::Frame::peek_ds() const {
+        CHECK_THROW_LOGIC_ERROR(num_ds() > 0, "cannot peek an empty stack");
 
-        return _data_stack.back();
+        return _stack->_values.back();
     }
 
-    Object* Stack::Frame::peek_ds() {
-        CHECK_THROW_LOGIC_ERROR(!_data_stack.empty(), "cannot peek an empty stack");
+    Value Stack::Frame::peek_ds(size_t depth) const {
+        CHECK_THROW_LOGIC_ERROR(depth < num_ds(), "cannot peek past the bottom of the stack");
 
-        return _data_stack.back();
+        return _stack->_values[_stack->_values.size() - depth - 1];
     }
 
-    Object* Stack::Frame::pop_ds() {
-        CHECK_THROW_LOGIC_ERROR(!_data_stack.empty(), "cannot pop an empty stack");
+    Value Stack::Frame::pop_ds() {
+        CHECK_THROW_LOGIC_ERROR(num_ds() > 0, "cannot pop an empty stack");
 
-        Object* obj = _data_stack.back();
-        _data_stack.pop_back();
-        return obj;
+        Value val = _stack->_values.back();
+        _stack->_values.pop_back();
+        return val;
     }
 
-    std::vector<Object*> Stack::Frame::pop_n_ds(size_t n) {
-        std::vector<Object*> vec;
-        for (size_t i = 0; i < n; i++) {
-            vec.push_back(pop_ds());
-        }
+    std::vector<Value> Stack::Frame::pop_n_ds(size_t n) {
+        CHECK_THROW_LOGIC_ERROR(n <= num_ds(), "cannot pop an empty stack");
 
+        std::vector<Value>& values = _stack->_values;
+        std::vector<Value> vec(values.rbegin(), values.rbegin() + n);
+        values.resize(values.size() - n);
         return vec;
     }
 
-    void Stack::Frame::push_ds(Object* val) {
-        _data_stack.push_back(val);
+    void Stack::Frame::drop_n_ds(size_t n) {
+        CHECK_THROW_LOGIC_ERROR(n <= num_ds(), "cannot pop an empty stack");
+
+        _stack->_values.resize(_stack->_values.size() - n);
     }
 
     void Stack::Frame::push_catch_ip(size_t ip) {
-        _catch_stack.push(ip);
+        _stack->_catch_ips.push_back(ip);
     }
 
     void Stack::Frame::pop_catch_ip() {
-        CHECK_THROW_LOGIC_ERROR(!_catch_stack.empty(), "cannot pop an empty stack");
+        CHECK_THROW_LOGIC_ERROR(has_catch_ip(), "cannot pop an empty stack");
 
-        _catch_stack.pop();
+        _stack->_catch_ips.pop_back();
     }
 
     bool Stack::Frame::has_catch_ip() {
-        return !_catch_stack.empty();
+        return _stack->_catch_ips.size() > _catch_base;
     }
 
     size_t Stack::Frame::get_catch_ip() {
-        CHECK_THROW_LOGIC_ERROR(!_catch_stack.empty(), "cannot pop an empty stack");
+        CHECK_THROW_LOGIC_ERROR(has_catch_ip(), "cannot pop an empty stack");
 
-        return _catch_stack.top();
+        return _stack->_catch_ips.back();
     }
 
 
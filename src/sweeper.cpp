@@ -0,0 +1,73 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "emerald/sweeper.h"
+
+namespace emerald {
+
+    std::future<void> Sweeper::submit(std::function<void()> task) {
+        Sweeper& sweeper = get();
+        std::packaged_task<void()> packaged_task(std::move(task));
+        std::future<void> future = packaged_task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(sweeper._mutex);
+            sweeper._tasks.push_back(std::move(packaged_task));
+        }
+
+        sweeper._cv.notify_one();
+        return future;
+    }
+
+    Sweeper::Sweeper()
+        : _stopping(false),
+        _thread(&Sweeper::run, this) {}
+
+    Sweeper::~Sweeper() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _cv.notify_one();
+        _thread.join();
+    }
+
+    Sweeper& Sweeper::get() {
+        static Sweeper sweeper;
+        return sweeper;
+    }
+
+    void Sweeper::run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            while (_tasks.empty() && !_stopping) _cv.wait(lock);
+
+            // Heaps wait on their tasks when they're destroyed, so the
+            // queue is drained before stopping.
+            if (_tasks.empty()) return;
+
+            std::packaged_task<void()> task = std::move(_tasks.front());
+            _tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+} // namespace emerald
@@ -0,0 +1,85 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "emerald/native_objects.h"
+#include "emerald/object.h"
+#include "emerald/process.h"
+#include "emerald/value.h"
+
+namespace emerald {
+
+    bool Value::as_bool() const {
+        if (is_number()) {
+            return get_number() != 0;
+        } else if (is_object()) {
+            return get_object()->as_bool();
+        }
+
+        return get_boolean();
+    }
+
+    std::string Value::as_str() const {
+        if (is_number()) {
+            return Number::format(get_number());
+        } else if (is_object()) {
+            return get_object()->as_str();
+        } else if (is_null()) {
+            return "None";
+        } else if (is_boolean()) {
+            return get_boolean() ? "True" : "False";
+        }
+
+        return "";
+    }
+
+    Atom Value::as_atom() const {
+        if (String* str = get_object_as<String>()) {
+            return str->get_atom();
+        }
+
+        return as_str();
+    }
+
+    Object* Value::to_object(Process* process) const {
+        if (is_object()) {
+            return get_object();
+        } else if (is_number()) {
+            return process->get_heap().allocate<Number>(process, get_number());
+        } else if (is_boolean()) {
+            return process->get_native_objects().get_boolean(get_boolean());
+        } else if (is_null()) {
+            return process->get_native_objects().get_null();
+        }
+
+        return nullptr;
+    }
+
+    Value Value::clone(Process* process, CloneCache& cache) const {
+        if (is_object()) {
+            return get_object()->clone(process, cache);
+        }
+
+        return *this;
+    }
+
+    void Value::mark(MarkStack& stack) const {
+        if (is_object()) {
+            get_object()->mark(stack);
+        }
+    }
+
+} // namespace emerald
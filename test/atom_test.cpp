@@ -0,0 +1,66 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+#include "emerald/atom.h"
+
+using emerald::Atom;
+
+TEST(AtomTest, InternedAtomsShareStorage) {
+    Atom a = Atom::intern("interned_key");
+    Atom b = Atom::intern(std::string("interned_") + "key");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(&a.get_str(), &b.get_str());
+    EXPECT_NE(a, Atom::intern("other_key"));
+}
+
+TEST(AtomTest, ComputedAtomsAreNotInterned) {
+    Atom a = std::string("computed_key");
+    Atom b = std::string("computed_key");
+    EXPECT_NE(&a.get_str(), &b.get_str());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, Atom::intern("computed_key"));
+    EXPECT_EQ(Atom::intern("computed_key"), b);
+    EXPECT_NE(a, Atom("other_key"));
+    EXPECT_NE(a, Atom());
+}
+
+TEST(AtomTest, ComputedAndInternedAtomsFindEachOther) {
+    std::unordered_map<Atom, int> table;
+    table[Atom::intern("x")] = 1;
+    table[Atom(std::string("y"))] = 2;
+
+    EXPECT_EQ(table.at(Atom(std::string("x"))), 1);
+    EXPECT_EQ(table.at(Atom::intern("y")), 2);
+    EXPECT_EQ(table.size(), 2);
+}
+
+TEST(AtomTest, ComputedAtomsOutliveTheirSource) {
+    Atom copy;
+    {
+        Atom a = std::string("short_lived");
+        copy = a;
+    }
+
+    EXPECT_EQ(copy.get_str(), "short_lived");
+    copy = Atom();
+    EXPECT_FALSE(copy);
+}
@@ -0,0 +1,204 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emerald/code_cache.h"
+#include "emerald/compiler.h"
+#include "emerald/interpreter.h"
+#include "emerald/jit.h"
+#include "emerald/module.h"
+#include "emerald/modules/init.h"
+#include "emerald/optimizer.h"
+#include "emerald/parser.h"
+#include "emerald/process.h"
+#include "emerald/reporter.h"
+#include "emerald/source.h"
+
+namespace {
+
+    // Compiles the source as a module, optimized or not, runs it in a fresh
+    // process, with every function compiled on its first call when jit is
+    // set, and returns the value it bound to result.
+    emerald::Value run_module(const std::string& name, const std::string& source, bool optimize, bool jit) {
+        std::shared_ptr<emerald::Reporter> reporter = std::make_shared<emerald::Reporter>();
+        std::vector<std::shared_ptr<emerald::Statement>> statements = emerald::Parser::parse(
+            std::make_shared<emerald::Source>(name, source),
+            reporter);
+        std::shared_ptr<emerald::Code> code;
+        if (!reporter->has_errors()) {
+            code = emerald::Compiler::compile(statements, reporter);
+        }
+
+        if (reporter->has_errors()) {
+            ADD_FAILURE() << reporter->get_reports().front().get_report();
+            return emerald::Value();
+        }
+
+        if (optimize) {
+            emerald::Optimizer::optimize(*code);
+        }
+
+        emerald::modules::add_module_inits_to_registry();
+        emerald::CodeCache::add_code(name, code);
+
+        emerald::Jit::set_enabled(jit);
+        emerald::Jit::set_threshold(1);
+
+        emerald::Value result;
+        emerald::Process* process = emerald::ProcessManager::create();
+        emerald::ProcessManager::execute(process->get_id(), [&](emerald::Process*) {
+            emerald::Interpreter::execute_module(name, process);
+            result = process->get_module_registry().get_module(name)->get_property("result");
+        });
+        emerald::ProcessManager::join(process->get_id());
+
+        emerald::Jit::set_enabled(false);
+        emerald::Jit::set_threshold(emerald::Jit::DEFAULT_THRESHOLD);
+
+        return result;
+    }
+
+    // Runs the source in the interpreter and with the JIT, unoptimized and
+    // optimized, and checks every run agrees with the first.
+    emerald::Value run_everywhere(const std::string& name, const std::string& source) {
+        emerald::Value expected = run_module(name, source, false, false);
+        for (bool optimize : { false, true }) {
+            std::string suffix = optimize ? "_o" : "";
+            EXPECT_EQ(run_module(name + suffix + "_interpreted", source, optimize, false), expected);
+            EXPECT_EQ(run_module(name + suffix + "_jit", source, optimize, true), expected);
+        }
+        return expected;
+    }
+
+} // namespace
+
+TEST(JitTest, ComputesNumbersLikeTheInterpreter) {
+    const std::string source =
+        "def run : n\n"
+        "    let sum = 0\n"
+        "    let flags = 0\n"
+        "    for let i = 0 to n do\n"
+        "        let x = i * 1.5 - 7\n"
+        "        sum = sum + x / 4 + i % 3 - (i | 5) + (i & 6) + (i ^ 3) + (i << 2) + (i >> 1)\n"
+        "        if x < 0 then flags += 1 end\n"
+        "        if x >= 8 then flags += 10 end\n"
+        "        if x == 2 then flags += 100 end\n"
+        "        if x != 2 && x <= 3 then flags += 1000 end\n"
+        "    end\n"
+        "    return sum * 100000 + flags\n"
+        "end\n"
+        "let result = run(40)\n";
+
+    size_t num_compiled = emerald::Jit::get_num_compiled();
+    emerald::Value result = run_everywhere("jit_numbers", source);
+    ASSERT_TRUE(result.is_number());
+#ifdef EMERALD_JIT
+    EXPECT_GT(emerald::Jit::get_num_compiled(), num_compiled);
+#endif
+}
+
+TEST(JitTest, FallsBackForOtherTypes) {
+    const std::string source =
+        "def run : n\n"
+        "    let s = \"\"\n"
+        "    let nothing = None\n"
+        "    for let i = 0 to n do\n"
+        "        s = s + \"x\"\n"
+        "        if s then s += \"y\" end\n"
+        "        if nothing then s += \"z\" end\n"
+        "    end\n"
+        "    return s.len()\n"
+        "end\n"
+        "let result = run(10) == 20\n";
+
+    emerald::Value result = run_everywhere("jit_other_types", source);
+    ASSERT_TRUE(result.is_boolean());
+    EXPECT_TRUE(result.get_boolean());
+}
+
+TEST(JitTest, RespectsOverriddenNumberOperators) {
+    const std::string source =
+        "import core\n"
+        "def run : n\n"
+        "    let sum = 0\n"
+        "    for let i = 0 to n do\n"
+        "        sum = 1 + 1\n"
+        "    end\n"
+        "    return sum\n"
+        "end\n"
+        "def add : other\n"
+        "    return 42\n"
+        "end\n"
+        "let before = run(10)\n"
+        "core.super(5).__add__ = add\n"
+        "let result = before == 2 && run(10) == 42\n";
+
+    emerald::Value result = run_everywhere("jit_override_add", source);
+    ASSERT_TRUE(result.is_boolean());
+    EXPECT_TRUE(result.get_boolean());
+}
+
+TEST(JitTest, RespectsOverriddenBooleanConversion) {
+    const std::string source =
+        "import core\n"
+        "let calls = 0\n"
+        "def run : n\n"
+        "    let count = 0\n"
+        "    for let i = 0 to n do\n"
+        "        if i < 5 then count += 1 end\n"
+        "    end\n"
+        "    return count\n"
+        "end\n"
+        "def boolean\n"
+        "    calls += 1\n"
+        "    return self == True\n"
+        "end\n"
+        "run(10)\n"
+        "core.super(True).__boolean__ = boolean\n"
+        "let result = run(10) == 5 && calls > 0\n";
+
+    emerald::Value result = run_everywhere("jit_override_boolean", source);
+    ASSERT_TRUE(result.is_boolean());
+    EXPECT_TRUE(result.get_boolean());
+}
+
+TEST(JitTest, CatchesExceptionsThrownByHelpers) {
+    const std::string source =
+        "def run : n\n"
+        "    let caught = 0\n"
+        "    for let i = 0 to n do\n"
+        "        try\n"
+        "            if i % 3 == 0 then\n"
+        "                let bad = i + None\n"
+        "            end\n"
+        "        catch e\n"
+        "            caught += 1\n"
+        "        end\n"
+        "    end\n"
+        "    return caught\n"
+        "end\n"
+        "let result = run(30)\n";
+
+    emerald::Value result = run_everywhere("jit_exceptions", source);
+    ASSERT_TRUE(result.is_number());
+    EXPECT_EQ(result.get_number(), 10);
+}
@@ -0,0 +1,104 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emerald/code_cache.h"
+#include "emerald/compiler.h"
+#include "emerald/interpreter.h"
+#include "emerald/module.h"
+#include "emerald/modules/init.h"
+#include "emerald/optimizer.h"
+#include "emerald/parser.h"
+#include "emerald/process.h"
+#include "emerald/reporter.h"
+#include "emerald/source.h"
+
+namespace {
+
+    // Compiles the source as a module, optionally optimized, runs it in
+    // a fresh process and returns the value it bound to result.
+    emerald::Value run_module(const std::string& name, const std::string& source, bool optimize) {
+        std::shared_ptr<emerald::Reporter> reporter = std::make_shared<emerald::Reporter>();
+        std::vector<std::shared_ptr<emerald::Statement>> statements = emerald::Parser::parse(
+            std::make_shared<emerald::Source>(name, source),
+            reporter);
+        std::shared_ptr<emerald::Code> code;
+        if (!reporter->has_errors()) {
+            code = emerald::Compiler::compile(statements, reporter);
+        }
+
+        if (reporter->has_errors()) {
+            ADD_FAILURE() << reporter->get_reports().front().get_report();
+            return emerald::Value();
+        }
+
+        if (optimize) {
+            emerald::Optimizer::optimize(*code);
+        }
+
+        emerald::modules::add_module_inits_to_registry();
+        emerald::CodeCache::add_code(name, code);
+
+        emerald::Value result;
+        emerald::Process* process = emerald::ProcessManager::create();
+        emerald::ProcessManager::execute(process->get_id(), [&](emerald::Process*) {
+            emerald::Interpreter::execute_module(name, process);
+            result = process->get_module_registry().get_module(name)->get_property("result");
+        });
+        emerald::ProcessManager::join(process->get_id());
+
+        return result;
+    }
+
+} // namespace
+
+TEST(OptimizerTest, RespectsOverriddenNumberOperators) {
+    const std::string source =
+        "import core\n"
+        "def add : other\n"
+        "    return 42\n"
+        "end\n"
+        "core.super(5).__add__ = add\n"
+        "let result = 2 + 3\n";
+
+    for (bool optimize : { false, true }) {
+        emerald::Value result = run_module(optimize ? "override_add_o" : "override_add", source, optimize);
+        ASSERT_TRUE(result.is_number());
+        EXPECT_EQ(result.get_number(), 42);
+    }
+}
+
+TEST(OptimizerTest, RespectsOverriddenNumberComparisons) {
+    const std::string source =
+        "import core\n"
+        "def lt : other\n"
+        "    return False\n"
+        "end\n"
+        "core.super(5).__lt__ = lt\n"
+        "let result = 1 < 2\n";
+
+    for (bool optimize : { false, true }) {
+        emerald::Value result = run_module(optimize ? "override_lt_o" : "override_lt", source, optimize);
+        ASSERT_TRUE(result.is_boolean());
+        EXPECT_FALSE(result.get_boolean());
+    }
+}
@@ -0,0 +1,320 @@
+/*  Emerald - Procedural and Object Oriented Programming Language
+**  Copyright (C) 2018  Zach Perkitny
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <functional>
+
+#include "boost/asio/ip/address.hpp"
+#include "boost/date_time/gregorian/gregorian.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+#include "gtest/gtest.h"
+
+#include "emerald/frozen.h"
+#include "emerald/modules/collections.h"
+#include "emerald/modules/datetime.h"
+#include "emerald/modules/io.h"
+#include "emerald/modules/net.h"
+#include "emerald/native_stack.h"
+#include "emerald/native_variables.h"
+#include "emerald/object.h"
+#include "emerald/objectutils.h"
+#include "emerald/parcel.h"
+#include "emerald/process.h"
+
+namespace {
+
+    // Runs f as the process, in a native frame of its own, and waits for
+    // it to finish.
+    void run_in(emerald::Process* process, std::function<void(emerald::Process*)> f) {
+        emerald::ProcessManager::execute(process->get_id(), [&](emerald::Process*) {
+            emerald::NativeStack::ScopedNativeFrame frame(process->get_native_stack().push_frame());
+            f(process);
+        });
+        emerald::ProcessManager::join(process->get_id());
+    }
+
+    // Packs the value made by one process and runs check on what another
+    // unpacks from it.
+    void send(
+        std::function<emerald::Value(emerald::Process*)> make,
+        std::function<void(emerald::Process*, emerald::Value)> check) {
+        emerald::ParcelRef parcel;
+        run_in(emerald::ProcessManager::create(), [&](emerald::Process* process) {
+            parcel = emerald::Parcel::pack(make(process), process);
+        });
+
+        run_in(emerald::ProcessManager::create(), [&](emerald::Process* process) {
+            emerald::Value val = parcel->unpack(process);
+            ASSERT_TRUE(val.is_object());
+            EXPECT_EQ(val.get_object()->get_process(), process);
+            check(process, val);
+        });
+    }
+
+    // Made without the net module, whose prototypes construct addresses
+    // through __init__.
+    emerald::modules::IPEndpoint* make_endpoint(emerald::Process* process) {
+        emerald::Local<emerald::modules::IPAddress> address = emerald::modules::IPAddress::from_native_address(
+            process,
+            process->get_native_objects().get_object_prototype(),
+            boost::asio::ip::make_address("127.0.0.1"));
+        emerald::modules::IPEndpoint* endpoint = process->get_heap().allocate<emerald::modules::IPEndpoint>(process);
+        endpoint->init(address.val(), 8080);
+        return endpoint;
+    }
+
+} // namespace
+
+using namespace emerald;
+
+TEST(ParcelTest, CopiesObjectGraphsIntoTheReceiver) {
+    Process* sender = ProcessManager::create();
+    Process* receiver = ProcessManager::create();
+
+    ParcelRef parcel;
+    run_in(sender, [&](Process* process) {
+        Local<Object> proto = ALLOC_OBJECT();
+        proto->define_property("kind", ALLOC_STRING("point"));
+
+        Local<Object> point = process->get_heap().allocate<Object>(process, proto.val());
+        point->define_property("x", NUMBER(3));
+
+        Local<Array> arr = ALLOC_EMPTY_ARRAY();
+        arr->push(point.val());
+        arr->push(point.val());
+        arr->push(arr.val());
+        point->define_property("owner", arr.val());
+
+        parcel = Parcel::pack(arr.val(), process);
+    });
+
+    run_in(receiver, [&](Process* process) {
+        Array* arr = parcel->unpack(process).get_object_as<Array>();
+        ASSERT_NE(arr, nullptr);
+        EXPECT_EQ(arr->get_process(), process);
+        EXPECT_EQ(arr->get_parent(), process->get_native_objects().get_array_prototype());
+        ASSERT_EQ(arr->size(), 3);
+        EXPECT_EQ(arr->at(2).get_object(), arr);
+
+        Object* point = arr->at(0).get_object();
+        ASSERT_NE(point, nullptr);
+        EXPECT_EQ(arr->at(1).get_object(), point);
+        EXPECT_EQ(point->get_property("x").get_number(), 3);
+        EXPECT_EQ(point->get_property("owner").get_object(), arr);
+
+        Object* proto = point->get_parent();
+        ASSERT_NE(proto, nullptr);
+        EXPECT_EQ(proto->get_process(), process);
+        EXPECT_EQ(proto->get_parent(), process->get_native_objects().get_object_prototype());
+        EXPECT_EQ(proto->get_property("kind").get_object_as<String>()->get_native_value(), "point");
+    });
+}
+
+TEST(ParcelTest, SharesFrozenValues) {
+    Process* sender = ProcessManager::create();
+    Process* receiver = ProcessManager::create();
+
+    ParcelRef parcel;
+    FrozenRef frozen;
+    run_in(sender, [&](Process* process) {
+        Value str = Frozen::freeze(ALLOC_STRING("shared"), process);
+        frozen = str.get_object()->get_frozen();
+        parcel = Parcel::pack(str, process);
+    });
+
+    run_in(receiver, [&](Process* process) {
+        String* str = parcel->unpack(process).get_object_as<String>();
+        ASSERT_NE(str, nullptr);
+        EXPECT_EQ(str->get_process(), process);
+        EXPECT_EQ(str->get_frozen(), frozen);
+        EXPECT_EQ(str->get_native_value(), "shared");
+    });
+}
+
+TEST(ParcelTest, KeepsImmediates) {
+    Process* sender = ProcessManager::create();
+    Process* receiver = ProcessManager::create();
+
+    ParcelRef parcel;
+    run_in(sender, [&](Process* process) {
+        parcel = Parcel::pack({ NUMBER(1.5), BOOLEAN(true), NONE }, process);
+    });
+
+    run_in(receiver, [&](Process* process) {
+        std::vector<Value> values = parcel->unpack_all(process);
+        ASSERT_EQ(values.size(), 3);
+        EXPECT_EQ(values[0].get_number(), 1.5);
+        EXPECT_TRUE(values[1].get_boolean());
+        EXPECT_TRUE(values[2].is_null());
+    });
+}
+
+TEST(ParcelTest, SendsCollections) {
+    send([](Process* process) {
+        Local<modules::Queue> queue = process->get_heap().allocate<modules::Queue>(process);
+        queue->enqueue(queue.val());
+        queue->enqueue(ALLOC_STRING("last"));
+        return Value(queue.val());
+    }, [](Process*, Value val) {
+        modules::Queue* queue = val.get_object_as<modules::Queue>();
+        ASSERT_NE(queue, nullptr);
+        ASSERT_EQ(queue->size(), 2);
+        EXPECT_EQ(queue->dequeue().get_object(), queue);
+        EXPECT_EQ(queue->dequeue().get_object_as<String>()->get_native_value(), "last");
+    });
+
+    send([](Process* process) {
+        Local<modules::Set> set = process->get_heap().allocate<modules::Set>(process);
+        set->add(NUMBER(1));
+        set->add(NUMBER(2));
+        return Value(set.val());
+    }, [](Process*, Value val) {
+        modules::Set* set = val.get_object_as<modules::Set>();
+        ASSERT_NE(set, nullptr);
+        EXPECT_EQ(set->size(), 2);
+        EXPECT_TRUE(set->contains(NUMBER(1)));
+        EXPECT_TRUE(set->contains(NUMBER(2)));
+    });
+
+    send([](Process* process) {
+        Local<modules::Stack> stack = process->get_heap().allocate<modules::Stack>(process);
+        stack->push(NUMBER(1));
+        stack->push(NUMBER(2));
+        return Value(stack.val());
+    }, [](Process*, Value val) {
+        modules::Stack* stack = val.get_object_as<modules::Stack>();
+        ASSERT_NE(stack, nullptr);
+        ASSERT_EQ(stack->size(), 2);
+        EXPECT_EQ(stack->pop().get_number(), 2);
+        EXPECT_EQ(stack->pop().get_number(), 1);
+    });
+
+    send([](Process* process) {
+        Local<Array> arr = ALLOC_EMPTY_ARRAY();
+        arr->push(NUMBER(1));
+        arr->push(NUMBER(2));
+        Local<ArrayIterator> iter = process->get_heap().allocate<ArrayIterator>(process);
+        iter->init(arr.val());
+        iter->next();
+        return Value(iter.val());
+    }, [](Process* process, Value val) {
+        ArrayIterator* iter = val.get_object_as<ArrayIterator>();
+        ASSERT_NE(iter, nullptr);
+        EXPECT_EQ(iter->get_parent(), process->get_native_objects().get_array_iterator_prototype());
+        EXPECT_EQ(iter->cur().get_number(), 2);
+    });
+}
+
+TEST(ParcelTest, SendsDatesAndTimes) {
+    send([](Process* process) {
+        return Value(modules::Date::from_native_date(
+            process,
+            OBJECT_PROTOTYPE,
+            boost::gregorian::date(2020, 2, 29)));
+    }, [](Process*, Value val) {
+        modules::Date* date = val.get_object_as<modules::Date>();
+        ASSERT_NE(date, nullptr);
+        EXPECT_EQ(date->year(), 2020);
+        EXPECT_EQ(date->month(), 2);
+        EXPECT_EQ(date->day(), 29);
+    });
+
+    send([](Process* process) {
+        return Value(modules::TimeDuration::from_native_duration(
+            process,
+            OBJECT_PROTOTYPE,
+            boost::posix_time::time_duration(1, 2, 3)));
+    }, [](Process*, Value val) {
+        modules::TimeDuration* duration = val.get_object_as<modules::TimeDuration>();
+        ASSERT_NE(duration, nullptr);
+        EXPECT_EQ(duration->total_seconds(), 3723);
+    });
+
+    send([](Process* process) {
+        return Value(modules::Time::from_native_time(
+            process,
+            OBJECT_PROTOTYPE,
+            OBJECT_PROTOTYPE,
+            OBJECT_PROTOTYPE,
+            boost::posix_time::ptime(boost::gregorian::date(2020, 2, 29), boost::posix_time::hours(5))));
+    }, [](Process* process, Value val) {
+        modules::Time* time = val.get_object_as<modules::Time>();
+        ASSERT_NE(time, nullptr);
+        ASSERT_NE(time->date(), nullptr);
+        ASSERT_NE(time->time_of_day(), nullptr);
+        EXPECT_EQ(time->date()->get_process(), process);
+        EXPECT_EQ(time->date()->day(), 29);
+        EXPECT_EQ(time->time_of_day()->hours(), 5);
+    });
+}
+
+TEST(ParcelTest, SendsNetworkObjects) {
+    send([](Process* process) {
+        return Value(modules::IPAddress::from_native_address(
+            process,
+            OBJECT_PROTOTYPE,
+            boost::asio::ip::make_address("127.0.0.1")));
+    }, [](Process*, Value val) {
+        modules::IPAddress* address = val.get_object_as<modules::IPAddress>();
+        ASSERT_NE(address, nullptr);
+        EXPECT_TRUE(address->is_loopback());
+    });
+
+    send([](Process* process) {
+        return Value(make_endpoint(process));
+    }, [](Process* process, Value val) {
+        modules::IPEndpoint* endpoint = val.get_object_as<modules::IPEndpoint>();
+        ASSERT_NE(endpoint, nullptr);
+        EXPECT_EQ(endpoint->get_port(), 8080);
+        ASSERT_NE(endpoint->get_address(), nullptr);
+        EXPECT_EQ(endpoint->get_address()->get_process(), process);
+        EXPECT_TRUE(endpoint->get_address()->is_loopback());
+    });
+
+    send([](Process* process) {
+        return Value(process->get_heap().allocate<modules::TcpClient>(process));
+    }, [](Process*, Value val) {
+        EXPECT_NE(val.get_object_as<modules::TcpClient>(), nullptr);
+    });
+
+    send([](Process* process) {
+        Local<modules::TcpListener> listener = process->get_heap().allocate<modules::TcpListener>(process);
+        listener->init(make_endpoint(process));
+        return Value(listener.val());
+    }, [](Process*, Value val) {
+        modules::TcpListener* listener = val.get_object_as<modules::TcpListener>();
+        ASSERT_NE(listener, nullptr);
+        EXPECT_FALSE(listener->is_listening());
+        ASSERT_NE(listener->get_endpoint(), nullptr);
+        EXPECT_EQ(listener->get_endpoint()->get_port(), 8080);
+    });
+}
+
+TEST(ParcelTest, SendsStreams) {
+    send([](Process* process) {
+        return Value(process->get_heap().allocate<modules::FileStream>(process));
+    }, [](Process*, Value val) {
+        modules::FileStream* stream = val.get_object_as<modules::FileStream>();
+        ASSERT_NE(stream, nullptr);
+        EXPECT_FALSE(stream->is_open());
+    });
+
+    send([](Process* process) {
+        return Value(process->get_heap().allocate<modules::StringStream>(process));
+    }, [](Process*, Value val) {
+        EXPECT_NE(val.get_object_as<modules::StringStream>(), nullptr);
+    });
+}